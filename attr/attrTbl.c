@@ -17,9 +17,19 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <pthread.h>
+
 #include "attrTbl.h"
 #include <protocol/attr_protocol.h>
 #include <protocol/eegdata_protocol.h>
+#include <protocol/udp_subscriber.h>
+#include <protocol/eegdata_fec.h>
+#include <service/impedance.h>
+#include <service/eeg_filter.h>
+#include <service/eeg_decim.h>
+#include <service/eeg_bandpower.h>
+#include <service/telemetry.h>
+#include <service/trace.h>
 #include <ti/drivers/net/wifi/slnetifwifi.h>
 
 /***********************************************************************
@@ -28,6 +38,8 @@
 
 //!< 属性总表
 static uint8_t* pattr_offset[ATTR_NUM];     //!< 属性偏移地址
+static const Attr_t* pchxattr[CHXATTR_NUM]; //!< 通道属性地址
+static pthread_mutex_t AttrMutex;           //!< 属性表互斥锁 - 多个tcpWorker及应用层线程访问
 
 /* 基本信息 */
 const   uint8_t dev_chnum = CHANNEL_NUM;
@@ -36,22 +48,53 @@ SlDeviceVersion_t ver= {0};
 /* 采样状态与控制 */
 static bool     sampling;
 static bool     impMeas;
-static uint8_t  impMeas_mode;
-static float    impMeasval[16];
+static uint8_t  impMeas_mode = IMP_FREQ_7HZ8;
+static uint16_t impMeas_interval = IMP_INTERVAL_DEFAULT;
+float           impMeasval[CHANNEL_NUM];    //!< 由阻抗测量服务更新
 
 /* 通信参数 */
 NETParam_t netparam;
-uint8_t samplenum = UDP_SAMPLENUM;
+uint8_t samplenum = UDP_SAMPLENUM_DEFAULT;
 
 /* 采样参数 */
 static uint16_t curSamprate = SPS_1K;
 static const uint16_t samplerate_tbl[]={SPS_250,SPS_500,SPS_1K,SPS_2K};
+static uint8_t  oversample = 1;             //!< ADS1299采样率 = 当前全局采样率 x 过采样抽取比
 static uint8_t curGain = GAIN_X24;
 static const uint8_t gain_tbl[]={GAIN_X1,GAIN_X2,GAIN_X4,GAIN_X6,GAIN_X8,GAIN_X24};
 
+/* 通道参数 */
+static uint8_t  chxEnable[CHANNEL_NUM];    //!< 0-关闭 1-启用
+static uint8_t  chxGain[CHANNEL_NUM];      //!< 增益 @ref Gain_tbl_t
+static uint8_t  chxMux[CHANNEL_NUM];       //!< 输入选择 0~7 @ref ADS1299 CHnSET MUX
+
 /* 事件触发 */
 static uint16_t trig_delay = 0; //TODO 10us为单位
 
+/* 数据通道发送 */
+static uint8_t  streamMode = STREAM_UNICAST;
+static uint32_t mcastAddr = STREAM_MCAST_DEFAULT;
+static uint8_t  eegdataFmt = 0;
+static uint8_t  fecK = 0;
+
+/* 设备端滤波 */
+static uint8_t  filterNotch = EEG_FILTER_NOTCH_OFF;
+static uint8_t  filterHp = EEG_FILTER_HP_OFF;
+static uint8_t  filterLp = EEG_FILTER_LP_OFF;
+
+/* 频带功率特征 */
+static uint8_t  featureMode = EEG_BAND_MODE_OFF;
+static uint16_t featureHop = EEG_BAND_HOP_DEFAULT;
+
+/* 诊断 */
+static uint32_t traceMask = TRACE_MASK_DEFAULT;
+SampleJitter_t sampleJitter;
+SampleLoss_t sampleLoss;
+TaskStat_t taskStat[TELEM_TASK_NUM];
+LatencyHist_t latencyAcq;
+LatencyHist_t latencyTx;
+SyncModel_t syncModel;
+
 /************************************************************************
  *  Attribute  Table
  */
@@ -89,17 +132,17 @@ const AttrTbl_t attr_tbl = {
                             (uint32_t*)&impMeas
                            },
 
-        //!< 阻抗测量方案 0- 正弦波测AC电阻 1- 测DC电阻 2- 交流激励测阻抗
+        //!< 阻抗测量方案 0- 交流激励7.8Hz 1- 交流激励31.2Hz，仅停止阻抗测量时可写
         .IMPMeas_MODE   = { ATTR_RW,
                             ATTR_CONFIG,
                             1,
                             (uint32_t*)&impMeas_mode
                            },
 
-        //!< 逐通道阻抗值
-        .IMPValue       = { ATTR_RW,
+        //!< 逐通道阻抗值 kΩ（float），饱和为-1
+        .IMPValue       = { ATTR_RO,
                             ATTR_MSG,
-                            sizeof(impMeasval), //TODO
+                            sizeof(impMeasval),
                             (uint32_t*)impMeasval
                            },
 
@@ -119,8 +162,8 @@ const AttrTbl_t attr_tbl = {
                             (uint32_t*)&netparam.IP_Addr,
                             },
 
-        //!<  EEG数据通道每包含AD样本数
-        .SampleNum      = { ATTR_RO,
+        //!<  EEG数据通道每包含AD样本数 1~UDP_SAMPLENUM_MAX，仅停止采样时可写
+        .SampleNum      = { ATTR_RW,
                             ATTR_CONFIG,
                             1,
                             (uint32_t*)&samplenum,
@@ -178,6 +221,173 @@ const AttrTbl_t attr_tbl = {
                             2,
                             (uint32_t*)&trig_delay
                             },                           
+
+   /*  ======================== 数据通道发送 ============================ */
+
+        //!< 数据通道发送方式 0-广播 1-逐订阅者单播（无订阅者时广播） 2-组播
+        .StreamMode     = { ATTR_RW,
+                            ATTR_CONFIG,
+                            1,
+                            (uint32_t*)&streamMode
+                            },
+
+        //!< 数据通道组播地址 224.0.0.0~239.255.255.255
+        .McastAddr      = { ATTR_RW,
+                            ATTR_CONFIG,
+                            4,
+                            (uint32_t*)&mcastAddr
+                            },
+
+        //!< 脑电数据通道可选格式 bit0-无损压缩
+        .EEGDataFmt     = { ATTR_RW,
+                            ATTR_CONFIG,
+                            1,
+                            (uint32_t*)&eegdataFmt
+                            },
+
+        //!< 脑电数据通道前向纠错 每K帧发送一个校验帧 0-不启用 2~16
+        .FecK           = { ATTR_RW,
+                            ATTR_CONFIG,
+                            1,
+                            (uint32_t*)&fecK
+                            },
+
+        //!< 采样时刻抖动统计 最大抖动ns 平均抖动ns 统计的采样间隔数 与I2C传输重叠的nDRDY次数
+        .SampleJitter   = { ATTR_RO,
+                            ATTR_MSG,
+                            sizeof(SampleJitter_t),
+                            (uint32_t*)&sampleJitter
+                            },
+
+        //!< 事件标签同步模型 频偏ppb 残差均方根ns 残差最大值ns 同步点对数
+        .SyncModel      = { ATTR_RO,
+                            ATTR_MSG,
+                            sizeof(SyncModel_t),
+                            (uint32_t*)&syncModel
+                            },
+
+   /*  ======================== 阻抗测量 ============================== */
+
+        //!< 阻抗值刷新间隔 ms IMP_INTERVAL_MIN~IMP_INTERVAL_MAX，仅停止阻抗测量时可写
+        .IMPMeas_Interval = { ATTR_RW,
+                            ATTR_CONFIG,
+                            2,
+                            (uint32_t*)&impMeas_interval
+                            },
+
+   /*  ======================== 设备端滤波 ============================ */
+
+        //!< 工频陷波 0-关闭 1-50Hz 2-60Hz，仅停止采样时可写
+        .FilterNotch    = { ATTR_RW,
+                            ATTR_CONFIG,
+                            1,
+                            (uint32_t*)&filterNotch
+                            },
+
+        //!< 高通滤波 0-关闭 1-0.1Hz 2-0.5Hz 3-1Hz，仅停止采样时可写
+        .FilterHp       = { ATTR_RW,
+                            ATTR_CONFIG,
+                            1,
+                            (uint32_t*)&filterHp
+                            },
+
+        //!< 低通滤波 0-关闭 1-35Hz 2-70Hz 3-100Hz，仅停止采样时可写
+        .FilterLp       = { ATTR_RW,
+                            ATTR_CONFIG,
+                            1,
+                            (uint32_t*)&filterLp
+                            },
+
+   /*  ======================== 过采样抽取 ============================ */
+
+        //!< 过采样抽取比 1（不抽取）、2、4 ... EEG_DECIM_RATIO_MAX，ADS1299以当前全局采样率的该倍数采集，
+        //!< 不超过EEG_DECIM_ADC_RATE_MAX，仅停止采样及阻抗测量时可写
+        .Oversample     = { ATTR_RW,
+                            ATTR_CONFIG,
+                            1,
+                            (uint32_t*)&oversample
+                            },
+
+   /*  ======================== 频带功率特征 ========================== */
+
+        //!< 特征流模式 0-不计算 1-频带功率特征帧 + 脑电数据帧 2-仅频带功率特征帧，仅停止采样时可写
+        .FeatureMode    = { ATTR_RW,
+                            ATTR_CONFIG,
+                            1,
+                            (uint32_t*)&featureMode
+                            },
+
+        //!< 频带功率更新间隔 ms，100~2000，窗长固定1.024s，仅停止采样时可写
+        .FeatureHop     = { ATTR_RW,
+                            ATTR_CONFIG,
+                            2,
+                            (uint32_t*)&featureHop
+                            },
+
+   /*  =========================== 诊断 ============================== */
+
+        //!< 样本丢失统计 丢失样本数 时间戳间隔异常次数 nDRDY溢出次数 采集块溢出数 SPI传输失败次数 发送丢帧数
+        .SampleLoss     = { ATTR_RO,
+                            ATTR_MSG,
+                            sizeof(SampleLoss_t),
+                            (uint32_t*)&sampleLoss
+                            },
+
+        //!< 线程运行统计 逐线程（tcpHandler udp1Worker controlTask SampleTask udp2Worker SyncTask DetectTask）CPU占用‰ 栈使用峰值 栈大小
+        .TaskStat       = { ATTR_RO,
+                            ATTR_MSG,
+                            sizeof(taskStat),
+                            (uint32_t*)taskStat
+                            },
+
+        //!< nDRDY至封包完毕时延直方图 16档计数 最大时延us
+        .LatencyAcq     = { ATTR_RO,
+                            ATTR_MSG,
+                            sizeof(LatencyHist_t),
+                            (uint32_t*)&latencyAcq
+                            },
+
+        //!< 封包完毕至发送完毕时延直方图 16档计数 最大时延us
+        .LatencyTx      = { ATTR_RO,
+                            ATTR_MSG,
+                            sizeof(LatencyHist_t),
+                            (uint32_t*)&latencyTx
+                            },
+
+        //!< 跟踪点使能 按位，bit n对应跟踪点编号n，0为停止记录
+        .TraceMask      = { ATTR_RW,
+                            ATTR_CONFIG,
+                            4,
+                            (uint32_t*)&traceMask
+                            },
+};
+
+
+/************************************************************************
+ *  Channel Attribute Table
+ */
+const ChxAttrTbl_t chxattr_tbl = {
+
+        //!< 通道开关 0-关闭（断电且输入短接，不占数据帧） 1-启用，仅停止采样时可写
+        .ChEnable       = { ATTR_RW,
+                            ATTR_SW,
+                            1,
+                            (uint32_t*)chxEnable
+                            },
+
+        //!< 通道增益 @ref Gain_tbl，仅停止采样时可写
+        .ChGain         = { ATTR_RW,
+                            ATTR_CONFIG,
+                            1,
+                            (uint32_t*)chxGain
+                            },
+
+        //!< 通道输入选择 0-正常电极输入 1-输入短接 ... 5-测试信号 7-BIAS_DRN，仅停止采样时可写
+        .ChMux          = { ATTR_RW,
+                            ATTR_CONFIG,
+                            1,
+                            (uint32_t*)chxMux
+                            },
 };
 
 
@@ -222,6 +432,14 @@ static uint8_t WriteAttrCB( uint8_t InsAttrNum,
                             uint8_t *pValue,
                             uint8_t len );
 
+static uint8_t checkValid( uint8_t InsAttrNum, uint8_t *pValue );
+
+static uint8_t ReadChxAttr( uint8_t ChxAttrNum, uint8_t CHxNum,
+                            uint8_t *pValue, uint8_t *pLen );
+
+static uint8_t WriteChxAttr( uint8_t ChxAttrNum, uint8_t CHxNum,
+                             uint8_t *pValue, uint8_t len );
+
 static AttrCBs_t attr_CBs =
 {
     .pfnReadAttrCB = ReadAttrCB,                    //!< 读属性回调函数指针
@@ -246,7 +464,12 @@ static uint8_t ReadAttrCB(  uint8_t InsAttrNum,uint8_t CHxNum,
     uint8_t status = ATTR_SUCCESS;
     uint8_t *pAttrValue;    //!< 属性值地址
 
-    if( (InsAttrNum > ATTR_NUM ) && ( CHxNum == 0xFF ))
+    if( CHxNum != 0xFF )
+    {
+        return ReadChxAttr(InsAttrNum, CHxNum, pValue, pLen); //!< 通道属性
+    }
+
+    if( InsAttrNum >= ATTR_NUM )
     {
         status = ATTR_NOT_FOUND; //!< 属性不存在
     }
@@ -254,15 +477,220 @@ static uint8_t ReadAttrCB(  uint8_t InsAttrNum,uint8_t CHxNum,
     //!< 读属性值
     if(status == ATTR_SUCCESS)
     {
+        pthread_mutex_lock(&AttrMutex);
         pAttrValue = (uint8_t*)*(uint32_t*)(pattr_offset[InsAttrNum]+3);//!< 属性值地址传递
         *pLen = *(pattr_offset[InsAttrNum]+2); //!< 属性值大小传递（值传递!地址不变 9.13）
         memcpy(pValue,pAttrValue,*pLen); //!< 属性值读取
+        pthread_mutex_unlock(&AttrMutex);
     }
 
     return status;
 
 }
 
+/*!
+    \brief  checkValid      写属性值有效性校验
+
+    \param  InsAttrNum      待写入属性编号
+            pValue          待写入数据的指针
+
+    \return ATTR_SUCCESS    属性值有效
+            ATTR_VAL_INVALID 属性值非法或当前状态不允许修改
+ */
+static uint8_t checkValid( uint8_t InsAttrNum, uint8_t *pValue )
+{
+    uint8_t status = ATTR_SUCCESS;
+
+    switch(InsAttrNum)
+    {
+        case SAMPLING:
+            if( impMeas && (*pValue == SAMPLE_START) )
+            {
+                status = ATTR_VAL_INVALID; //!< 阻抗测量与采样不能同时进行
+            }
+            else if( sampling && (*pValue == SAMPLE_START) )
+            {
+                status = ATTR_VAL_INVALID; //!< 已在采样，重复开始会在DMA传输中重新打开SPI并复位采集块
+            }
+            break;
+
+        case IMPMEAS:
+            if( sampling && (*pValue == IMPMES_START) )
+            {
+                status = ATTR_VAL_INVALID; //!< 阻抗测量与采样不能同时进行
+            }
+            break;
+
+        case IMPMEAS_MODE:
+            if( impMeas || (*pValue > IMP_FREQ_31HZ2) )
+            {
+                status = ATTR_VAL_INVALID;
+            }
+            break;
+
+        case IMPMEAS_INTERVAL:
+        {
+            uint16_t Interval;
+            memcpy(&Interval,pValue,2);
+            if( impMeas || (Interval < IMP_INTERVAL_MIN) || (Interval > IMP_INTERVAL_MAX) )
+            {
+                status = ATTR_VAL_INVALID;
+            }
+            break;
+        }
+
+        case SAMPLE_NUM:
+            if( sampling )
+            {
+                status = ATTR_VAL_INVALID; //!< 采样中帧长度不允许变化
+            }
+            else if( (*pValue == 0) || (*pValue > UDP_SAMPLENUM_MAX) )
+            {
+                status = ATTR_VAL_INVALID; //!< 超出单个UDP载荷容量
+            }
+            break;
+
+        case STREAM_MODE:
+            if( *pValue > STREAM_MULTICAST )
+            {
+                status = ATTR_VAL_INVALID;
+            }
+            break;
+
+        case MCAST_ADDR:
+            if( (pValue[3] & 0xF0) != 0xE0 )
+            {
+                status = ATTR_VAL_INVALID; //!< 非D类地址（小端存储，最高字节在pValue[3]）
+            }
+            break;
+
+        case EEGDATA_FMT:
+            if( *pValue & ~EEGDATA_OPT_MASK )
+            {
+                status = ATTR_VAL_INVALID; //!< 不支持的格式
+            }
+            break;
+
+        case FILTER_NOTCH:
+        case FILTER_HP:
+        case FILTER_LP:
+        {
+            uint8_t Notch = (InsAttrNum == FILTER_NOTCH) ? *pValue : filterNotch;
+            uint8_t Hp = (InsAttrNum == FILTER_HP) ? *pValue : filterHp;
+            uint8_t Lp = (InsAttrNum == FILTER_LP) ? *pValue : filterLp;
+            if( sampling )
+            {
+                status = ATTR_VAL_INVALID; //!< 滤波器状态在开始采样时清零，采样中不允许修改
+            }
+            else if( !EEGFilter_IsSupported(curSamprate, Notch, Hp, Lp) )
+            {
+                status = ATTR_VAL_INVALID; //!< 方案非法或当前采样率无滤波系数
+            }
+            break;
+        }
+
+        case OVERSAMPLE:
+            if( sampling || impMeas || (*pValue == 0) || (*pValue & (*pValue - 1)) ||
+                ((uint32_t)curSamprate * *pValue > EEG_DECIM_ADC_RATE_MAX) )
+            {
+                status = ATTR_VAL_INVALID; //!< 非2的幂或ADS1299采样率超出SPI读取能力
+            }
+            break;
+
+        case CURSAMPLERATE:
+        {
+            uint16_t Rate;
+            uint8_t i;
+            memcpy(&Rate,pValue,2);
+            if( sampling || impMeas )
+            {
+                status = ATTR_VAL_INVALID; //!< 采集期间SPI工作于回调模式，不允许访问寄存器
+                break;
+            }
+            status = ATTR_VAL_INVALID;
+            for(i=0; i<sizeof(samplerate_tbl)/sizeof(samplerate_tbl[0]); i++)
+            {
+                if( Rate == samplerate_tbl[i] )
+                    status = ATTR_SUCCESS;
+            }
+            if( (status != ATTR_SUCCESS) || (Rate > EEG_DECIM_ADC_RATE_MAX) )
+            {
+                status = ATTR_VAL_INVALID; //!< 不在支持的采样率挡位中，或超出ADS1299采集能力
+            }
+            else if( (uint32_t)Rate * oversample > EEG_DECIM_ADC_RATE_MAX )
+            {
+                status = ATTR_VAL_INVALID; //!< 与过采样抽取比组合后超出ADS1299采集能力
+            }
+            else if( !EEGFilter_IsSupported(Rate, filterNotch, filterHp, filterLp) ||
+                     !EEGBand_IsSupported(featureMode, Rate) )
+            {
+                status = ATTR_VAL_INVALID; //!< 已启用的设备端滤波或频带功率特征不支持该采样率，须先关闭
+            }
+            break;
+        }
+
+        case CURGAIN:
+        {
+            uint8_t i;
+            if( sampling || impMeas )
+            {
+                status = ATTR_VAL_INVALID; //!< 采集期间SPI工作于回调模式，不允许访问寄存器
+                break;
+            }
+            status = ATTR_VAL_INVALID;
+            for(i=0; i<sizeof(gain_tbl); i++)
+            {
+                if( *pValue == gain_tbl[i] )
+                    status = ATTR_SUCCESS;
+            }
+            break;
+        }
+
+        case FEATURE_MODE:
+            if( sampling )
+            {
+                status = ATTR_VAL_INVALID; //!< 频带功率窗在开始采样时清空，采样中不允许修改
+            }
+            else if( !EEGBand_IsSupported(*pValue, curSamprate) )
+            {
+                status = ATTR_VAL_INVALID; //!< 模式非法或当前采样率不支持频带功率特征
+            }
+            break;
+
+        case FEATURE_HOP:
+        {
+            uint16_t Hop;
+            memcpy(&Hop,pValue,2);
+            if( sampling || (Hop < EEG_BAND_HOP_MIN) || (Hop > EEG_BAND_HOP_MAX) )
+            {
+                status = ATTR_VAL_INVALID;
+            }
+            break;
+        }
+
+        case TRACE_MASK:
+        {
+            uint32_t Mask;
+            memcpy(&Mask,pValue,4);
+            if( Mask & ~TRACE_MASK_ALL )
+            {
+                status = ATTR_VAL_INVALID; //!< 跟踪点不存在
+            }
+            break;
+        }
+
+        case FEC_K:
+            if( (*pValue != 0) &&
+                ((*pValue < UDP_FEC_K_MIN) || (*pValue > UDP_FEC_K_MAX)) )
+            {
+                status = ATTR_VAL_INVALID;
+            }
+            break;
+    }
+
+    return status;
+}
+
 /*!
     \brief  WriteAttrCB     写属性回调函数
   
@@ -275,6 +703,7 @@ static uint8_t ReadAttrCB(  uint8_t InsAttrNum,uint8_t CHxNum,
             ATTR_NOT_FOUND  属性不存在
             ATTR_ERR_RO     属性不允许写操作
             ATTR_ERR_SIZE   待写数据长度与属性值长度不符
+            ATTR_VAL_INVALID 待写数据非法
  */
 static uint8_t WriteAttrCB( uint8_t InsAttrNum,uint8_t CHxNum,
                             uint8_t *pValue, uint8_t len )
@@ -286,15 +715,21 @@ static uint8_t WriteAttrCB( uint8_t InsAttrNum,uint8_t CHxNum,
     uint8_t AttrLen;        //!< 属性值大小
     uint8_t *pAttrValue;    //!< 属性值地址
 
+    if( CHxNum != 0xFF )
+    {
+        return WriteChxAttr(InsAttrNum, CHxNum, pValue, len); //!< 通道属性
+    }
+
+    if( InsAttrNum >= ATTR_NUM )
+    {
+        return ATTR_NOT_FOUND; //!< 属性不存在
+    }
+
     AttrPermission = *(pattr_offset[InsAttrNum]);
     AttrType = *(pattr_offset[InsAttrNum]+1);
     AttrLen = *(pattr_offset[InsAttrNum]+2);
 
-    if( (InsAttrNum > ATTR_NUM ) && ( CHxNum == 0xFF ))
-    {
-        status = ATTR_NOT_FOUND; //!< 属性不存在
-    }
-    else if( AttrPermission == ATTR_RO )
+    if( AttrPermission == ATTR_RO )
     {
         status = ATTR_ERR_RO; //!< 属性不允许写操作
     }
@@ -304,8 +739,15 @@ static uint8_t WriteAttrCB( uint8_t InsAttrNum,uint8_t CHxNum,
     }
     else status = ATTR_SUCCESS;
 
+    //!< 校验与写入须在同一临界区内，避免两个连接先后通过校验再写入
+    pthread_mutex_lock(&AttrMutex);
+
     //!< 根据写属性类型校验写入数据有效性
-    // TODO 写属性类型是配置类型时，需要检查该值是否是配置类型有效值，checkValid();
+    // 写属性类型是配置类型时，需要检查该值是否是配置类型有效值
+    if(status == ATTR_SUCCESS)
+    {
+        status = checkValid(InsAttrNum, pValue);
+    }
 
     //!< 写属性值并通知应用层（AttrChange_Process）
     if(status == ATTR_SUCCESS)
@@ -314,17 +756,154 @@ static uint8_t WriteAttrCB( uint8_t InsAttrNum,uint8_t CHxNum,
 
         memcpy(pAttrValue,pValue,len); //!< 属性值写入
         notifyApp=InsAttrNum;
+
+        if( InsAttrNum == CURGAIN )
+        {
+            memset(chxGain,*pValue,CHANNEL_NUM); //!< 全局增益作用于全部通道
+        }
     }
 
-    if( (notifyApp!=0xFF) && pAppCallbacks )
+    pthread_mutex_unlock(&AttrMutex);
+
+    if( notifyApp!=0xFF )
     {
-        (*pAppCallbacks)(notifyApp);
+        if( pAppCallbacks )
+            (*pAppCallbacks)(notifyApp);
+
+        TCP_AttrNotify(notifyApp); //!< 推送给订阅者
     }
 
     return status;
 
 }
 
+/*!
+    \brief  ReadChxAttr     读通道属性
+
+    \param  ChxAttrNum      待读通道属性编号
+            CHxNum          通道编号，CHX_ALL读取全部通道
+            pValue          属性值 （to be returned）
+            pLen            属性值大小（to be returned）
+
+    \return ATTR_SUCCESS    读取属性值成功
+            ATTR_NOT_FOUND  属性或通道不存在
+ */
+static uint8_t ReadChxAttr( uint8_t ChxAttrNum, uint8_t CHxNum,
+                            uint8_t *pValue, uint8_t *pLen )
+{
+    const Attr_t *pAttr;
+
+    if( (ChxAttrNum >= CHXATTR_NUM) || ((CHxNum >= CHANNEL_NUM) && (CHxNum != CHX_ALL)) )
+    {
+        return ATTR_NOT_FOUND;
+    }
+
+    pAttr = pchxattr[ChxAttrNum];
+
+    pthread_mutex_lock(&AttrMutex);
+    if( CHxNum == CHX_ALL )
+    {
+        *pLen = pAttr->Attrsize * CHANNEL_NUM;
+        memcpy(pValue,pAttr->pAttrValue,*pLen);
+    }
+    else
+    {
+        *pLen = pAttr->Attrsize;
+        memcpy(pValue,(uint8_t*)pAttr->pAttrValue + CHxNum * pAttr->Attrsize,*pLen);
+    }
+    pthread_mutex_unlock(&AttrMutex);
+
+    return ATTR_SUCCESS;
+}
+
+/*!
+    \brief  WriteChxAttr    写通道属性
+
+    ADS1299各芯片共用片选，寄存器写入为广播，通道n、n+8、n+16、n+24共用同一CHnSET寄存器，
+    写入增益或输入选择时同步修改共用寄存器的各通道，属性值与硬件配置保持一致。
+    通道开关逐通道独立：共用寄存器的通道全部关闭时该寄存器才断电，未启用的通道不占数据帧。
+
+    \param  ChxAttrNum      待写入通道属性编号
+            CHxNum          通道编号，CHX_ALL写入全部通道
+            pValue          待写入数据的指针
+            len             待写入数据大小
+
+    \return ATTR_SUCCESS    写入属性值成功
+            ATTR_NOT_FOUND  属性或通道不存在
+            ATTR_ERR_SIZE   待写数据长度与属性值长度不符
+            ATTR_VAL_INVALID 待写数据非法或采样中
+ */
+static uint8_t WriteChxAttr( uint8_t ChxAttrNum, uint8_t CHxNum,
+                             uint8_t *pValue, uint8_t len )
+{
+    uint8_t status = ATTR_SUCCESS;
+    uint8_t *pAttrValue;
+    uint8_t i;
+
+    if( (ChxAttrNum >= CHXATTR_NUM) || ((CHxNum >= CHANNEL_NUM) && (CHxNum != CHX_ALL)) )
+    {
+        return ATTR_NOT_FOUND;
+    }
+
+    if( len != pchxattr[ChxAttrNum]->Attrsize )
+    {
+        return ATTR_ERR_SIZE;
+    }
+
+    pAttrValue = (uint8_t*)pchxattr[ChxAttrNum]->pAttrValue;
+
+    pthread_mutex_lock(&AttrMutex);
+
+    //!< 校验
+    if( sampling || impMeas )
+    {
+        status = ATTR_VAL_INVALID; //!< 采样或阻抗测量中通道配置及帧格式不允许变化
+    }
+    else switch(ChxAttrNum)
+    {
+        case CHX_ENABLE:
+            if( *pValue > 1 )
+                status = ATTR_VAL_INVALID;
+            break;
+
+        case CHX_GAIN:
+            status = ATTR_VAL_INVALID;
+            for(i=0; i<sizeof(gain_tbl); i++)
+            {
+                if( *pValue == gain_tbl[i] )
+                    status = ATTR_SUCCESS;
+            }
+            break;
+
+        case CHX_MUX:
+            if( *pValue > 7 )
+                status = ATTR_VAL_INVALID;
+            break;
+    }
+
+    //!< 写入
+    if( status == ATTR_SUCCESS )
+    {
+        for(i=0; i<CHANNEL_NUM; i++)
+        {
+            if( (CHxNum == CHX_ALL) || (i == CHxNum) ||
+                ((ChxAttrNum != CHX_ENABLE) && ((i & 0x07) == (CHxNum & 0x07))) )
+            {
+                pAttrValue[i] = *pValue;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&AttrMutex);
+
+    if( (status == ATTR_SUCCESS) && pAppCallbacks )
+    {
+        (*pAppCallbacks)(CHXATTR_CHANGE);
+    }
+
+    return status;
+}
+
 
 /************************************************************************
  * FUNCTIONS
@@ -342,6 +921,8 @@ static uint8_t WriteAttrCB( uint8_t InsAttrNum,uint8_t CHxNum,
 void AttrTbl_Init()
 {
 
+    pthread_mutex_init(&AttrMutex, NULL);
+
     /* 向控制通道协议层 注册属性值读写回调函数 */
     protocol_RegisterAttrCBs(&attr_CBs);
 
@@ -370,6 +951,34 @@ void AttrTbl_Init()
     pattr_offset[CURGAIN] = (uint8_t*)&attr_tbl.CurGain.permissions;
     
     pattr_offset[TRIGDELAY] = (uint8_t*)&attr_tbl.Trig_delay.permissions;
+
+    pattr_offset[STREAM_MODE] = (uint8_t*)&attr_tbl.StreamMode.permissions;
+    pattr_offset[MCAST_ADDR] = (uint8_t*)&attr_tbl.McastAddr.permissions;
+    pattr_offset[EEGDATA_FMT] = (uint8_t*)&attr_tbl.EEGDataFmt.permissions;
+    pattr_offset[FEC_K] = (uint8_t*)&attr_tbl.FecK.permissions;
+    pattr_offset[SAMPLE_JITTER] = (uint8_t*)&attr_tbl.SampleJitter.permissions;
+    pattr_offset[SYNC_MODEL] = (uint8_t*)&attr_tbl.SyncModel.permissions;
+    pattr_offset[IMPMEAS_INTERVAL] = (uint8_t*)&attr_tbl.IMPMeas_Interval.permissions;
+    pattr_offset[FILTER_NOTCH] = (uint8_t*)&attr_tbl.FilterNotch.permissions;
+    pattr_offset[FILTER_HP] = (uint8_t*)&attr_tbl.FilterHp.permissions;
+    pattr_offset[FILTER_LP] = (uint8_t*)&attr_tbl.FilterLp.permissions;
+    pattr_offset[OVERSAMPLE] = (uint8_t*)&attr_tbl.Oversample.permissions;
+    pattr_offset[FEATURE_MODE] = (uint8_t*)&attr_tbl.FeatureMode.permissions;
+    pattr_offset[FEATURE_HOP] = (uint8_t*)&attr_tbl.FeatureHop.permissions;
+    pattr_offset[SAMPLE_LOSS] = (uint8_t*)&attr_tbl.SampleLoss.permissions;
+    pattr_offset[TASK_STAT] = (uint8_t*)&attr_tbl.TaskStat.permissions;
+    pattr_offset[LATENCY_ACQ] = (uint8_t*)&attr_tbl.LatencyAcq.permissions;
+    pattr_offset[LATENCY_TX] = (uint8_t*)&attr_tbl.LatencyTx.permissions;
+    pattr_offset[TRACE_MASK] = (uint8_t*)&attr_tbl.TraceMask.permissions;
+
+    //!< 通道属性 - 默认全部通道启用，增益x24，正常电极输入
+    pchxattr[CHX_ENABLE] = &chxattr_tbl.ChEnable;
+    pchxattr[CHX_GAIN] = &chxattr_tbl.ChGain;
+    pchxattr[CHX_MUX] = &chxattr_tbl.ChMux;
+
+    memset(chxEnable,1,CHANNEL_NUM);
+    memset(chxGain,curGain,CHANNEL_NUM);
+    memset(chxMux,0,CHANNEL_NUM);
 }
 
 
@@ -386,6 +995,8 @@ uint8_t App_GetAttr(uint8_t InsAttrNum, uint32_t *pValue)
 {
     uint8_t ret = true;
 
+    pthread_mutex_lock(&AttrMutex);
+
     switch(InsAttrNum)
     {
         case SAMPLING:
@@ -396,6 +1007,18 @@ uint8_t App_GetAttr(uint8_t InsAttrNum, uint32_t *pValue)
             memcpy(pValue,&curSamprate,4);
             break;
 
+        case IMPMEAS:
+            memcpy(pValue,&impMeas,1);
+            break;
+
+        case IMPMEAS_MODE:
+            memcpy(pValue,&impMeas_mode,1);
+            break;
+
+        case IMPMEAS_INTERVAL:
+            memcpy(pValue,&impMeas_interval,2);
+            break;
+
         case CURGAIN:
             memcpy(pValue,&curGain,4);
             break;
@@ -403,10 +1026,77 @@ uint8_t App_GetAttr(uint8_t InsAttrNum, uint32_t *pValue)
         case TRIGDELAY:
             memcpy(pValue,&trig_delay,2);
             break;
+
+        case SAMPLE_NUM:
+            memcpy(pValue,&samplenum,1);
+            break;
+
+        case STREAM_MODE:
+            memcpy(pValue,&streamMode,1);
+            break;
+
+        case MCAST_ADDR:
+            memcpy(pValue,&mcastAddr,4);
+            break;
+
+        case EEGDATA_FMT:
+            memcpy(pValue,&eegdataFmt,1);
+            break;
+
+        case FEC_K:
+            memcpy(pValue,&fecK,1);
+            break;
+
+        case FILTER_NOTCH:
+            memcpy(pValue,&filterNotch,1);
+            break;
+
+        case FILTER_HP:
+            memcpy(pValue,&filterHp,1);
+            break;
+
+        case FILTER_LP:
+            memcpy(pValue,&filterLp,1);
+            break;
+
+        case OVERSAMPLE:
+            memcpy(pValue,&oversample,1);
+            break;
+
+        case FEATURE_MODE:
+            memcpy(pValue,&featureMode,1);
+            break;
+
+        case FEATURE_HOP:
+            memcpy(pValue,&featureHop,2);
+            break;
+
+        case TRACE_MASK:
+            memcpy(pValue,&traceMask,4);
+            break;
     }
+
+    pthread_mutex_unlock(&AttrMutex);
+
   return ( ret );
 }
 
+/*!
+    \brief  读通道属性函数 （供应用层获取全部通道的属性值）
+
+    \param  ChxAttrNum - 通道属性编号
+            pValue - 属性值（to be returned），不小于CHANNEL_NUM字节
+
+    \return true 读取属性值成功
+            false 通道属性不存在
+ */
+uint8_t App_GetChxAttr(uint8_t ChxAttrNum, uint8_t *pValue)
+{
+    uint8_t Len;
+
+    return ( ReadChxAttr(ChxAttrNum, CHX_ALL, pValue, &Len) == ATTR_SUCCESS );
+}
+
 /*!
     \brief  写属性函数 （供应用层修改属性值）
 
@@ -420,14 +1110,67 @@ uint8_t App_WriteAttr(uint8_t InsAttrNum, uint8_t Value)
 {
     uint8_t ret = true;
 
+    pthread_mutex_lock(&AttrMutex);
+
     switch(InsAttrNum)
     {
         case SAMPLING:
             sampling=Value; //TODO 开关类型属性需要状态机实现
             break;
 
+        case IMPMEAS:
+            impMeas=Value;
+            break;
+
         case TRIGDELAY:
             break;
     }
+
+    pthread_mutex_unlock(&AttrMutex);
+
+    TCP_AttrNotify(InsAttrNum); //!< 推送给订阅者
+
   return ( ret );
 }
+
+/*!
+    \brief  写消息类型属性函数 （供服务发布统计结果）
+
+    服务在本地完成一次完整的统计后整体写入属性值，与ReadAttrCB在同一互斥锁内拷贝，
+    上位机读取及推送不会取到只更新了一部分字段的结构体。不通知订阅者，需要时再调用Attr_Notify()。
+
+    \param  InsAttrNum - 消息类型属性编号
+            pValue - 完整的属性值，大小同属性值
+
+    \return true 写入成功
+            false 属性不存在或不是消息类型
+ */
+uint8_t App_WriteMsgAttr(uint8_t InsAttrNum, const void *pValue)
+{
+    uint8_t *pAttrValue;
+
+    if( (InsAttrNum >= ATTR_NUM) || (*(pattr_offset[InsAttrNum]+1) != ATTR_MSG) )
+    {
+        return false;
+    }
+
+    pthread_mutex_lock(&AttrMutex);
+    pAttrValue = (uint8_t*)*(uint32_t*)(pattr_offset[InsAttrNum]+3);//!< 属性值地址传递
+    memcpy(pAttrValue,pValue,*(pattr_offset[InsAttrNum]+2));
+    pthread_mutex_unlock(&AttrMutex);
+
+    return true;
+}
+
+/*!
+    \brief  属性值更新通知 （供服务更新消息类型属性后调用）
+
+    服务经App_WriteMsgAttr()写入属性值（如采样时刻抖动统计、同步模型）后，
+    调用本函数通知订阅了该属性的上位机。不阻塞，可在任意线程中调用。
+
+    \param  InsAttrNum - 值已更新的属性编号
+ */
+void Attr_Notify(uint8_t InsAttrNum)
+{
+    TCP_AttrNotify(InsAttrNum);
+}
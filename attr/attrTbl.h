@@ -17,7 +17,7 @@
 /*******************************************************************
  * CONSTANTS
  */
-#define ATTR_NUM                        22      //!< 属性表支持的属性数量（除通道属性）
+#define ATTR_NUM                        34      //!< 属性表支持的属性数量（除通道属性）
 
 /* 属性权限 */
 #define ATTR_RO                         0x00    //!< 只读属性
@@ -45,6 +45,33 @@
 #define GAIN_TBL                        13
 #define CURGAIN                         14
 #define TRIGDELAY                       15
+#define STREAM_MODE                     16
+#define MCAST_ADDR                      17
+#define EEGDATA_FMT                     18
+#define FEC_K                           19
+#define SAMPLE_JITTER                   20
+#define SYNC_MODEL                      21
+#define IMPMEAS_INTERVAL                22
+#define FILTER_NOTCH                    23
+#define FILTER_HP                       24
+#define FILTER_LP                       25
+#define OVERSAMPLE                      26
+#define FEATURE_MODE                    27
+#define FEATURE_HOP                     28
+#define SAMPLE_LOSS                     29
+#define TASK_STAT                       30
+#define LATENCY_ACQ                     31
+#define LATENCY_TX                      32
+#define TRACE_MASK                      33
+
+/* 通道属性编号 @ref ChxAttr_Read */
+#define CHXATTR_NUM                     3       //!< 通道属性数量
+#define CHX_ENABLE                      0       //!< 通道开关
+#define CHX_GAIN                        1       //!< 通道增益
+#define CHX_MUX                         2       //!< 通道输入选择
+
+#define CHX_ALL                         0xFE    //!< 通道编号 - 全部通道（0xFF为普通属性）
+#define CHXATTR_CHANGE                  0xFE    //!< 属性值变化回调参数 - 通道属性变化
 
 /* 属性值定义 */
 
@@ -112,9 +139,53 @@ typedef struct
     Attr_t  Dev_charg;              //!< 仪器充电状态
     Attr_t  Dev_BAT_pct;            //!< 仪器电池电量百分比
     Attr_t  Dev_LPC;                //!< 仪器光污染控制
-    
+
+    /* 数据通道发送 */
+    Attr_t  StreamMode;             //!< 数据通道发送方式
+    Attr_t  McastAddr;              //!< 数据通道组播地址
+    Attr_t  EEGDataFmt;             //!< 脑电数据通道可选格式
+    Attr_t  FecK;                   //!< 脑电数据通道前向纠错每组帧数
+
+    /* 诊断 */
+    Attr_t  SampleJitter;           //!< 采样时刻抖动统计
+    Attr_t  SyncModel;              //!< 事件标签同步模型
+
+    /* 阻抗测量 */
+    Attr_t  IMPMeas_Interval;       //!< 阻抗值刷新间隔
+
+    /* 设备端滤波 */
+    Attr_t  FilterNotch;            //!< 工频陷波
+    Attr_t  FilterHp;               //!< 高通滤波
+    Attr_t  FilterLp;               //!< 低通滤波
+
+    /* 过采样抽取 */
+    Attr_t  Oversample;             //!< 过采样抽取比
+
+    /* 频带功率特征 */
+    Attr_t  FeatureMode;            //!< 特征流模式
+    Attr_t  FeatureHop;             //!< 频带功率更新间隔
+
+    /* 诊断 */
+    Attr_t  SampleLoss;             //!< 样本丢失统计
+    Attr_t  TaskStat;               //!< 线程运行统计
+    Attr_t  LatencyAcq;             //!< nDRDY至封包完毕时延直方图
+    Attr_t  LatencyTx;              //!< 封包完毕至发送完毕时延直方图
+    Attr_t  TraceMask;              //!< 跟踪点使能
+
 }AttrTbl_t;
 
+/*!
+ *  @def    ChxAttrTbl_t
+ *  @brief  通道属性表 结构体（属性值为CHANNEL_NUM个通道的数组，Attrsize为单个通道的值长度）
+ */
+typedef struct
+{
+    Attr_t  ChEnable;               //!< 通道开关
+    Attr_t  ChGain;                 //!< 通道增益
+    Attr_t  ChMux;                  //!< 通道输入选择
+
+}ChxAttrTbl_t;
+
 /*!
  *  @brief  支持的分档采样率表
  */
@@ -152,6 +223,70 @@ typedef struct
     
 }NETParam_t;
 
+/*!
+ *  @brief      采样时刻抖动统计（自开始采样起）
+ *              抖动 = 相邻两次nDRDY中断时刻的间隔与标称采样周期之差的绝对值
+ */
+typedef struct
+{
+    uint32_t MaxJitter_ns;      //!< 最大抖动 ns
+    uint32_t MeanJitter_ns;     //!< 平均抖动 ns
+    uint32_t IntervalCnt;       //!< 统计的采样间隔数
+    uint32_t I2COverlapCnt;     //!< 与事件标签I2C传输重叠的nDRDY次数
+
+}SampleJitter_t;
+
+/*!
+ *  @brief      样本丢失统计（自开始采样起）
+ *              任一计数增加时，覆盖该时段的数据帧帧头部FrameFmt置位UDP_FMT_SAMPLE_LOSS
+ */
+typedef struct
+{
+    uint32_t LostSampleNum;     //!< 由时间戳间隔推算的丢失样本数（ADS1299采样周期计）
+    uint32_t TimeGapCnt;        //!< 相邻样本时间戳间隔超过1.5个采样周期的次数
+    uint32_t DrdyOverrunCnt;    //!< 上一样本尚未读取完毕又来nDRDY的次数（阻塞读取方式下为SampleReady积压数）
+    uint32_t BlockOverrunCnt;   //!< 采样线程未及时处理而被覆盖的采集块数
+    uint32_t SpiErrorCnt;       //!< 读取量化值的SPI传输失败次数
+    uint32_t TxOverrunCnt;      //!< 发送跟不上采集而丢弃的数据帧数
+
+}SampleLoss_t;
+
+/*!
+ *  @brief      线程运行统计 @ref service/telemetry.h TELEM_TASK_TCP ...
+ */
+typedef struct
+{
+    uint16_t Load_pm;           //!< 上一统计周期的CPU占用 ‰（唤醒至再次阻塞的时长，含被抢占的时间）
+    uint16_t StackPeak;         //!< 栈使用峰值 字节
+    uint16_t StackSize;         //!< 栈大小 字节
+
+}TaskStat_t;
+
+/*!
+ *  @brief      时延直方图（自开始采样起）
+ *              第0档为2us以下，第k档为[2^k, 2^(k+1))us，最后一档含32.768ms及以上
+ */
+#define LATENCY_BIN_NUM                 16      //!< 直方图档数
+
+typedef struct
+{
+    uint32_t Count[LATENCY_BIN_NUM];    //!< 各档次数
+    uint32_t Max_us;                    //!< 最大时延 us
+
+}LatencyHist_t;
+
+/*!
+ *  @brief      事件标签同步模型（cc3235S系统时间与cc1310 RAT的线性拟合）
+ */
+typedef struct
+{
+    int32_t  Skew_ppb;          //!< RAT相对系统时钟的频偏 ppb
+    uint32_t ResidualRms_ns;    //!< 拟合残差均方根 ns
+    uint32_t ResidualMax_ns;    //!< 拟合残差最大值 ns
+    uint8_t  PairNum;           //!< 参与拟合的同步点对数
+
+}SyncModel_t;
+
 
 
 /*!
@@ -169,5 +304,8 @@ void AttrTbl_Init();
 bool AttrTbl_RegisterAppCBs(void *appCallbacks);
 uint8_t App_GetAttr(uint8_t InsAttrNum, uint32_t *pValue);
 uint8_t App_WriteAttr(uint8_t InsAttrNum, uint8_t Value);
+uint8_t App_GetChxAttr(uint8_t ChxAttrNum, uint8_t *pValue);
+uint8_t App_WriteMsgAttr(uint8_t InsAttrNum, const void *pValue);
+void Attr_Notify(uint8_t InsAttrNum);
 
 #endif /* __ATTRTBL_H */
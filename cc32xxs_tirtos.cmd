@@ -39,7 +39,7 @@
 
 --stack_size=1024   /* C stack is also used for ISR stack */
 
-HEAPSIZE = 0x8000;  /* Size of heap buffer used by HeapMem */
+HEAPSIZE = 0xA000;  /* Size of heap buffer used by HeapMem, holds the pthread stacks (see task/README.md) */
 
 MEMORY
 {
@@ -0,0 +1,199 @@
+/**
+ * @file    eegdata_decode.c
+ * @author  gjmsilly
+ * @brief   NanoEEG 上位机参考实现 - UDP1压缩脑电数据帧解码
+ *
+ *          还原 EEG_CodecEncode 生成的压缩帧，码流格式见 @ref protocol/README.md 。
+ *          与固件共用 protocol/eegdata_protocol.h 的帧格式定义，编译时通道数宏（Dev_Ch8 ...）须与固件一致。
+ * @version 1.0.0
+ * @date    2022-03-25
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "eegdata_decode.h"
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/*!
+    \brief  码流读取对象 - 高位在前
+ */
+typedef struct
+{
+    const uint8_t   *pBuf;          //!< 输入码流
+    uint16_t        Size;           //!< 码流字节数
+    uint32_t        BitPos;         //!< 已读位数
+    bool            Underflow;      //!< 码流不足
+} BitReader_t;
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static uint32_t SeriesBuf[UDP_SAMPLENUM_MAX];   //!< 解码序列
+
+/*********************************************************************
+ *  LOCAL FUNCTIONS
+ */
+
+/*!
+    \brief  BitRead
+
+    读取Bits位（高位在前），码流不足时置位Underflow并返回0
+ */
+static uint32_t BitRead(BitReader_t *pR, uint8_t Bits)
+{
+    uint32_t Val = 0;
+
+    while(Bits--)
+    {
+        if((pR->BitPos >> 3) >= pR->Size)
+        {
+            pR->Underflow = true;
+            return 0;
+        }
+        Val = (Val << 1) | ((pR->pBuf[pR->BitPos >> 3] >> (7 - (pR->BitPos & 7))) & 1);
+        pR->BitPos++;
+    }
+    return Val;
+}
+
+/*!
+    \brief  SeriesDecode
+
+    解码一个序列，与 EEG_CodecEncode 中的 SeriesEncode 互逆
+
+    \param  pR - 码流读取对象
+            pV - 序列（to be returned）
+            n  - 序列长度
+ */
+static void SeriesDecode(BitReader_t *pR, uint32_t *pV, uint8_t n)
+{
+    uint8_t  Order, Eff, k, i;
+    uint32_t u, q;
+    int32_t  e;
+
+    Order = BitRead(pR, EEG_CODEC_ORDER_BITS);
+    k = BitRead(pR, EEG_CODEC_K_BITS);
+
+    for(i=0; i<n; i++)
+    {
+        for(q=0; (q < EEG_CODEC_RICE_ESC) && BitRead(pR, 1); q++);
+
+        if(q < EEG_CODEC_RICE_ESC)
+            u = (q << k) | BitRead(pR, k);
+        else
+            u = BitRead(pR, 32);
+
+        e = (int32_t)((u >> 1) ^ (0U - (u & 1)));
+
+        Eff = (Order > i) ? i : Order;
+        switch(Eff)
+        {
+            case 0:  pV[i] = (uint32_t)e; break;
+            case 1:  pV[i] = (uint32_t)e + pV[i-1]; break;
+            default: pV[i] = (uint32_t)e + 2*pV[i-1] - pV[i-2]; break;
+        }
+    }
+}
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+
+/*!
+    \brief  EEG_CodecDecode
+
+    还原压缩帧为原始帧格式（帧头部压缩标志及通道掩码标志清零，未启用的通道量化值及状态填0）
+
+    \param  pIn    - 压缩帧
+            InLen  - 压缩帧字节数
+            pFrame - 原始帧（to be returned）
+
+    \return true - 解码成功
+            false - 码流异常
+ */
+bool EEG_CodecDecode(const uint8_t *pIn, uint16_t InLen, UDPDtFrame_t *pFrame)
+{
+    BitReader_t R;
+    uint8_t *pVal;
+    uint32_t ChMask = UDP_CHMASK_ALL;
+    uint16_t HeaderLen = UDP_HEADER_SIZE;
+    uint8_t SampleNum, GroupMask, Group, Ch, i;
+
+    if(InLen < UDP_HEADER_SIZE)
+        return false;
+
+    memcpy(&pFrame->sampleheader, pIn, UDP_HEADER_SIZE);
+    SampleNum = pFrame->sampleheader.UDPSampleNum[0];
+    if((SampleNum == 0) || (SampleNum > UDP_SAMPLENUM_MAX))
+        return false;
+
+    if(pFrame->sampleheader.FrameFmt & UDP_FMT_CHMASK)
+    {
+        if(InLen < UDP_HEADER_SIZE + UDP_CHMASK_SIZE)
+            return false;
+        memcpy(&ChMask, pIn + UDP_HEADER_SIZE, UDP_CHMASK_SIZE);
+        HeaderLen += UDP_CHMASK_SIZE;
+    }
+    pFrame->sampleheader.FrameFmt &= ~(UDP_FMT_COMPRESSED | UDP_FMT_CHMASK);
+
+    R.pBuf = pIn + HeaderLen;
+    R.Size = InLen - HeaderLen;
+    R.BitPos = 0;
+    R.Underflow = false;
+
+    for(i=0; i<SampleNum; i++)
+    {
+        pFrame->sampledata[i].FrameHeader = UDP_SAMPLE_FH;
+        pFrame->sampledata[i].Index[0] = i;
+        pFrame->sampledata[i].Index[1] = 0;
+        memset(pFrame->sampledata[i].ChannelVal, 0, UDP_SampleValSize);
+    }
+
+    SeriesDecode(&R, SeriesBuf, SampleNum);
+    for(i=0; i<SampleNum; i++)
+        memcpy(pFrame->sampledata[i].Timestamp, &SeriesBuf[i], 4);
+
+    for(Group=0; Group<UDP_CHGROUP_NUM; Group++)
+    {
+        GroupMask = (uint8_t)(ChMask >> (Group*8));
+        if(!GroupMask)
+            continue;
+
+        SeriesDecode(&R, SeriesBuf, SampleNum);
+        for(i=0; i<SampleNum; i++)
+        {
+            pVal = &pFrame->sampledata[i].ChannelVal[Group*UDP_CHGROUP_SIZE];
+            pVal[0] = (uint8_t)(SeriesBuf[i] >> 16);
+            pVal[1] = (uint8_t)(SeriesBuf[i] >> 8);
+            pVal[2] = (uint8_t)SeriesBuf[i];
+        }
+
+        for(Ch=0; Ch<8; Ch++)
+        {
+            if(!(GroupMask & (1 << Ch)))
+                continue;
+
+            SeriesDecode(&R, SeriesBuf, SampleNum);
+            for(i=0; i<SampleNum; i++)
+            {
+                pVal = &pFrame->sampledata[i].ChannelVal[Group*UDP_CHGROUP_SIZE + 3 + Ch*3];
+                pVal[0] = (uint8_t)(SeriesBuf[i] >> 16);
+                pVal[1] = (uint8_t)(SeriesBuf[i] >> 8);
+                pVal[2] = (uint8_t)SeriesBuf[i];
+            }
+        }
+    }
+
+    return !R.Underflow;
+}
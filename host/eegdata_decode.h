@@ -0,0 +1,27 @@
+/**
+ * @file    eegdata_decode.h
+ * @author  gjmsilly
+ * @brief   NanoEEG 上位机参考实现 - UDP1压缩脑电数据帧解码
+ * @version 1.0.0
+ * @date    2022-03-25
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef __HOST_EEGDATA_DECODE_H
+#define __HOST_EEGDATA_DECODE_H
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <protocol/eegdata_codec.h>
+
+/**********************************************************************
+ * FUNCTIONS
+ */
+bool EEG_CodecDecode(const uint8_t *pIn, uint16_t InLen, UDPDtFrame_t *pFrame);
+
+#endif  /* __HOST_EEGDATA_DECODE_H */
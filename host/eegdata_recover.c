@@ -0,0 +1,79 @@
+/**
+ * @file    eegdata_recover.c
+ * @author  gjmsilly
+ * @brief   NanoEEG 上位机参考实现 - UDP1脑电数据通道XOR前向纠错恢复
+ *
+ *          由 UDP_EEGFecPut 生成的校验帧及同组其余K-1帧恢复丢失的一帧，帧格式见 @ref protocol/README.md 。
+ * @version 1.0.0
+ * @date    2022-04-02
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "eegdata_recover.h"
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+
+/*!
+    \brief  EEG_FecRecover
+
+    由校验帧及同组其余K-1帧恢复丢失的一帧
+
+    \param  pParity   - 校验帧
+            ParityLen - 校验帧字节数
+            ppFrame   - 本组K帧（按滚动码顺序），丢失的一帧为NULL
+            pLen      - 本组K帧字节数，丢失帧对应项忽略
+            pOut      - 恢复的帧（to be returned），不小于UDP_DTx_Buff_Size
+
+    \return 恢复的帧字节数，0表示无法恢复（丢失帧数不为1或校验帧异常）
+ */
+uint16_t EEG_FecRecover(const uint8_t *pParity, uint16_t ParityLen,
+                        const uint8_t * const *ppFrame, const uint16_t *pLen,
+                        uint8_t *pOut)
+{
+    const UDPHeader_t *pHeader = (const UDPHeader_t *)pParity;
+    uint16_t PayloadLen, LostLen, i;
+    uint8_t K, Lost = 0xFF, n;
+
+    if( (ParityLen < UDP_HEADER_SIZE) ||
+        ((pHeader->FrameFmt & UDP_FMT_TYPE_MASK) != UDP_FMT_TYPE_FEC) )
+        return 0;
+
+    K = pHeader->UDP_ChannelNum;
+    PayloadLen = ParityLen - UDP_HEADER_SIZE;
+    memcpy(&LostLen, pHeader->UDPSampleNum, 2);
+
+    for(n=0; n<K; n++)
+    {
+        if( ppFrame[n] == NULL )
+        {
+            if( Lost != 0xFF )
+                return 0; //!< 丢失多于一帧
+            Lost = n;
+        }
+        else LostLen ^= pLen[n];
+    }
+    if( (Lost == 0xFF) || (LostLen > PayloadLen) )
+        return 0;
+
+    memcpy(pOut, pParity + UDP_HEADER_SIZE, LostLen);
+    for(n=0; n<K; n++)
+    {
+        if( n == Lost )
+            continue;
+        for(i=0; (i<pLen[n]) && (i<LostLen); i++)
+            pOut[i] ^= ppFrame[n][i];
+    }
+
+    return LostLen;
+}
@@ -0,0 +1,29 @@
+/**
+ * @file    eegdata_recover.h
+ * @author  gjmsilly
+ * @brief   NanoEEG 上位机参考实现 - UDP1脑电数据通道XOR前向纠错恢复
+ * @version 1.0.0
+ * @date    2022-04-02
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef __HOST_EEGDATA_RECOVER_H
+#define __HOST_EEGDATA_RECOVER_H
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <protocol/eegdata_fec.h>
+
+/**********************************************************************
+ * FUNCTIONS
+ */
+uint16_t EEG_FecRecover(const uint8_t *pParity, uint16_t ParityLen,
+                        const uint8_t * const *ppFrame, const uint16_t *pLen,
+                        uint8_t *pOut);
+
+#endif  /* __HOST_EEGDATA_RECOVER_H */
@@ -0,0 +1,34 @@
+#!/bin/sh
+# 主机端测试：在工程根目录执行 sh host/test/run.sh [gcc]
+# 逐个通道数（x8/x16/x24/x32）编译并运行 host/test 下的测试（与通道数无关的只运行一次），任一失败返回非0
+
+CC=${1:-gcc}
+OUT=${TMPDIR:-/tmp}/nanoeeg_host_test
+CFLAGS="-std=gnu99 -O2 -Wall -I. -Ihost/test/stubs"
+FAIL=0
+
+mkdir -p "$OUT" || exit 1
+
+for CH in 8 16 24 32; do
+    $CC $CFLAGS -DDev_Ch$CH -o "$OUT/test_codec_$CH" \
+        host/test/test_codec.c host/eegdata_decode.c protocol/eegdata_codec.c -lm \
+        && "$OUT/test_codec_$CH" || FAIL=1
+    $CC $CFLAGS -DDev_Ch$CH -o "$OUT/test_fec_$CH" \
+        host/test/test_fec.c host/eegdata_recover.c protocol/eegdata_fec.c \
+        && "$OUT/test_fec_$CH" || FAIL=1
+    $CC $CFLAGS -DDev_Ch$CH -o "$OUT/test_sample_loss_$CH" \
+        host/test/test_sample_loss.c -lpthread \
+        && "$OUT/test_sample_loss_$CH" || FAIL=1
+    $CC $CFLAGS -DDev_Ch$CH -o "$OUT/test_filter_$CH" \
+        host/test/test_filter.c -lm \
+        && "$OUT/test_filter_$CH" || FAIL=1
+    $CC $CFLAGS -DDev_Ch$CH -o "$OUT/test_bandpower_$CH" \
+        host/test/test_bandpower.c service/eeg_bandpower.c -lm \
+        && "$OUT/test_bandpower_$CH" || FAIL=1
+done
+
+$CC $CFLAGS -o "$OUT/test_trace" \
+    host/test/test_trace.c host/trace_decode.c service/trace.c -lm \
+    && "$OUT/test_trace" || FAIL=1
+
+exit $FAIL
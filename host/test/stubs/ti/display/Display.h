@@ -0,0 +1,19 @@
+/**
+ * @file    Display.h
+ * @author  gjmsilly
+ * @brief   主机端测试桩 - 仅提供固件引用的TI Display接口声明，由测试程序实现
+ * @version 1.0.0
+ * @date    2022-05-28
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef HOST_STUB_DISPLAY_H_
+#define HOST_STUB_DISPLAY_H_
+
+typedef struct Display_Config_ *Display_Handle;
+
+void Display_printf(Display_Handle handle, int line, int column, const char *fmt, ...);
+
+#endif /* HOST_STUB_DISPLAY_H_ */
@@ -0,0 +1,25 @@
+/**
+ * @file    GPIO.h
+ * @author  gjmsilly
+ * @brief   主机端测试桩 - 仅提供固件引用的TI GPIO驱动接口声明，由测试程序实现
+ * @version 1.0.0
+ * @date    2022-05-28
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef HOST_STUB_GPIO_H_
+#define HOST_STUB_GPIO_H_
+
+#include <stdint.h>
+
+typedef void (*GPIO_CallbackFxn)(uint_least8_t index);
+
+void GPIO_write(uint_least8_t index, unsigned int value);
+void GPIO_setCallback(uint_least8_t index, GPIO_CallbackFxn callback);
+void GPIO_enableInt(uint_least8_t index);
+void GPIO_disableInt(uint_least8_t index);
+void GPIO_clearInt(uint_least8_t index);
+
+#endif /* HOST_STUB_GPIO_H_ */
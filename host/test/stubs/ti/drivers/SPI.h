@@ -0,0 +1,39 @@
+/**
+ * @file    SPI.h
+ * @author  gjmsilly
+ * @brief   主机端测试桩 - 仅提供固件引用的TI SPI驱动类型
+ * @version 1.0.0
+ * @date    2022-05-28
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef HOST_STUB_SPI_H_
+#define HOST_STUB_SPI_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum
+{
+    SPI_TRANSFER_COMPLETED = 0,
+    SPI_TRANSFER_STARTED,
+    SPI_TRANSFER_QUEUED,
+    SPI_TRANSFER_FAILED,
+    SPI_TRANSFER_CANCELED
+} SPI_Status;
+
+typedef struct
+{
+    size_t      count;
+    void        *txBuf;
+    void        *rxBuf;
+    void        *arg;
+    SPI_Status  status;
+} SPI_Transaction;
+
+typedef struct SPI_Config_ *SPI_Handle;
+typedef void (*SPI_CallbackFxn)(SPI_Handle handle, SPI_Transaction *transaction);
+
+#endif /* HOST_STUB_SPI_H_ */
@@ -0,0 +1,24 @@
+/**
+ * @file    Timer.h
+ * @author  gjmsilly
+ * @brief   主机端测试桩 - 仅提供固件头文件引用的TI Timer驱动类型
+ * @version 1.0.0
+ * @date    2022-05-28
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef HOST_STUB_TIMER_H_
+#define HOST_STUB_TIMER_H_
+
+#include <stdint.h>
+
+typedef struct Timer_Config_ *Timer_Handle;
+
+typedef struct
+{
+    uint32_t period;
+} Timer_Params;
+
+#endif /* HOST_STUB_TIMER_H_ */
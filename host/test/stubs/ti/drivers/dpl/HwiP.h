@@ -0,0 +1,20 @@
+/**
+ * @file    HwiP.h
+ * @author  gjmsilly
+ * @brief   主机端测试桩 - 仅提供固件引用的TI DPL HwiP中断开关声明，由测试实现
+ * @version 1.0.0
+ * @date    2022-05-28
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef HOST_STUB_HWIP_H_
+#define HOST_STUB_HWIP_H_
+
+#include <stdint.h>
+
+uintptr_t HwiP_disable(void);
+void HwiP_restore(uintptr_t key);
+
+#endif /* HOST_STUB_HWIP_H_ */
@@ -0,0 +1,19 @@
+/**
+ * @file    ti_drivers_config.h
+ * @author  gjmsilly
+ * @brief   主机端测试桩 - 替代SysConfig生成的引脚配置
+ * @version 1.0.0
+ * @date    2022-05-28
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef HOST_STUB_TI_DRIVERS_CONFIG_H_
+#define HOST_STUB_TI_DRIVERS_CONFIG_H_
+
+#include <ti/drivers/GPIO.h>
+
+enum { Mod_nPWDN, Mod_nRESET, Mod_START, Mod_nDRDY, Mod_nCS };
+
+#endif /* HOST_STUB_TI_DRIVERS_CONFIG_H_ */
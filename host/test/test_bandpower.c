@@ -0,0 +1,251 @@
+/**
+ * @file    test_bandpower.c
+ * @author  gjmsilly
+ * @brief   主机端测试 - 设备端频带功率特征：定点CIC、基4 FFT与CIC衰减补偿
+ *
+ *          各输出采样率（250/500/1000/2000SPS）下，各通道输入一个落在频点上的正弦（依通道轮流取
+ *          δ/θ/α/β/γ频带中心频点，幅值各不相同，叠加直流）经 EEGBand_SamplePut 计算频带功率，
+ *          与双精度参考实现（CIC按FIR直接卷积、DFT、相同的Hann窗与补偿）比较，
+ *          并与正弦功率A^2/2比较；正弦所在频带相对误差须小于TEST_TOL，其余频带须小于正弦功率的TEST_LEAK。
+ * @version 1.0.0
+ * @date    2022-05-28
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include <service/eeg_bandpower.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_GAIN               24          //!< 通道增益
+#define TEST_HOP_MS             100         //!< 更新间隔 ms
+#define TEST_ANALYSIS_NUM       (EEG_BAND_FFT_N + 100) //!< 计算前送入的分析样本数，CIC暂态移出分析窗
+#define TEST_RATE_MAX           2000
+#define TEST_INPUT_MAX          ((TEST_ANALYSIS_NUM + 50) * (TEST_RATE_MAX / EEG_BAND_RATE))
+#define TEST_DC                 3000        //!< 叠加直流 LSB，检验去均值
+#define TEST_TOL                1e-3        //!< 正弦所在频带相对误差上限
+#define TEST_LEAK               1e-3        //!< 其余频带功率上限（相对正弦功率）
+#define TEST_PI                 3.14159265358979323846
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+
+/*!
+    \brief  各频带中心频点，与eeg_bandpower.c中的频点范围一致
+ */
+static const struct
+{
+    uint8_t     Lo;
+    uint8_t     Hi;
+    uint8_t     Center;
+} TestBand[EEG_BAND_NUM] = {
+    {  2,  4,  3 },                 //!< δ 1~4Hz
+    {  5,  8,  6 },                 //!< θ 4~8Hz
+    {  9, 13, 11 },                 //!< α 8~13Hz
+    { 14, 30, 22 },                 //!< β 13~30Hz
+    { 31, 46, 38 },                 //!< γ 30~45Hz
+};
+
+static int32_t          Input[CHANNEL_NUM][TEST_INPUT_MAX];     //!< 各通道输入样本
+static uint8_t          Sample[UDP_SampleValSize];              //!< 一个样本的ADS1299输出
+static double           RefPower[EEG_BAND_NUM];                 //!< 参考实现频带功率 uV^2
+
+static unsigned         Failures;
+static double           WorstErr;                               //!< 正弦所在频带最大相对误差
+
+/*********************************************************************
+ *  FAKES - 被测模块调用的协议层接口
+ */
+uint32_t UDP_EEGChMaskGet(void) { return UDP_CHMASK_ALL; }
+
+/*********************************************************************
+ *  LOCAL FUNCTIONS
+ */
+
+/*!
+    \brief  SamplePack
+
+    第n个输入样本写为ADS1299输出格式（逐通道组：状态3字节 + 8通道 x 大端int24）
+ */
+static void SamplePack(uint32_t n)
+{
+    uint8_t *pVal;
+    uint8_t Ch;
+
+    memset(Sample, 0, sizeof(Sample));
+    for(Ch=0; Ch<CHANNEL_NUM; Ch++)
+    {
+        pVal = Sample + (Ch >> 3) * UDP_CHGROUP_SIZE + 3 + (Ch & 0x07) * 3;
+        pVal[0] = (uint8_t)(Input[Ch][n] >> 16);
+        pVal[1] = (uint8_t)(Input[Ch][n] >> 8);
+        pVal[2] = (uint8_t)Input[Ch][n];
+    }
+}
+
+/*!
+    \brief  RefBandPower
+
+    双精度参考：以第Last个分析样本结尾的窗计算通道Ch的各频带功率
+
+    \param  Ch   - 通道
+            D    - CIC抽取比
+            Last - 窗内最后一个分析样本序号
+ */
+static void RefBandPower(uint8_t Ch, uint8_t D, uint32_t Last)
+{
+    static double h[3 * (TEST_RATE_MAX / EEG_BAND_RATE)];
+    double Win[EEG_BAND_FFT_N], Mean = 0, Re, Im, w, s, Droop, Lsb;
+    uint32_t m, n, i, HLen = 3 * D - 2;
+    int32_t Idx;
+    uint8_t Band, k;
+
+    /* CIC三阶冲激响应 = 三个长度D的矩形窗卷积，增益D^3 */
+    memset(h, 0, sizeof(h));
+    for(i=0; i<D; i++)
+        for(n=0; n<D; n++)
+            for(m=0; m<D; m++)
+                h[i + n + m] += 1.0 / ((double)D * D * D);
+
+    for(n=0; n<EEG_BAND_FFT_N; n++)
+    {
+        m = Last + 1 - EEG_BAND_FFT_N + n;
+        Win[n] = 0;
+        for(i=0; i<HLen; i++)
+        {
+            Idx = (int32_t)((m + 1) * D - 1 - i);
+            if( Idx >= 0 )
+                Win[n] += h[i] * Input[Ch][Idx];
+        }
+        Mean += Win[n];
+    }
+    Mean /= EEG_BAND_FFT_N;
+
+    Lsb = EEG_BAND_UV_PER_LSB / TEST_GAIN;
+    for(Band=0; Band<EEG_BAND_NUM; Band++)
+    {
+        RefPower[Band] = 0;
+        for(k=TestBand[Band].Lo; k<=TestBand[Band].Hi; k++)
+        {
+            Re = 0;
+            Im = 0;
+            for(n=0; n<EEG_BAND_FFT_N; n++)
+            {
+                w = (1 - cos(2 * TEST_PI * n / EEG_BAND_FFT_N)) / 2;
+                Re += (Win[n] - Mean) * w * cos(2 * TEST_PI * k * n / EEG_BAND_FFT_N);
+                Im -= (Win[n] - Mean) * w * sin(2 * TEST_PI * k * n / EEG_BAND_FFT_N);
+            }
+            s = sin(TEST_PI * k / EEG_BAND_FFT_N) / (D * sin(TEST_PI * k / EEG_BAND_FFT_N / D));
+            Droop = 1 / pow(s, 6);
+            RefPower[Band] += 16.0 / 3.0 * (Re * Re + Im * Im) / ((double)EEG_BAND_FFT_N * EEG_BAND_FFT_N) * Droop;
+        }
+        RefPower[Band] *= Lsb * Lsb;
+    }
+}
+
+/*!
+    \brief  TestRate
+
+    一个输出采样率下各通道输入频点正弦，比较设备端与参考实现的频带功率
+ */
+static void TestRate(uint16_t Samplerate)
+{
+    uint8_t Gain[CHANNEL_NUM];
+    uint8_t D = (uint8_t)(Samplerate / EEG_BAND_RATE);
+    const float *pResult;
+    double Amp[CHANNEL_NUM], Sine, Err, Lsb = EEG_BAND_UV_PER_LSB / TEST_GAIN;
+    uint32_t n, Analysis = 0;
+    uint8_t Ch, Band, Tone;
+    bool Done = false;
+
+    memset(Gain, TEST_GAIN, sizeof(Gain));
+    if( !EEGBand_Config(EEG_BAND_MODE_WITH_RAW, Samplerate, TEST_HOP_MS, Gain) )
+    {
+        printf("FAIL %u SPS: not supported\n", Samplerate);
+        Failures++;
+        return;
+    }
+
+    /* 通道Ch的正弦取第Ch % 5个频带的中心频点，幅值10~41uV */
+    for(Ch=0; Ch<CHANNEL_NUM; Ch++)
+    {
+        Tone = TestBand[Ch % EEG_BAND_NUM].Center;
+        Amp[Ch] = 10.0 + Ch;
+        for(n=0; n<TEST_INPUT_MAX; n++)
+            Input[Ch][n] = TEST_DC + (int32_t)lround(Amp[Ch] / Lsb *
+                           sin(2 * TEST_PI * Tone * n / ((double)EEG_BAND_FFT_N * D) + Ch));
+    }
+
+    for(n=0; (n<TEST_INPUT_MAX) && !Done; n++)
+    {
+        SamplePack(n);
+        if( EEGBand_SamplePut(Sample) )
+            Done = (n + 1) / D >= TEST_ANALYSIS_NUM;
+        if( (n + 1) % D == 0 )
+            Analysis = (n + 1) / D;
+    }
+    if( !Done )
+    {
+        printf("FAIL %u SPS: no result after %u inputs\n", Samplerate, (unsigned)n);
+        Failures++;
+        return;
+    }
+
+    pResult = EEGBand_Result();
+    for(Ch=0; Ch<CHANNEL_NUM; Ch++)
+    {
+        RefBandPower(Ch, D, Analysis - 1);
+        Tone = Ch % EEG_BAND_NUM;
+        Sine = Amp[Ch] * Amp[Ch] / 2;
+
+        for(Band=0; Band<EEG_BAND_NUM; Band++)
+        {
+            if( Band == Tone )
+            {
+                Err = fabs(pResult[Ch * EEG_BAND_NUM + Band] - RefPower[Band]) / RefPower[Band];
+                if( fabs(pResult[Ch * EEG_BAND_NUM + Band] - Sine) / Sine > Err )
+                    Err = fabs(pResult[Ch * EEG_BAND_NUM + Band] - Sine) / Sine;
+                if( Err > WorstErr )
+                    WorstErr = Err;
+                if( Err > TEST_TOL )
+                {
+                    printf("FAIL %u SPS ch%u band %u: %.4f uV^2, reference %.4f, sine %.4f\n",
+                           Samplerate, Ch, Band, pResult[Ch * EEG_BAND_NUM + Band], RefPower[Band], Sine);
+                    Failures++;
+                }
+            }
+            else if( pResult[Ch * EEG_BAND_NUM + Band] > TEST_LEAK * Sine )
+            {
+                printf("FAIL %u SPS ch%u band %u: leakage %.5f uV^2 (sine %.4f)\n",
+                       Samplerate, Ch, Band, pResult[Ch * EEG_BAND_NUM + Band], Sine);
+                Failures++;
+            }
+        }
+    }
+}
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+int main(void)
+{
+    TestRate(250);
+    TestRate(500);
+    TestRate(1000);
+    TestRate(2000);
+
+    printf("bandpower: worst in-band error %.2e\n", WorstErr);
+    printf("test_bandpower (%u ch): %s\n", CHANNEL_NUM, Failures ? "FAILED" : "passed");
+    return Failures ? 1 : 0;
+}
@@ -0,0 +1,380 @@
+/**
+ * @file    test_codec.c
+ * @author  gjmsilly
+ * @brief   主机端测试 - UDP1脑电数据帧无损压缩：编解码一致性、压缩率与编码耗时
+ *
+ *          1. 一致性：各样本数、通道掩码与信号（仿真脑电、满量程随机、转义极值、常数）下
+ *             EEG_CodecEncode 压缩后经 EEG_CodecDecode 还原，须与原始帧逐字节一致；
+ *          2. 压缩率与耗时：对录制数据（命令行给出）或仿真脑电逐帧压缩，统计压缩率及每帧编码耗时。
+ *
+ *          录制数据格式：小端int32，逐样本依次为CHANNEL_NUM个通道的量化值（int24符号扩展），
+ *          用法 test_codec [录制数据文件 [每包样本数]]
+ * @version 1.0.0
+ * @date    2022-05-28
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+
+#include <protocol/eegdata_codec.h>
+#include <host/eegdata_decode.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_SAMPLE_RATE        1000        //!< 仿真采样率 SPS
+#define TEST_TS_STEP            (100000 / TEST_SAMPLE_RATE) //!< 样本时间戳增量（10us）
+#define TEST_LSB_UV             (4.5e6 / 24 / 8388608)      //!< 增益24时1LSB对应的uV
+#define TEST_STATUS             0xC00000    //!< ADS1299状态字（导联均未脱落）
+#define TEST_BENCH_SECONDS      60          //!< 仿真数据时长 s
+#define TEST_RANDOM_FRAMES      2000        //!< 随机一致性测试帧数
+
+/* 信号类型 */
+#define SIG_EEG                 0           //!< 仿真脑电
+#define SIG_RANDOM              1           //!< 满量程随机
+#define SIG_EXTREME             2           //!< 正负满量程交替，触发转义
+#define SIG_CONST               3           //!< 常数
+#define SIG_NUM                 4
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static UDPDtFrame_t     Frame;                          //!< 原始帧
+static UDPDtFrame_t     Decoded;                        //!< 解码帧
+static uint8_t          Coded[UDP_DTx_Buff_Size];       //!< 压缩帧
+
+static uint32_t         Rng = 0x12345678;               //!< 伪随机数状态
+static double           Phase[CHANNEL_NUM];             //!< 仿真脑电 alpha节律相位
+static double           Drift[CHANNEL_NUM];             //!< 仿真脑电 基线漂移
+static uint32_t         SampleCnt;                      //!< 仿真样本计数
+
+static unsigned         Failures;
+
+/*********************************************************************
+ *  LOCAL FUNCTIONS
+ */
+
+static uint32_t Rand32(void)
+{
+    Rng ^= Rng << 13;
+    Rng ^= Rng >> 17;
+    Rng ^= Rng << 5;
+    return Rng;
+}
+
+static double RandGauss(void)
+{
+    double u1 = (Rand32() + 1.0) / 4294967297.0;
+    double u2 = (Rand32() + 1.0) / 4294967297.0;
+
+    return sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+}
+
+/*!
+    \brief  SimEEG
+
+    仿真一个通道的一个样本：10Hz alpha节律（约20uV）+ 50Hz工频（5uV）+ 基线漂移 + 1uV白噪声
+
+    \return int24量化值
+ */
+static int32_t SimEEG(uint8_t Ch)
+{
+    double t = (double)SampleCnt / TEST_SAMPLE_RATE;
+    double uV;
+
+    Phase[Ch] += 2 * M_PI * (10.0 + 0.1 * Ch) / TEST_SAMPLE_RATE;
+    Drift[Ch] += 0.05 * RandGauss();
+    uV = 20 * sin(Phase[Ch]) + 5 * sin(2 * M_PI * 50 * t + Ch) + Drift[Ch] + RandGauss();
+
+    return (int32_t)lround(uV / TEST_LSB_UV);
+}
+
+static void ValWrite(uint8_t *p, uint32_t Val)
+{
+    p[0] = (uint8_t)(Val >> 16);
+    p[1] = (uint8_t)(Val >> 8);
+    p[2] = (uint8_t)Val;
+}
+
+/*!
+    \brief  FrameHeaderFill
+
+    填写帧头部：未启用全部通道时有效通道数为启用的通道数，与编码后一致
+ */
+static void FrameHeaderFill(uint8_t SampleNum, uint32_t ChMask)
+{
+    uint32_t Num = 0x01020304;
+    uint8_t Ch, Cnt = 0;
+
+    for(Ch=0; Ch<CHANNEL_NUM; Ch++)
+        Cnt += (ChMask >> Ch) & 1;
+
+    memset(&Frame.sampleheader, 0, UDP_HEADER_SIZE);
+    Frame.sampleheader.DevID = 0x4E454547;
+    memcpy(Frame.sampleheader.UDPNum, &Num, 4);
+    Frame.sampleheader.UDPSampleNum[0] = SampleNum;
+    Frame.sampleheader.UDP_ChannelNum = (ChMask == UDP_CHMASK_ALL) ? CHANNEL_NUM : Cnt;
+    Frame.sampleheader.FrameFmt = UDP_FMT_TYPE_EEG;
+    memset(Frame.sampleheader.ReservedNum, 0xFF, 3);
+}
+
+/*!
+    \brief  FrameSampleFill
+
+    按UDP_EEGDataPut写入一个样本，未启用的通道及不含启用通道的通道组状态填0（解码端还原为0）
+
+    \param  pVal - CHANNEL_NUM个通道的量化值，NULL时按Sig生成
+ */
+static void FrameSampleFill(uint8_t i, uint32_t ChMask, uint8_t Sig, const int32_t *pVal)
+{
+    UDPData_t *pSample = &Frame.sampledata[i];
+    uint32_t Ts = SampleCnt * TEST_TS_STEP;
+    uint8_t Group, Ch;
+    int32_t Val;
+
+    pSample->FrameHeader = UDP_SAMPLE_FH;
+    pSample->Index[0] = i;
+    pSample->Index[1] = 0;
+    memcpy(pSample->Timestamp, &Ts, 4);
+    memset(pSample->ChannelVal, 0, UDP_SampleValSize);
+
+    for(Group=0; Group<UDP_CHGROUP_NUM; Group++)
+    {
+        if( !(uint8_t)(ChMask >> (Group*8)) )
+            continue;
+
+        ValWrite(&pSample->ChannelVal[Group*UDP_CHGROUP_SIZE],
+                 (Sig == SIG_RANDOM) ? (Rand32() & 0xFFFFFF) : TEST_STATUS);
+
+        for(Ch=0; Ch<8; Ch++)
+        {
+            if( !(ChMask & ((uint32_t)1 << (Group*8 + Ch))) )
+                continue;
+
+            if( pVal )
+                Val = pVal[Group*8 + Ch];
+            else switch(Sig)
+            {
+                case SIG_EEG:       Val = SimEEG(Group*8 + Ch); break;
+                case SIG_RANDOM:    Val = (int32_t)(Rand32() << 8) >> 8; break;
+                case SIG_EXTREME:   Val = (SampleCnt & 1) ? -0x800000 : 0x7FFFFF; break;
+                default:            Val = -1234; break;
+            }
+            ValWrite(&pSample->ChannelVal[Group*UDP_CHGROUP_SIZE + 3 + Ch*3], (uint32_t)Val);
+        }
+    }
+
+    SampleCnt++;
+}
+
+/*!
+    \brief  RoundTrip
+
+    压缩当前帧并解码比对
+
+    \return 压缩帧字节数，0表示放弃压缩（按原始帧发送）
+ */
+static uint16_t RoundTrip(uint8_t SampleNum, uint32_t ChMask, const char *pCase)
+{
+    uint16_t Len = EEG_CodecEncode(&Frame, SampleNum, ChMask, Coded, sizeof(Coded));
+
+    if( Len == 0 )
+        return 0;
+
+    if( Len >= UDP_FRAME_SIZE(SampleNum) )
+    {
+        printf("FAIL %s n=%u mask=%08X: compressed %u not shorter than raw\n",
+               pCase, SampleNum, (unsigned)ChMask, Len);
+        Failures++;
+        return Len;
+    }
+
+    memset(&Decoded, 0xA5, sizeof(Decoded));
+    if( !EEG_CodecDecode(Coded, Len, &Decoded) ||
+        memcmp(&Decoded, &Frame, UDP_FRAME_SIZE(SampleNum)) )
+    {
+        printf("FAIL %s n=%u mask=%08X: round trip mismatch\n", pCase, SampleNum, (unsigned)ChMask);
+        Failures++;
+        return Len;
+    }
+
+    /* 仅含帧头部的压缩帧须报错 */
+    if( (Len > UDP_HEADER_SIZE + 1) && EEG_CodecDecode(Coded, UDP_HEADER_SIZE, &Decoded) )
+    {
+        printf("FAIL %s n=%u mask=%08X: header-only frame accepted\n", pCase, SampleNum, (unsigned)ChMask);
+        Failures++;
+    }
+
+    return Len;
+}
+
+static uint32_t MaskOf(uint8_t Case)
+{
+    switch(Case)
+    {
+        case 0:  return UDP_CHMASK_ALL;
+        case 1:  return 0x00000001;
+        case 2:  return (uint32_t)1 << (CHANNEL_NUM - 1);
+        case 3:  return 0x55555555 & UDP_CHMASK_ALL;
+        case 4:  return 0x000000F0;
+        default: return (Rand32() & UDP_CHMASK_ALL) | 1;
+    }
+}
+
+/*!
+    \brief  TestRoundTrip
+
+    全部样本数 x 典型通道掩码 x 信号类型，另加随机组合
+ */
+static void TestRoundTrip(void)
+{
+    static const char * const SigName[SIG_NUM] = {"eeg", "random", "extreme", "const"};
+    unsigned Frames = 0, Compressed = 0;
+    uint8_t n, m, Sig, i;
+    uint32_t ChMask;
+    unsigned f;
+
+    for(n=1; n<=UDP_SAMPLENUM_MAX; n++)
+        for(m=0; m<6; m++)
+            for(Sig=0; Sig<SIG_NUM; Sig++)
+            {
+                ChMask = MaskOf(m);
+                FrameHeaderFill(n, ChMask);
+                for(i=0; i<n; i++)
+                    FrameSampleFill(i, ChMask, Sig, NULL);
+                Compressed += RoundTrip(n, ChMask, SigName[Sig]) != 0;
+                Frames++;
+            }
+
+    for(f=0; f<TEST_RANDOM_FRAMES; f++)
+    {
+        n = 1 + Rand32() % UDP_SAMPLENUM_MAX;
+        ChMask = MaskOf(5);
+        Sig = Rand32() % SIG_NUM;
+        FrameHeaderFill(n, ChMask);
+        for(i=0; i<n; i++)
+            FrameSampleFill(i, ChMask, Sig, NULL);
+        Compressed += RoundTrip(n, ChMask, SigName[Sig]) != 0;
+        Frames++;
+    }
+
+    printf("round trip: %u frames, %u compressed, %u raw\n", Frames, Compressed, Frames - Compressed);
+}
+
+/*!
+    \brief  TestBench
+
+    逐帧压缩录制数据或仿真脑电，输出压缩率与每帧编码耗时（主机时间，仅作相对比较，
+    设备端耗时以属性TASK_STAT中udp1Worker的CPU占用在压缩开启/关闭时的差值为准）
+
+    \param  pFile     - 录制数据，NULL时使用TEST_BENCH_SECONDS秒仿真脑电
+            SampleNum - 每包样本数
+ */
+static void TestBench(FILE *pFile, uint8_t SampleNum)
+{
+    int32_t Val[CHANNEL_NUM];
+    struct timespec t0, t1;
+    uint64_t RawBytes = 0, TxBytes = 0, Ns = 0;
+    uint32_t Frames = 0, RawFrames = 0, Samples = 0;
+    uint16_t Len;
+    uint8_t i;
+
+    SampleCnt = 0;
+    memset(Phase, 0, sizeof(Phase));
+    memset(Drift, 0, sizeof(Drift));
+
+    while(1)
+    {
+        FrameHeaderFill(SampleNum, UDP_CHMASK_ALL);
+        for(i=0; i<SampleNum; i++)
+        {
+            if( pFile )
+            {
+                if( fread(Val, sizeof(int32_t), CHANNEL_NUM, pFile) != CHANNEL_NUM )
+                    break;
+                FrameSampleFill(i, UDP_CHMASK_ALL, SIG_EEG, Val);
+            }
+            else
+            {
+                if( Samples + i >= TEST_BENCH_SECONDS * TEST_SAMPLE_RATE )
+                    break;
+                FrameSampleFill(i, UDP_CHMASK_ALL, SIG_EEG, NULL);
+            }
+        }
+        if( i < SampleNum )
+            break; //!< 不足一包的尾部丢弃
+        Samples += SampleNum;
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        Len = EEG_CodecEncode(&Frame, SampleNum, UDP_CHMASK_ALL, Coded, sizeof(Coded));
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        Ns += (uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000 + (t1.tv_nsec - t0.tv_nsec);
+
+        if( Len && (!EEG_CodecDecode(Coded, Len, &Decoded) ||
+                    memcmp(&Decoded, &Frame, UDP_FRAME_SIZE(SampleNum))) )
+        {
+            printf("FAIL bench frame %u: round trip mismatch\n", (unsigned)Frames);
+            Failures++;
+        }
+
+        RawBytes += UDP_FRAME_SIZE(SampleNum);
+        TxBytes += Len ? Len : UDP_FRAME_SIZE(SampleNum);
+        RawFrames += (Len == 0);
+        Frames++;
+    }
+
+    if( Frames == 0 )
+    {
+        printf("bench: no complete frame\n");
+        return;
+    }
+
+    printf("bench (%s, %u ch, %u samples/frame): %u frames, ratio %.3f (%.1f%% of raw), "
+           "%u sent raw, encode %.2f us/frame\n",
+           pFile ? "recorded" : "simulated", CHANNEL_NUM, SampleNum, (unsigned)Frames,
+           (double)TxBytes / RawBytes, 100.0 * TxBytes / RawBytes, (unsigned)RawFrames,
+           (double)Ns / Frames / 1000);
+}
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+int main(int argc, char *argv[])
+{
+    FILE *pFile = NULL;
+    uint8_t SampleNum = UDP_SAMPLENUM_DEFAULT;
+
+    if( argc > 1 )
+    {
+        pFile = fopen(argv[1], "rb");
+        if( pFile == NULL )
+        {
+            printf("cannot open %s\n", argv[1]);
+            return 2;
+        }
+    }
+    if( argc > 2 )
+        SampleNum = (uint8_t)atoi(argv[2]);
+    if( (SampleNum == 0) || (SampleNum > UDP_SAMPLENUM_MAX) )
+        SampleNum = UDP_SAMPLENUM_MAX;
+
+    TestRoundTrip();
+    TestBench(pFile, SampleNum);
+
+    if( pFile )
+        fclose(pFile);
+
+    printf("test_codec (%u ch): %s\n", CHANNEL_NUM, Failures ? "FAILED" : "passed");
+    return Failures ? 1 : 0;
+}
@@ -0,0 +1,242 @@
+/**
+ * @file    test_fec.c
+ * @author  gjmsilly
+ * @brief   主机端测试 - UDP1脑电数据通道XOR前向纠错：丢包注入与恢复
+ *
+ *          K = UDP_FEC_K_MIN ~ UDP_FEC_K_MAX，每组K个变长数据帧（原始帧、压缩帧长度不一）经
+ *          UDP_EEGFecPut 生成校验帧；每组依次丢弃每个位置的一帧，EEG_FecRecover 恢复结果
+ *          须与丢弃的帧逐字节一致。另验证丢失两帧时拒绝恢复、滚动码不连续时放弃未满的组。
+ * @version 1.0.0
+ * @date    2022-05-28
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <protocol/eegdata_fec.h>
+#include <host/eegdata_recover.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_GROUPS_PER_K       8           //!< 每个K的测试组数
+#define TEST_LEN_MIN            (UDP_HEADER_SIZE + 1)   //!< 最短帧（压缩帧可短至帧头部加数个字节）
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static uint8_t          Frames[UDP_FEC_K_MAX][UDP_DTx_Buff_Size];   //!< 本组数据帧
+static uint16_t         FrameLen[UDP_FEC_K_MAX];                    //!< 本组数据帧字节数
+static uint8_t          Parity[UDP_FEC_BUFF_SIZE];                  //!< 本组校验帧
+static uint16_t         ParityLen;
+static uint8_t          Recovered[UDP_DTx_Buff_Size];
+
+static uint32_t         Rng = 0x2468ACE1;                           //!< 伪随机数状态
+static uint32_t         UDPNum;                                     //!< 下一帧滚动码
+
+static unsigned         Failures;
+
+/*********************************************************************
+ *  LOCAL FUNCTIONS
+ */
+
+static uint32_t Rand32(void)
+{
+    Rng ^= Rng << 13;
+    Rng ^= Rng >> 17;
+    Rng ^= Rng << 5;
+    return Rng;
+}
+
+/*!
+    \brief  FrameMake
+
+    生成一个随机内容的数据帧：帧头部滚动码连续，长度在最短帧与帧槽大小之间随机，
+    每组至少有一帧取最长、一帧取最短，覆盖短帧补零
+ */
+static void FrameMake(uint8_t n, uint8_t K)
+{
+    UDPHeader_t *pHeader = (UDPHeader_t *)Frames[n];
+    uint16_t i;
+
+    if( n == 0 )
+        FrameLen[n] = UDP_DTx_Buff_Size;
+    else if( n == K - 1 )
+        FrameLen[n] = TEST_LEN_MIN;
+    else
+        FrameLen[n] = TEST_LEN_MIN + Rand32() % (UDP_DTx_Buff_Size - TEST_LEN_MIN + 1);
+
+    for(i=0; i<FrameLen[n]; i++)
+        Frames[n][i] = (uint8_t)Rand32();
+
+    pHeader->DevID = 0x4E454547;
+    memcpy(pHeader->UDPNum, &UDPNum, 4);
+    pHeader->FrameFmt = (Rand32() & 1) ? UDP_FMT_COMPRESSED : UDP_FMT_TYPE_EEG;
+    UDPNum++;
+}
+
+/*!
+    \brief  GroupSend
+
+    按发送线程的调用方式逐帧送入UDP_EEGFecPut，仅最后一帧返回校验帧
+
+    \return true - 校验帧生成正确
+ */
+static bool GroupSend(uint8_t K)
+{
+    const uint8_t *pParity;
+    uint16_t Len = 0;
+    uint8_t n;
+
+    for(n=0; n<K; n++)
+    {
+        FrameMake(n, K);
+        pParity = UDP_EEGFecPut(Frames[n], FrameLen[n], &Len);
+
+        if( (n < K - 1) && pParity )
+        {
+            printf("FAIL K=%u: parity after %u frames\n", K, n + 1);
+            return false;
+        }
+        if( (n == K - 1) && !pParity )
+        {
+            printf("FAIL K=%u: no parity after a full group\n", K);
+            return false;
+        }
+    }
+
+    memcpy(Parity, pParity, Len);
+    ParityLen = Len;
+
+    if( ((((UDPHeader_t *)Parity)->FrameFmt & UDP_FMT_TYPE_MASK) != UDP_FMT_TYPE_FEC) ||
+        (((UDPHeader_t *)Parity)->UDP_ChannelNum != K) ||
+        (ParityLen != UDP_HEADER_SIZE + UDP_DTx_Buff_Size) )
+    {
+        printf("FAIL K=%u: bad parity header\n", K);
+        return false;
+    }
+    return true;
+}
+
+/*!
+    \brief  GroupRecover
+
+    丢弃第Lost帧（Lost2不为0xFF时再丢弃第Lost2帧）后恢复
+
+    \return 恢复的帧字节数
+ */
+static uint16_t GroupRecover(uint8_t K, uint8_t Lost, uint8_t Lost2)
+{
+    const uint8_t *ppFrame[UDP_FEC_K_MAX];
+    uint8_t n;
+
+    for(n=0; n<K; n++)
+        ppFrame[n] = ((n == Lost) || (n == Lost2)) ? NULL : Frames[n];
+
+    memset(Recovered, 0xA5, sizeof(Recovered));
+    return EEG_FecRecover(Parity, ParityLen, ppFrame, FrameLen, Recovered);
+}
+
+/*!
+    \brief  TestRecover
+
+    每个K、每组、每个丢失位置恢复一次
+ */
+static void TestRecover(void)
+{
+    unsigned Groups = 0, Recoveries = 0;
+    uint8_t K, g, Lost;
+    uint16_t Len;
+
+    for(K=UDP_FEC_K_MIN; K<=UDP_FEC_K_MAX; K++)
+    {
+        UDP_EEGFecConfig(K);
+
+        for(g=0; g<TEST_GROUPS_PER_K; g++)
+        {
+            Groups++;
+            if( !GroupSend(K) )
+            {
+                Failures++;
+                continue;
+            }
+
+            for(Lost=0; Lost<K; Lost++)
+            {
+                Len = GroupRecover(K, Lost, 0xFF);
+                if( (Len != FrameLen[Lost]) || memcmp(Recovered, Frames[Lost], Len) )
+                {
+                    printf("FAIL K=%u group %u: frame %u (%u bytes) not recovered, got %u bytes\n",
+                           K, g, Lost, FrameLen[Lost], Len);
+                    Failures++;
+                }
+                Recoveries++;
+            }
+
+            if( GroupRecover(K, 0, K - 1) != 0 )
+            {
+                printf("FAIL K=%u group %u: recovered with two frames lost\n", K, g);
+                Failures++;
+            }
+        }
+    }
+
+    printf("recover: %u groups, %u single-loss recoveries\n", Groups, Recoveries);
+}
+
+/*!
+    \brief  TestGap
+
+    滚动码不连续（环形缓冲区溢出丢帧）时放弃未满的组，从不连续处开始新的一组
+ */
+static void TestGap(void)
+{
+    const uint8_t K = 4;
+    uint16_t Len;
+    uint8_t n;
+
+    UDP_EEGFecConfig(K);
+
+    for(n=0; n<2; n++)
+    {
+        FrameMake(n, K);
+        if( UDP_EEGFecPut(Frames[n], FrameLen[n], &Len) )
+        {
+            printf("FAIL gap: parity for a partial group\n");
+            Failures++;
+        }
+    }
+
+    UDPNum += 3; //!< 丢帧
+
+    if( !GroupSend(K) )
+    {
+        Failures++;
+        return;
+    }
+    if( (GroupRecover(K, 1, 0xFF) != FrameLen[1]) || memcmp(Recovered, Frames[1], FrameLen[1]) )
+    {
+        printf("FAIL gap: group after a gap not recovered\n");
+        Failures++;
+    }
+}
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+int main(void)
+{
+    TestRecover();
+    TestGap();
+
+    printf("test_fec (%u ch): %s\n", CHANNEL_NUM, Failures ? "FAILED" : "passed");
+    return Failures ? 1 : 0;
+}
@@ -0,0 +1,258 @@
+/**
+ * @file    test_filter.c
+ * @author  gjmsilly
+ * @brief   主机端测试 - 设备端脑电滤波：Q30定点级联双二阶与双精度参考比较、吞吐量
+ *
+ *          直接编译 service/eeg_filter.c，取同一系数表：
+ *          1. 误差：各采样率（250/500/1000/2000SPS）x 各滤波方案，仿真脑电经 EEGFilter_SamplePut
+ *             滤波，与双精度参考实现（相同Q30系数、相同级联顺序，不截断不饱和）逐样本比较，
+ *             各通道误差均方根须小于TEST_TOL_RMS LSB，最大绝对误差须小于TEST_TOL_MAX LSB；
+ *          2. 吞吐量：最重负载（2kSPS，陷波+高通+低通三节）下每通道样本的主机耗时，仅作相对比较。
+ * @version 1.0.0
+ * @date    2022-05-28
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+#include "service/eeg_filter.c"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_SECONDS            5           //!< 每个方案的仿真时长 s
+#define TEST_RATE_MAX           2000
+#define TEST_LEN                (TEST_SECONDS * TEST_RATE_MAX)
+#define TEST_LSB_UV             (4.5e6 / 24 / 8388608)      //!< 增益24时1LSB对应的uV
+#define TEST_TOL_RMS            4.0         //!< 误差均方根上限 LSB
+#define TEST_TOL_MAX            16.0        //!< 最大绝对误差上限 LSB
+#define TEST_BENCH_SAMPLES      TEST_LEN    //!< 吞吐量测试样本数
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static int32_t          Input[CHANNEL_NUM][TEST_LEN];   //!< 各通道输入量化值
+static double           RefOut[TEST_LEN];               //!< 参考实现输出
+static uint8_t          Sample[TEST_LEN][UDP_SampleValSize]; //!< 设备端滤波的样本序列
+
+static uint32_t         Rng = 0x12345678;               //!< 伪随机数状态
+
+static unsigned         Failures;
+static double           WorstRms;                       //!< 各方案误差均方根最大值
+static double           WorstMax;                       //!< 各方案最大绝对误差
+
+/*********************************************************************
+ *  LOCAL FUNCTIONS
+ */
+
+static uint32_t Rand32(void)
+{
+    Rng ^= Rng << 13;
+    Rng ^= Rng >> 17;
+    Rng ^= Rng << 5;
+    return Rng;
+}
+
+static double RandGauss(void)
+{
+    double u1 = (Rand32() + 1.0) / 4294967297.0;
+    double u2 = (Rand32() + 1.0) / 4294967297.0;
+
+    return sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+}
+
+/*!
+    \brief  SimEEG
+
+    仿真各通道Len个样本：10Hz alpha节律（约20uV）+ 50/60Hz工频（各5uV）+ 300uV电极直流偏置
+    + 基线漂移 + 1uV白噪声，写入Input并打包为ADS1299输出格式
+ */
+static void SimEEG(uint16_t Samplerate, uint32_t Len)
+{
+    double t, Drift, uV;
+    uint32_t n;
+    uint8_t Ch;
+    uint8_t *pVal;
+
+    for(Ch=0; Ch<CHANNEL_NUM; Ch++)
+    {
+        Drift = 0;
+        for(n=0; n<Len; n++)
+        {
+            t = (double)n / Samplerate;
+            Drift += 0.05 * RandGauss();
+            uV = 20 * sin(2 * M_PI * (10.0 + 0.1 * Ch) * t) + 5 * sin(2 * M_PI * 50 * t + Ch)
+               + 5 * sin(2 * M_PI * 60 * t) + 300 + Drift + RandGauss();
+            Input[Ch][n] = (int32_t)lround(uV / TEST_LSB_UV);
+
+            pVal = &Sample[n][(Ch >> 3) * UDP_CHGROUP_SIZE + 3 + (Ch & 0x07) * 3];
+            pVal[0] = (uint8_t)(Input[Ch][n] >> 16);
+            pVal[1] = (uint8_t)(Input[Ch][n] >> 8);
+            pVal[2] = (uint8_t)Input[Ch][n];
+        }
+    }
+}
+
+/*!
+    \brief  RefFilter
+
+    双精度参考实现：与设备端相同的Q30系数、相同的级联顺序，浮点直接I型，不截断不饱和
+
+    \param  pIn  - 输入量化值序列（int24符号扩展）
+            pOut - 输出序列（to be returned）
+            Len  - 样本数
+            其余同EEGFilter_Config
+
+    \return true - 完成
+            false - 采样率不支持或方案非法
+ */
+static bool RefFilter(const int32_t *pIn, double *pOut, uint32_t Len, uint16_t Samplerate,
+                      uint8_t Notch, uint8_t Highpass, uint8_t Lowpass)
+{
+    EEGBiquadCoef_t Coef[EEG_FILTER_SECTION_MAX];
+    double b0[EEG_FILTER_SECTION_MAX], b1[EEG_FILTER_SECTION_MAX], b2[EEG_FILTER_SECTION_MAX];
+    double a1[EEG_FILTER_SECTION_MAX], a2[EEG_FILTER_SECTION_MAX];
+    double x1[EEG_FILTER_SECTION_MAX] = {0}, x2[EEG_FILTER_SECTION_MAX] = {0};
+    double y1[EEG_FILTER_SECTION_MAX] = {0}, y2[EEG_FILTER_SECTION_MAX] = {0};
+    const double Scale = 1.0 / (double)(1L << EEG_FILTER_COEF_FRAC);
+    double x, y;
+    uint32_t i;
+    int8_t Num, Sec;
+
+    Num = EEGFilter_Design(Coef, Samplerate, Notch, Highpass, Lowpass);
+    if( Num < 0 )
+        return false;
+
+    for(Sec=0; Sec<Num; Sec++)
+    {
+        b0[Sec] = Coef[Sec].b0 * Scale;
+        b1[Sec] = Coef[Sec].b1 * Scale;
+        b2[Sec] = Coef[Sec].b2 * Scale;
+        a1[Sec] = Coef[Sec].a1 * Scale;
+        a2[Sec] = Coef[Sec].a2 * Scale;
+    }
+
+    for(i=0; i<Len; i++)
+    {
+        x = pIn[i];
+        for(Sec=0; Sec<Num; Sec++)
+        {
+            y = b0[Sec] * x + b1[Sec] * x1[Sec] + b2[Sec] * x2[Sec] - a1[Sec] * y1[Sec] - a2[Sec] * y2[Sec];
+            x2[Sec] = x1[Sec];
+            x1[Sec] = x;
+            y2[Sec] = y1[Sec];
+            y1[Sec] = y;
+            x = y;
+        }
+        pOut[i] = x;
+    }
+
+    return true;
+}
+
+/*!
+    \brief  TestScheme
+
+    一个采样率一个滤波方案：设备端逐样本滤波，各通道与参考实现比较
+ */
+static void TestScheme(uint16_t Samplerate, uint8_t Notch, uint8_t Highpass, uint8_t Lowpass)
+{
+    uint32_t Len = TEST_SECONDS * Samplerate;
+    double Err, Sum, Max;
+    const uint8_t *pVal;
+    int32_t y;
+    uint32_t n;
+    uint8_t Ch;
+
+    SimEEG(Samplerate, Len);
+
+    if( !EEGFilter_Config(Samplerate, Notch, Highpass, Lowpass) )
+    {
+        printf("FAIL %u SPS %u/%u/%u: config rejected\n", Samplerate, Notch, Highpass, Lowpass);
+        Failures++;
+        return;
+    }
+    for(n=0; n<Len; n++)
+        EEGFilter_SamplePut(Sample[n]);
+
+    for(Ch=0; Ch<CHANNEL_NUM; Ch++)
+    {
+        RefFilter(Input[Ch], RefOut, Len, Samplerate, Notch, Highpass, Lowpass);
+
+        Sum = 0;
+        Max = 0;
+        for(n=0; n<Len; n++)
+        {
+            pVal = &Sample[n][(Ch >> 3) * UDP_CHGROUP_SIZE + 3 + (Ch & 0x07) * 3];
+            y = (int32_t)(((uint32_t)pVal[0] << 24) | ((uint32_t)pVal[1] << 16) | ((uint32_t)pVal[2] << 8)) >> 8;
+            Err = fabs(y - RefOut[n]);
+            Sum += Err * Err;
+            if( Err > Max )
+                Max = Err;
+        }
+        Sum = sqrt(Sum / Len);
+
+        if( Sum > WorstRms )
+            WorstRms = Sum;
+        if( Max > WorstMax )
+            WorstMax = Max;
+        if( (Sum > TEST_TOL_RMS) || (Max > TEST_TOL_MAX) )
+        {
+            printf("FAIL %u SPS %u/%u/%u ch%u: error rms %.2f max %.2f LSB\n",
+                   Samplerate, Notch, Highpass, Lowpass, Ch, Sum, Max);
+            Failures++;
+        }
+    }
+}
+
+/*!
+    \brief  Benchmark
+
+    最重负载下对全部通道连续滤波，输出每通道样本主机耗时
+ */
+static void Benchmark(void)
+{
+    struct timespec t0, t1;
+    double ns;
+    uint32_t n;
+
+    SimEEG(2000, TEST_BENCH_SAMPLES);
+    EEGFilter_Config(2000, EEG_FILTER_NOTCH_50HZ, EEG_FILTER_HP_0HZ5, EEG_FILTER_LP_100HZ);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(n=0; n<TEST_BENCH_SAMPLES; n++)
+        EEGFilter_SamplePut(Sample[n]);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    ns = (t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec);
+    printf("filter: 3 sections, %.1f ns per channel-sample (host)\n",
+           ns / TEST_BENCH_SAMPLES / CHANNEL_NUM);
+}
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+int main(void)
+{
+    static const uint16_t Rate[] = { 250, 500, 1000, 2000 };
+    uint8_t r, Notch, Hp, Lp;
+
+    for(r=0; r<sizeof(Rate)/sizeof(Rate[0]); r++)
+        for(Notch=EEG_FILTER_NOTCH_OFF; Notch<=EEG_FILTER_NOTCH_60HZ; Notch++)
+            for(Hp=EEG_FILTER_HP_OFF; Hp<=EEG_FILTER_HP_1HZ; Hp++)
+                for(Lp=EEG_FILTER_LP_OFF; Lp<=EEG_FILTER_LP_100HZ; Lp++)
+                    TestScheme(Rate[r], Notch, Hp, Lp);
+
+    printf("filter: worst error rms %.2f LSB, max %.2f LSB\n", WorstRms, WorstMax);
+    Benchmark();
+
+    printf("test_filter (%u ch): %s\n", CHANNEL_NUM, Failures ? "FAILED" : "passed");
+    return Failures ? 1 : 0;
+}
@@ -0,0 +1,215 @@
+/**
+ * @file    test_sample_loss.c
+ * @author  gjmsilly
+ * @brief   主机端测试 - 采样线程样本丢失标记
+ *
+ *          直接编译 task/sample_task.c，以伪驱动模拟nDRDY中断与SPI DMA完成回调：
+ *          无丢失时各包不置位UDP_FMT_SAMPLE_LOSS；注入一次nDRDY溢出（上一样本传输中再来nDRDY）
+ *          而时间戳保持连续时，覆盖该时段的包须置位丢失标志且属性样本丢失统计计入该次溢出；
+ *          时间戳出现间隔（无溢出计数）时同样置位。
+ * @version 1.0.0
+ * @date    2022-05-28
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+
+#include "task/sample_task.c"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_SAMPLENUM          10          //!< 每包样本数
+#define TEST_SAMPLERATE         250         //!< 采样率
+#define TEST_PACKETS            4           //!< 每个场景的包数
+#define TEST_PERIOD             (SAMPLE_TIMER_FREQ / TEST_SAMPLERATE)
+
+/*********************************************************************
+ *  GLOBAL VARIABLES - 被测模块引用的外部变量
+ */
+SampleTime_t    *pSampleTime;
+UDPDtRing_t     UDP_DTX_Ring;
+volatile bool   cc1310_I2CBusy;
+Display_Handle  display;
+sem_t           UDPEEGDataReady;
+sem_t           SampleReady;
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static uint64_t         FakeNow;                    //!< 伪系统时间
+static bool             FakeSpiBusy;                //!< 伪SPI传输中
+static SPI_CallbackFxn  FakeAcqCB;                  //!< 采样线程注册的SPI回调
+static SampleLoss_t     FakeLossAttr;               //!< 最近写入的属性样本丢失统计
+
+static bool             PacketLoss[TEST_PACKETS];   //!< 各包丢失标志
+static uint8_t          PacketCnt;
+
+static unsigned         Failures;
+
+/*********************************************************************
+ *  FAKES - 被测模块调用的驱动及服务
+ */
+bool ADS1299_ReadResultAsync(uint8_t *result)
+{
+    if( FakeSpiBusy )
+        return false;
+
+    FakeSpiBusy = true;
+    memset(result, 0, UDP_SampleValSize);
+    FakeNow += TEST_PERIOD; //!< 时间戳只随成功启动的传输前进：注入的溢出不留下时间间隔
+    return true;
+}
+
+void ADS1299_RegisterAcqCB(SPI_CallbackFxn pfnAcqCB) { FakeAcqCB = pfnAcqCB; }
+void GPIO_setCallback(uint_least8_t index, GPIO_CallbackFxn callback) { }
+void Display_printf(Display_Handle handle, int line, int column, const char *fmt, ...) { }
+uint64_t SampleTimestamp_Get(SampleTime_t* SampleTime) { return FakeNow; }
+
+uint8_t App_WriteMsgAttr(uint8_t InsAttrNum, const void *pValue)
+{
+    if( InsAttrNum == SAMPLE_LOSS )
+        memcpy(&FakeLossAttr, pValue, sizeof(FakeLossAttr));
+    return true;
+}
+
+void Attr_Notify(uint8_t InsAttrNum) { }
+void Trace_Put(uint8_t Id, uint8_t Arg8, uint16_t Arg16) { }
+void Telem_TaskRegister(uint8_t Task) { }
+void Telem_TaskBusy(uint8_t Task) { }
+void Telem_TaskIdle(uint8_t Task) { }
+void Telem_LatencyPut(uint8_t Hist, uint64_t StartTime) { }
+
+bool EEGDecim_Config(uint8_t Ratio) { return Ratio == 1; }
+uint32_t EEGDecim_GroupDelay(void) { return 0; }
+void EEGDecim_BlockProcess(uint8_t (*pChannelVal)[UDP_SampleValSize], uint16_t RawNum) { }
+void EEGFilter_SamplePut(uint8_t *pChannelVal) { }
+uint8_t EEGBand_Mode(void) { return EEG_BAND_MODE_OFF; }
+bool EEGBand_SamplePut(const uint8_t *pChannelVal) { return false; }
+const float* EEGBand_Result(void) { return NULL; }
+bool UDP_EEGFeaturePut(uint64_t Time, const float *pBandPower) { return false; }
+bool Imp_IsRunning(void) { return false; }
+void Imp_SamplePut(const uint8_t *pChannelVal) { }
+void UDP_EEGDataPut(uint8_t SampleIndex, uint64_t Time, const uint8_t *pChannelVal) { }
+
+bool UDP_EEGDataProcess(uint8_t SampleNum, bool reSampleFlag, bool LossFlag)
+{
+    if( PacketCnt < TEST_PACKETS )
+        PacketLoss[PacketCnt] = LossFlag;
+    PacketCnt++;
+    return false;
+}
+
+/*********************************************************************
+ *  LOCAL FUNCTIONS
+ */
+
+/*!
+    \brief  FakeSpiComplete
+
+    SPI DMA传输完成，调用采样线程注册的回调
+ */
+static void FakeSpiComplete(void)
+{
+    SPI_Transaction Transaction;
+
+    memset(&Transaction, 0, sizeof(Transaction));
+    Transaction.status = SPI_TRANSFER_COMPLETED;
+    FakeSpiBusy = false;
+    FakeAcqCB(NULL, &Transaction);
+}
+
+/*!
+    \brief  FakeDrain
+
+    按采样线程主循环的方式处理已填满的采集块
+ */
+static void FakeDrain(void)
+{
+    while( sem_trywait(&SampleReady) == 0 )
+    {
+        SampleBlockProcess(&AcqBlock[AcqProcIdx]);
+        AcqProcIdx = (AcqProcIdx + 1) & (ACQ_BLOCKNUM - 1);
+    }
+}
+
+/*!
+    \brief  RunScenario
+
+    开始采样后采集TEST_PACKETS包，第OverrunPkt包中间注入一次nDRDY溢出，
+    第GapPkt包中间跳过一个采样周期（不为0xFF时）
+
+    \return 丢失标志与期望不符的包数
+ */
+static unsigned RunScenario(const char *Name, uint8_t OverrunPkt, uint8_t GapPkt)
+{
+    unsigned Fail = 0;
+    uint8_t Pkt, n;
+    bool Expect;
+
+    SampleAcq_Reset(TEST_SAMPLENUM, TEST_SAMPLERATE, 1, false);
+    memset(PacketLoss, 0, sizeof(PacketLoss));
+    PacketCnt = 0;
+
+    for(Pkt=0; Pkt<TEST_PACKETS; Pkt++)
+    {
+        for(n=0; n<TEST_SAMPLENUM; n++)
+        {
+            if( (Pkt == GapPkt) && (n == TEST_SAMPLENUM / 2) )
+                FakeNow += TEST_PERIOD; //!< 丢失一个nDRDY
+
+            ADS1299nDRDYHandle(Mod_nDRDY);
+            if( (Pkt == OverrunPkt) && (n == TEST_SAMPLENUM / 2) )
+                ADS1299nDRDYHandle(Mod_nDRDY); //!< 上一样本仍在传输
+            FakeSpiComplete();
+        }
+        FakeDrain();
+    }
+
+    if( PacketCnt != TEST_PACKETS )
+    {
+        printf("FAIL %s: %u packets published, expected %u\n", Name, PacketCnt, TEST_PACKETS);
+        return 1;
+    }
+
+    for(Pkt=0; Pkt<TEST_PACKETS; Pkt++)
+    {
+        Expect = (Pkt == OverrunPkt) || (Pkt == GapPkt);
+        if( PacketLoss[Pkt] != Expect )
+        {
+            printf("FAIL %s: packet %u loss flag %u, expected %u\n", Name, Pkt, PacketLoss[Pkt], Expect);
+            Fail++;
+        }
+    }
+
+    if( FakeLossAttr.DrdyOverrunCnt != ((OverrunPkt < TEST_PACKETS) ? 1 : 0) )
+    {
+        printf("FAIL %s: DrdyOverrunCnt %u\n", Name, (unsigned)FakeLossAttr.DrdyOverrunCnt);
+        Fail++;
+    }
+
+    return Fail;
+}
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+int main(void)
+{
+    sem_init(&SampleReady, 0, 0);
+    sem_init(&UDPEEGDataReady, 0, 0);
+
+    ADS1299_RegisterAcqCB(ADS1299ReadCplHandle); //!< 同采样线程入口
+
+    Failures += RunScenario("clean", 0xFF, 0xFF);
+    Failures += RunScenario("drdy overrun", 1, 0xFF);
+    Failures += RunScenario("timestamp gap", 0xFF, 2);
+
+    printf("test_sample_loss (%u ch): %s\n", CHANNEL_NUM, Failures ? "FAILED" : "passed");
+    return Failures ? 1 : 0;
+}
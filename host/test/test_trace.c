@@ -0,0 +1,229 @@
+/**
+ * @file    test_trace.c
+ * @author  gjmsilly
+ * @brief   主机端测试 - 二进制跟踪记录：写入、分段下载与参考解码往返
+ *
+ *          以伪周期计数器驱动 service/trace.c：
+ *          1. 往返：Trace_Put 写入一段记录（周期计数值中途回绕），按 Trace_Download 指令的回复长度
+ *             逐段 Trace_Read，各记录须与写入一致；Trace_Decode 输出的时间线须逐条连续、
+ *             时间展开正确，返回的下次起始序号须为写序号；
+ *          2. 覆盖：写入超过缓冲区容量的记录后下载，须从最早的记录开始并标出被覆盖的记录数；
+ *          3. 使能：未使能的跟踪点不写入。
+ * @version 1.0.0
+ * @date    2022-05-28
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include <service/trace.h>
+#include <host/trace_decode.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_READ_SIZE          (0xFF - 2)  //!< 每次下载回复的记录区字节数，同Trace_Download指令
+#define TEST_STEP               80000       //!< 相邻记录间隔（周期数）= 1ms
+#define TEST_STEP_US            (TEST_STEP * 1e6 / TRACE_CLOCK_HZ)
+#define TEST_RECORDS            50          //!< 往返测试记录数
+#define TEST_OVERWRITE          30          //!< 覆盖测试中被覆盖的记录数
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static uint32_t         FakeCycles;                 //!< 伪DWT周期计数器
+static uint32_t         PutSeq;                     //!< 已写入记录数
+static TraceTimeline_t  Timeline;
+
+static unsigned         Failures;
+
+/*********************************************************************
+ *  FAKES - 被测模块调用的驱动及服务
+ */
+uintptr_t HwiP_disable(void) { return 0; }
+void HwiP_restore(uintptr_t key) { }
+uint32_t Telem_Cycles(void) { return FakeCycles; }
+
+/*********************************************************************
+ *  LOCAL FUNCTIONS
+ */
+
+/*!
+    \brief  PutRecords
+
+    写入Num条记录，参数由序号生成，每条间隔TEST_STEP周期
+ */
+static void PutRecords(uint32_t Num)
+{
+    uint32_t i;
+
+    for(i=0; i<Num; i++, PutSeq++)
+    {
+        Trace_Put((uint8_t)(PutSeq % TRACE_ID_NUM), (uint8_t)PutSeq, (uint16_t)(PutSeq * 7));
+        FakeCycles += TEST_STEP;
+    }
+}
+
+/*!
+    \brief  Download
+
+    按上位机方式从Start开始逐段下载并解码，直至回复不含记录，核对每条记录
+
+    \param  pOut   - 时间线输出
+            pCount - 取得的记录数（to be returned）
+
+    \return 下次下载的起始序号
+ */
+static uint32_t Download(uint32_t Start, FILE *pOut, uint32_t *pCount, const char *pCase)
+{
+    uint8_t Buf[TEST_READ_SIZE];
+    TraceRecord_t Rec;
+    uint32_t WrSeq;
+    uint16_t Len, Pos;
+
+    *pCount = 0;
+    do
+    {
+        Len = Trace_Read(Start, Buf, sizeof(Buf));
+        memcpy(&WrSeq, Buf, 4);
+        if( WrSeq != PutSeq )
+        {
+            printf("FAIL %s: write seq %u, expected %u\n", pCase, (unsigned)WrSeq, (unsigned)PutSeq);
+            Failures++;
+        }
+
+        for(Pos=TRACE_READ_HDR; Pos + TRACE_RECORD_SIZE <= Len; Pos += TRACE_RECORD_SIZE)
+        {
+            memcpy(&Rec, Buf + Pos, TRACE_RECORD_SIZE);
+            if( (Rec.Id != Rec.Seq % TRACE_ID_NUM) || (Rec.Arg8 != (uint8_t)Rec.Seq) ||
+                (Rec.Arg16 != (uint16_t)(Rec.Seq * 7)) )
+            {
+                printf("FAIL %s: record %u fields mismatch\n", pCase, (unsigned)Rec.Seq);
+                Failures++;
+            }
+            (*pCount)++;
+        }
+
+        Start = Trace_Decode(&Timeline, Buf, Len, pOut);
+    } while( Len > TRACE_READ_HDR );
+
+    return Start;
+}
+
+/*!
+    \brief  CheckTimeline
+
+    逐行核对解码输出：自FirstSeq起序号连续（被覆盖处须先有一行标出Gap条），
+    时间线零点为序号0的记录，每条间隔TEST_STEP
+
+    \return 记录行数
+ */
+static uint32_t CheckTimeline(FILE *pOut, uint32_t FirstSeq, uint32_t Gap, const char *pCase)
+{
+    char Line[128], Name[16];
+    uint32_t Seq, Prev = FirstSeq ? FirstSeq - 1 : 0, Expect = FirstSeq, Lines = 0, Skipped;
+    double Time, Delta;
+
+    rewind(pOut);
+    while( fgets(Line, sizeof(Line), pOut) )
+    {
+        if( sscanf(Line, "---------- %u records overwritten", &Skipped) == 1 )
+        {
+            if( Skipped != Gap )
+            {
+                printf("FAIL %s: %u records overwritten, expected %u\n", pCase, (unsigned)Skipped, (unsigned)Gap);
+                Failures++;
+            }
+            Expect += Skipped;
+            Gap = 0;
+            continue;
+        }
+
+        if( (sscanf(Line, "%u %lf %lf %15s", &Seq, &Time, &Delta, Name) != 4) || (Seq != Expect) ||
+            (fabs(Time - Seq * TEST_STEP_US) > 1e-3) ||
+            (fabs(Delta - (Seq - Prev) * TEST_STEP_US) > 1e-3) )
+        {
+            printf("FAIL %s: timeline line \"%.60s\", expected seq %u\n", pCase, Line, (unsigned)Expect);
+            Failures++;
+            return Lines;
+        }
+        Prev = Seq;
+        Expect++;
+        Lines++;
+    }
+
+    if( Gap != 0 )
+    {
+        printf("FAIL %s: overwritten records not reported\n", pCase);
+        Failures++;
+    }
+
+    return Lines;
+}
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+int main(void)
+{
+    uint8_t Buf[TRACE_READ_HDR + TRACE_RECORD_SIZE * 2];
+    TraceRecord_t Rec;
+    uint32_t Start, Count, First;
+    uint16_t Len;
+    FILE *pOut;
+
+    /* 往返：周期计数值在第6条记录处回绕 */
+    Trace_MaskSet(TRACE_MASK_ALL);
+    FakeCycles = 0xFFFFFFFF - TEST_STEP * 5;
+    Trace_DecodeInit(&Timeline);
+
+    pOut = tmpfile();
+    PutRecords(TEST_RECORDS);
+    Start = Download(0, pOut, &Count, "roundtrip");
+    if( (Count != TEST_RECORDS) || (Start != PutSeq) )
+    {
+        printf("FAIL roundtrip: %u records, next start %u\n", (unsigned)Count, (unsigned)Start);
+        Failures++;
+    }
+    if( CheckTimeline(pOut, 0, 0, "roundtrip") != TEST_RECORDS )
+        Failures++;
+    fclose(pOut);
+
+    /* 覆盖：续接时间线，写入超过缓冲区容量的记录 */
+    pOut = tmpfile();
+    First = Start;
+    PutRecords(TRACE_RECORD_NUM + TEST_OVERWRITE);
+    Start = Download(Start, pOut, &Count, "overwrite");
+    if( (Count != TRACE_RECORD_NUM) || (Start != PutSeq) )
+    {
+        printf("FAIL overwrite: %u records, next start %u\n", (unsigned)Count, (unsigned)Start);
+        Failures++;
+    }
+    if( CheckTimeline(pOut, First, TEST_OVERWRITE, "overwrite") != TRACE_RECORD_NUM )
+        Failures++;
+    fclose(pOut);
+
+    /* 使能：只使能TRACE_TICK */
+    Trace_MaskSet((uint32_t)1 << TRACE_TICK);
+    Trace_Put(TRACE_DRDY, 0, 0);
+    Trace_Put(TRACE_TICK, 0, 0);
+    Len = Trace_Read(Start, Buf, sizeof(Buf));
+    memcpy(&Rec, Buf + TRACE_READ_HDR, TRACE_RECORD_SIZE);
+    if( (Len != TRACE_READ_HDR + TRACE_RECORD_SIZE) || (Rec.Id != TRACE_TICK) )
+    {
+        printf("FAIL mask: %u bytes read\n", Len);
+        Failures++;
+    }
+
+    printf("test_trace: %s\n", Failures ? "FAILED" : "passed");
+    return Failures ? 1 : 0;
+}
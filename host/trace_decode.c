@@ -0,0 +1,165 @@
+/**
+ * @file    trace_decode.c
+ * @author  gjmsilly
+ * @brief   NanoEEG 上位机参考实现 - 二进制跟踪记录解码
+ *
+ *          逐段解码 Trace_Download 指令的回复（Trace_Read 输出），展开32位周期计数值并输出时间线，
+ *          下载格式见 @ref protocol/README.md ，跟踪点定义与固件共用 service/trace.h 。
+ * @version 1.0.0
+ * @date    2022-05-27
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "trace_decode.h"
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static const char * const TraceName[TRACE_ID_NUM] =
+{
+    "TICK", "DRDY", "SPI_CPL", "PACKET_READY", "SENDTO_START",
+    "SENDTO_END", "EVT_WAKEUP", "I2C_EVT", "SYNC_PULSE", "ATTR_CHANGE"
+};
+
+static const char * const TraceChName[] =
+{
+    "eeg", "feature", "fec", "resend", "evt"
+};
+
+/*********************************************************************
+ *  LOCAL FUNCTIONS
+ */
+
+/*!
+    \brief  TraceArgPrint
+
+    按跟踪点编号输出参数
+ */
+static void TraceArgPrint(const TraceRecord_t *pRec, FILE *pOut)
+{
+    const char *Ch = (pRec->Arg8 <= TRACE_CH_EVT) ? TraceChName[pRec->Arg8] : "?";
+
+    switch(pRec->Id)
+    {
+        case TRACE_DRDY:
+            fprintf(pOut, "sample=%u", pRec->Arg16);
+            break;
+
+        case TRACE_SPI_CPL:
+            fprintf(pOut, "sample=%u %s", pRec->Arg16, pRec->Arg8 ? "ok" : "FAIL");
+            break;
+
+        case TRACE_PACKET_READY:
+            fprintf(pOut, "udpnum=%u %s", pRec->Arg16, pRec->Arg8 ? "queued" : "DROPPED");
+            break;
+
+        case TRACE_SENDTO_START:
+            fprintf(pOut, "ch=%s %s=%u", Ch, (pRec->Arg8 == TRACE_CH_EVT) ? "len" : "udpnum", pRec->Arg16);
+            break;
+
+        case TRACE_SENDTO_END:
+            if( pRec->Arg16 == 0xFFFF )
+                fprintf(pOut, "ch=%s FAIL", Ch);
+            else
+                fprintf(pOut, "ch=%s ret=%u", Ch, pRec->Arg16);
+            break;
+
+        case TRACE_I2C_EVT:
+            if( pRec->Arg8 )
+                fprintf(pOut, "type=0x%02X", pRec->Arg16);
+            else
+                fprintf(pOut, "FAIL");
+            break;
+
+        case TRACE_SYNC_PULSE:
+            fprintf(pOut, "sync=%u", pRec->Arg16);
+            break;
+
+        case TRACE_ATTR_CHANGE:
+            fprintf(pOut, "attr=%u", pRec->Arg8);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+
+/*!
+    \brief  Trace_DecodeInit
+
+    \param  pTl - 时间线状态，开始一次下载前初始化
+ */
+void Trace_DecodeInit(TraceTimeline_t *pTl)
+{
+    memset(pTl, 0, sizeof(TraceTimeline_t));
+}
+
+/*!
+    \brief  Trace_Decode
+
+    解码一次下载回复（回复帧有效数据部分），每条记录输出一行：
+    序号、距第一条记录的时间us、距上一条记录的时间us、跟踪点名称及参数。
+    32位周期计数值按相邻记录间隔不超过约53.7s展开（TRACE_TICK每秒一条），
+    序号不连续处输出被覆盖的记录数，此时跨越的时间可能少计整数个回绕周期。
+
+    \param  pTl  - 时间线状态
+            pData - Trace_Read输出：当前写序号4 + n条记录
+            Len   - pData字节数
+            pOut  - 时间线输出
+
+    \return 下一次下载的起始序号
+ */
+uint32_t Trace_Decode(TraceTimeline_t *pTl, const uint8_t *pData, uint16_t Len, FILE *pOut)
+{
+    TraceRecord_t Rec;
+    uint64_t Delta;
+    uint16_t Pos;
+
+    if( Len < TRACE_READ_HDR )
+        return pTl->Valid ? pTl->LastSeq + 1 : 0;
+
+    for(Pos=TRACE_READ_HDR; Pos + TRACE_RECORD_SIZE <= Len; Pos += TRACE_RECORD_SIZE)
+    {
+        memcpy(&Rec, pData + Pos, TRACE_RECORD_SIZE);
+
+        if( !pTl->Valid )
+        {
+            pTl->Valid = true;
+            pTl->Time = Rec.Time;
+            pTl->Origin = Rec.Time;
+            Delta = 0;
+        }
+        else
+        {
+            if( Rec.Seq != pTl->LastSeq + 1 )
+                fprintf(pOut, "---------- %u records overwritten ----------\n", Rec.Seq - pTl->LastSeq - 1);
+
+            Delta = (uint32_t)(Rec.Time - pTl->LastTime);
+            pTl->Time += Delta;
+        }
+        pTl->LastSeq = Rec.Seq;
+        pTl->LastTime = Rec.Time;
+
+        fprintf(pOut, "%10u %14.3f %+12.3f  %-13s ", Rec.Seq,
+                (double)(pTl->Time - pTl->Origin) * 1e6 / TRACE_CLOCK_HZ, (double)Delta * 1e6 / TRACE_CLOCK_HZ,
+                (Rec.Id < TRACE_ID_NUM) ? TraceName[Rec.Id] : "?");
+        TraceArgPrint(&Rec, pOut);
+        fprintf(pOut, "\n");
+    }
+
+    return pTl->Valid ? pTl->LastSeq + 1 : 0;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file    trace_decode.h
+ * @author  gjmsilly
+ * @brief   NanoEEG 上位机参考实现 - 二进制跟踪记录解码
+ * @version 1.0.0
+ * @date    2022-05-27
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef __HOST_TRACE_DECODE_H
+#define __HOST_TRACE_DECODE_H
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <service/trace.h>
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/*!
+ *  @brief      时间线状态，跨多次下载回复保持
+ */
+typedef struct
+{
+    bool     Valid;             //!< 已解码过记录
+    uint32_t LastSeq;           //!< 上一条记录序号
+    uint32_t LastTime;          //!< 上一条记录周期计数值
+    uint64_t Time;              //!< 展开后的64位周期计数值
+    uint64_t Origin;            //!< 第一条记录的展开周期计数值，时间线以此为零点
+
+}TraceTimeline_t;
+
+/**********************************************************************
+ * FUNCTIONS
+ */
+void Trace_DecodeInit(TraceTimeline_t *pTl);
+uint32_t Trace_Decode(TraceTimeline_t *pTl, const uint8_t *pData, uint16_t Len, FILE *pOut);
+
+#endif  /* __HOST_TRACE_DECODE_H */
@@ -53,9 +53,13 @@
 // User Services & tasks
 #include "platform.h"
 #include <attr/attrTbl.h>
+#include <protocol/udp_subscriber.h>
+#include <protocol/eegdata_cache.h>
+#include <protocol/evtdata_protocol.h>
 #include <service/timestamp.h>
 #include <service/ads1299.h>
 #include <service/bq25895.h>
+#include <service/telemetry.h>
 
 /********************************************************************************
  *  GLOBAL VARIABLES
@@ -616,6 +620,18 @@ void mainThread(void *pvParameters)
     /* Initial AttrTbl */
     AttrTbl_Init();
 
+    /* Initial UDP subscriber table */
+    UDP_SubscriberInit();
+
+    /* Initial EEG data retransmission cache */
+    UDP_EEGCacheInit();
+
+    /* Initial event queue */
+    UDP_EvtQueueInit();
+
+    /* Initial runtime telemetry (DWT cycle counter) */
+    Telem_Init();
+
     /* Initializes signals for all tasks */
     sem_init(&UDPEEGDataReady, 0, 0);
     sem_init(&UDPEvtDataReady, 0, 0);
@@ -15,11 +15,14 @@
 #define CONTROL_TASK_PRIORITY                 (2)
 #define TCP_WORKER_PRIORITY                   (4)
 #define SOCKET_TASK_PRIORITY                  (1)
-#define UDP_TASK_STACK_SIZE                   (1024)
-#define CONTROL_STACK_SIZE                    (1024)
-#define SAMPLE_STACK_SIZE                     (1024)
-#define SYNC_STACK_SIZE                       (1024)
-#define DETECT_STACK_SIZE                     (1024)
+
+/* 线程栈由HeapMem堆（cc32xxs_tirtos.cmd HEAPSIZE）分配，取值依据见task/README.md 线程栈与RAM预算，
+   上线后以属性 TASK_STAT 的栈使用峰值核对，峰值不超过栈大小的75% */
+#define UDP_TASK_STACK_SIZE                   (1536)
+#define CONTROL_STACK_SIZE                    (1536)
+#define SAMPLE_STACK_SIZE                     (2048)
+#define SYNC_STACK_SIZE                       (1536)
+#define DETECT_STACK_SIZE                     (1536)
 #define TASK_STACK_SIZE                       (4096)
 #define SLNET_IF_WIFI_PRIO                    (5)
 #define SLNET_IF_WIFI_NAME                    "CC3235S"
@@ -17,29 +17,25 @@
 #include <stdio.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <time.h>
 
 #include <ti/display/Display.h>
 
 #include "attr_protocol.h"
-#include <utility/stateMachine.h>
+#include "eegdata_cache.h"
+#include <service/trace.h>
 
 /*********************************************************************
  *  LOCAL VARIABLES
  */
 /* 控制通道变量 */
-static TCPFrame_t tcpframe;             //!< FSM存储一帧数据
-static bool fsmFinalState=false;        //!< 标识FSM退出状态
+static TCPCtx_t TCPCtxPool[TCP_CTX_NUM];    //!< 连接上下文池，每个TCP连接独占一个
 
 /*********************************************************************
  *  GLOBAL VARIABLES
  */
 extern Display_Handle display;
 
-uint8_t TCP_Tx_Buff[TCP_Tx_Buff_Size];      //!< TCP发送缓冲区
-uint8_t TCP_Rx_Buff[TCP_Rx_Buff_Size];      //!< TCP接收缓冲区
-uint8_t *pTCP_Tx_Buff = TCP_Tx_Buff;
-uint8_t *pTCP_Rx_Buff = TCP_Rx_Buff;
-
 /*********************************************************************
  *  Callback
  */
@@ -84,6 +80,7 @@ static bool FrameSeekHead(void *condition, struct event *event);
 static bool FrameCheck(void *condition, struct event *event);
 static bool FrameIns(void *condition, struct event *event);
 static bool FrameReply(void *condition, struct event *event);
+static uint8_t FrameBatch(TCPCtx_t *pCtx, const uint8_t *pReq, uint8_t ReqLen, uint8_t *pRpy, uint8_t *pFrameLen);
 static void printErrMsg( void *stateData, struct event *event );
 static void printExitMsg( void *stateData, struct event *event );
 
@@ -219,13 +216,15 @@ static struct state falseState = {
  */
 static bool FrameSeekHead(void *condition, struct event *event)
 {
+   TCPCtx_t *pCtx = (TCPCtx_t*)event->data;
+
    //!< 复位
-   memset((uint8_t*)&tcpframe,0xff,sizeof(tcpframe));
-   fsmFinalState=false;
+   memset((uint8_t*)&pCtx->frame,0xff,sizeof(pCtx->frame));
+   pCtx->fsmFinalState=false;
 
-   tcpframe.FrameHeader = (uint8_t)event->data; //!< 获取帧头
+   pCtx->frame.FrameHeader = pCtx->Byte; //!< 获取帧头
 
-   return (uint8_t)condition == (uint8_t)tcpframe.FrameHeader;
+   return (uint8_t)condition == (uint8_t)pCtx->frame.FrameHeader;
 }
 
 /*!
@@ -237,19 +236,101 @@ static bool FrameSeekHead(void *condition, struct event *event)
  */
 static bool FrameCheck(void *condition, struct event *event)
 {
+   TCPCtx_t *pCtx = (TCPCtx_t*)event->data;
 
    if ( event->type != Event_TCPFRAME )
       return false;
 
-   tcpframe.FrameLength = (uint8_t)event->data; //!< 获取有效帧长度（除去帧头、帧尾和有效帧长三字节）
+   pCtx->frame.FrameLength = pCtx->Byte; //!< 获取有效帧长度（除去帧头、帧尾和有效帧长三字节）
 
-   if((uint8_t)condition == (uint8_t)*(pTCP_Rx_Buff+tcpframe.FrameLength+2))//!< 帧尾检测
+   if((uint8_t)condition == (uint8_t)*(pCtx->pRx+pCtx->frame.FrameLength+2))//!< 帧尾检测
       return true;
    else
        printErrMsg(frame_chk.data, event);
       return false;
 
 }
+/*!
+   \brief  TCP_NowMs
+
+   \return 单调时钟 ms，用于订阅推送限速
+ */
+static uint32_t TCP_NowMs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint32_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*!
+   \brief  FrameBatch
+
+   批量读写，由FrameIns调用。先检查请求各项是否完整、各项回复头部能否放入单帧，
+   再按顺序逐项调用读写属性回调，一项出错不影响其余各项。数据长度为0的项为读，否则为写。
+   回复每项为属性编号、错误码、数据长度及数据（读成功时为属性值，写不回显）；
+   回复超出单帧长度时其余读项返回ATTR_ERR_OVERFLOW，写项照常执行。
+
+   \param  pCtx     - 连接上下文
+           pReq     - 请求各项起始地址
+           ReqLen   - 请求各项总字节数
+           pRpy     - 回复各项写入地址
+           pFrameLen - 回复有效帧长（to be returned）
+
+   \return ATTR_SUCCESS      - 已逐项处理，各项结果见回复
+           ATTR_VAL_INVALID  - 请求格式错误，未处理任何一项
+           ATTR_ERR_OVERFLOW - 项数过多，各项回复头部放不下，未处理任何一项
+ */
+static uint8_t FrameBatch(TCPCtx_t *pCtx, const uint8_t *pReq, uint8_t ReqLen, uint8_t *pRpy, uint8_t *pFrameLen)
+{
+    uint16_t Pos, RpyLen = 2; //!< 有效帧含错误码+回复类型
+    uint8_t Len, Num = 0;
+
+    *pFrameLen = 2;
+
+    /* 格式检查 */
+    for(Pos=0; Pos+TCP_BATCH_REQ_HDR <= ReqLen; Pos += TCP_BATCH_REQ_HDR + pReq[Pos+1])
+        Num++;
+    if( (ReqLen == 0) || (Pos != ReqLen) )
+        return ATTR_VAL_INVALID;
+    if( RpyLen + (uint16_t)Num * TCP_BATCH_RPY_HDR > 0xFF )
+        return ATTR_ERR_OVERFLOW; //!< 回复放不下全部项头部，整批拒绝，不执行其中的写项
+
+    for(Pos=0; Pos<ReqLen; Pos += TCP_BATCH_REQ_HDR + pReq[Pos+1])
+    {
+        pRpy[0] = pReq[Pos];    //!< 属性编号
+        pRpy[2] = 0;            //!< 数据长度
+
+        if( pReq[Pos+1] == 0 ) //!< 读
+        {
+            pRpy[1] = pattr_CBs->pfnReadAttrCB(pReq[Pos], 0xFF, pCtx->BatchValue, &Len);
+            if( pRpy[1] == ATTR_SUCCESS )
+            {
+                if( RpyLen + TCP_BATCH_RPY_HDR + Len > 0xFF )
+                    pRpy[1] = ATTR_ERR_OVERFLOW;
+                else
+                {
+                    pRpy[2] = Len;
+                    memcpy(pRpy+TCP_BATCH_RPY_HDR, pCtx->BatchValue, Len);
+                }
+            }
+        }
+        else //!< 写
+        {
+            pRpy[1] = pattr_CBs->pfnWriteAttrCB(pReq[Pos], 0xFF,
+                                                 (uint8_t*)pReq+Pos+TCP_BATCH_REQ_HDR, pReq[Pos+1]);
+        }
+
+        RpyLen += TCP_BATCH_RPY_HDR + pRpy[2];
+        pRpy += TCP_BATCH_RPY_HDR + pRpy[2];
+    }
+
+    *pFrameLen = (uint8_t)RpyLen;
+
+    return ATTR_SUCCESS;
+}
+
 /*!
    \brief  FrameSeekHead
 
@@ -258,53 +339,181 @@ static bool FrameCheck(void *condition, struct event *event)
  */
 static bool FrameIns(void *condition, struct event *event)
 {
+   TCPCtx_t *pCtx = (TCPCtx_t*)event->data;
    bool InsState = true;
 
    if ( event->type != Event_TCPFRAME )
       return false;
 
    /* 根据有效帧长判定指令码，对接收帧数据预处理*/
-   if(tcpframe.FrameLength ==3)//!< 读属性操作 - 有效帧定长3
+   if(pCtx->frame.FrameLength ==3)//!< 读属性操作 - 有效帧定长3
    {
-       tcpframe.InsAttrNum = *(pTCP_Rx_Buff+3);
-       tcpframe.ChxNum = *(pTCP_Rx_Buff+4);
-       tcpframe.pDataLength = &tcpframe.DataLength;
+       pCtx->frame.InsAttrNum = *(pCtx->pRx+3);
+       pCtx->frame.ChxNum = *(pCtx->pRx+4);
+       pCtx->frame.pDataLength = &pCtx->frame.DataLength;
    }
-   else if(tcpframe.FrameLength == 1); //!< 空指令 - 有效帧定长1
+   else if(pCtx->frame.FrameLength == 1); //!< 空指令 - 有效帧定长1
    else //!< 写属性操作 - 有效帧>4 不定长
    {
-       tcpframe.DataLength = tcpframe.FrameLength-3;
-       tcpframe.InsAttrNum = *(pTCP_Rx_Buff+3);
-       tcpframe.ChxNum = *(pTCP_Rx_Buff+4);
-       tcpframe._OP_ = pTCP_Rx_Buff+5;
+       pCtx->frame.DataLength = pCtx->frame.FrameLength-3;
+       pCtx->frame.InsAttrNum = *(pCtx->pRx+3);
+       pCtx->frame.ChxNum = *(pCtx->pRx+4);
+       pCtx->frame._OP_ = pCtx->pRx+5;
    }
 
-   tcpframe.InsNum = (uint8_t)event->data; //!< 获取指令码
+   pCtx->frame.InsNum = pCtx->Byte; //!< 获取指令码
 
-   switch(tcpframe.InsNum)
+   switch(pCtx->frame.InsNum)
    {
        case CAttr_Read: //!< 读普通属性
+           pCtx->frame.ChxNum = 0xFF; //!< 普通属性不涉及通道
+           /* no break */
+       case ChxAttr_Read: //!< 读通道属性 - 通道编号CHX_ALL读取全部通道
+           if( pCtx->frame.FrameLength != 3 )
+           {
+               pCtx->frame.ERR_NUM = ATTR_VAL_INVALID; //!< 先校验帧长：读属性有效帧定长3
+               pCtx->frame.FrameLength = 2;
+               break;
+           }
            //!< 读属性回调
-           tcpframe.ERR_NUM = pattr_CBs->pfnReadAttrCB( tcpframe.InsAttrNum,tcpframe.ChxNum, \
-                                                       (pTCP_Tx_Buff+4),tcpframe.pDataLength);
-           tcpframe.FrameLength = *(tcpframe.pDataLength)+2;
+           pCtx->frame.ERR_NUM = pattr_CBs->pfnReadAttrCB( pCtx->frame.InsAttrNum,pCtx->frame.ChxNum, \
+                                                       (pCtx->pTx+4),pCtx->frame.pDataLength);
+           pCtx->frame.FrameLength = *(pCtx->frame.pDataLength)+2;
            break;
 
        case CAttr_Write: //!< 写普通属性
+           pCtx->frame.ChxNum = 0xFF; //!< 普通属性不涉及通道
+           /* no break */
+       case ChxAttr_Write: //!< 写通道属性 - 通道编号CHX_ALL写入全部通道
+           if( pCtx->frame.FrameLength <= 3 )
+           {
+               pCtx->frame.ERR_NUM = ATTR_VAL_INVALID; //!< 先校验帧长：写属性有效帧至少4
+               pCtx->frame.FrameLength = 2;
+               break;
+           }
 
            //!< 写属性回调
-           tcpframe.ERR_NUM = pattr_CBs->pfnWriteAttrCB( tcpframe.InsAttrNum,tcpframe.ChxNum, \
-                                                         tcpframe._OP_,tcpframe.DataLength);
+           pCtx->frame.ERR_NUM = pattr_CBs->pfnWriteAttrCB( pCtx->frame.InsAttrNum,pCtx->frame.ChxNum, \
+                                                         pCtx->frame._OP_,pCtx->frame.DataLength);
 
-           if( tcpframe.ERR_NUM == ATTR_SUCCESS )
+           if( pCtx->frame.ERR_NUM == ATTR_SUCCESS )
            {
                //!< 拷贝一份用于回复
-               memcpy((pTCP_Tx_Buff+4),tcpframe._OP_,tcpframe.DataLength);
-               tcpframe.FrameLength = tcpframe.DataLength+2;
+               memcpy((pCtx->pTx+4),pCtx->frame._OP_,pCtx->frame.DataLength);
+               pCtx->frame.FrameLength = pCtx->frame.DataLength+2;
            }
            //!< 否则以错误码的形式返回 不通过串口返回
            break;
 
+       case EEGData_Resend: //!< 请求重发脑电数据帧 - 有效帧定长7：指令码 + 起始滚动码4 + 帧数2
+       {
+           uint32_t StartNum;
+           uint16_t Count;
+
+           pCtx->frame.InsAttrNum = 0xFF; //!< 不涉及属性
+
+           if( pCtx->frame.FrameLength != 7 )
+           {
+               pCtx->frame.ERR_NUM = ATTR_VAL_INVALID; //!< 先校验帧长，再取参数
+               pCtx->frame.FrameLength = 2;
+               break;
+           }
+           memcpy(&StartNum,pCtx->pRx+3,4);
+           memcpy(&Count,pCtx->pRx+7,2);
+
+           if( (Count == 0) || (Count > UDP_CACHE_ENTRY_NUM) )
+               pCtx->frame.ERR_NUM = ATTR_VAL_INVALID;
+           else if( !UDP_EEGResendRequest(StartNum,Count) )
+               pCtx->frame.ERR_NUM = INS_ERR_BUSY;
+           else
+               pCtx->frame.ERR_NUM = ATTR_SUCCESS;
+
+           pCtx->frame.FrameLength = 2; //!< 仅回复错误码
+           break;
+       }
+
+       case CAttr_Subscribe: //!< 订阅属性 - 有效帧定长4：指令码 + 属性编号 + 最小推送间隔2
+       {
+           uint16_t Interval;
+           uint8_t Len;
+
+           if( pCtx->frame.FrameLength != 4 )
+           {
+               pCtx->frame.ERR_NUM = ATTR_VAL_INVALID; //!< 先校验帧长，再取参数
+               pCtx->frame.FrameLength = 2;
+               break;
+           }
+           memcpy(&Interval,pCtx->pRx+4,2);
+
+           if( Interval == TCP_SUB_NONE )
+               pCtx->frame.ERR_NUM = ATTR_VAL_INVALID;
+           else if( pCtx->frame.InsAttrNum >= TCP_SUB_ATTR_MAX )
+               pCtx->frame.ERR_NUM = ATTR_NOT_FOUND;
+           else
+               pCtx->frame.ERR_NUM = pattr_CBs->pfnReadAttrCB(pCtx->frame.InsAttrNum, 0xFF,
+                                                              pCtx->BatchValue, &Len); //!< 检查属性是否存在
+
+           if( pCtx->frame.ERR_NUM == ATTR_SUCCESS )
+           {
+               pCtx->SubInterval[pCtx->frame.InsAttrNum] = Interval;
+               pCtx->SubLastMs[pCtx->frame.InsAttrNum] = TCP_NowMs() - Interval;
+               pCtx->Notify[pCtx->frame.InsAttrNum] = 1; //!< 订阅后立即推送一次当前值
+           }
+
+           pCtx->frame.FrameLength = 2; //!< 仅回复错误码
+           break;
+       }
+
+       case CAttr_Unsubscribe: //!< 取消订阅 - 有效帧定长2：指令码 + 属性编号，0xFF取消全部
+       {
+           uint8_t i;
+
+           if( pCtx->frame.FrameLength != 2 )
+               pCtx->frame.ERR_NUM = ATTR_VAL_INVALID;
+           else if( pCtx->frame.InsAttrNum == 0xFF )
+           {
+               for(i=0; i<TCP_SUB_ATTR_MAX; i++)
+                   pCtx->SubInterval[i] = TCP_SUB_NONE;
+               pCtx->frame.ERR_NUM = ATTR_SUCCESS;
+           }
+           else if( pCtx->frame.InsAttrNum >= TCP_SUB_ATTR_MAX )
+               pCtx->frame.ERR_NUM = ATTR_NOT_FOUND;
+           else
+           {
+               pCtx->SubInterval[pCtx->frame.InsAttrNum] = TCP_SUB_NONE;
+               pCtx->frame.ERR_NUM = ATTR_SUCCESS;
+           }
+
+           pCtx->frame.FrameLength = 2; //!< 仅回复错误码
+           break;
+       }
+
+       case Trace_Download: //!< 下载跟踪记录 - 有效帧定长5：指令码 + 起始序号4
+       {
+           uint32_t Start;
+
+           pCtx->frame.InsAttrNum = 0xFF; //!< 不涉及属性
+
+           if( pCtx->frame.FrameLength != 5 )
+           {
+               pCtx->frame.ERR_NUM = ATTR_VAL_INVALID; //!< 先校验帧长，再取参数
+               pCtx->frame.FrameLength = 2;
+           }
+           else
+           {
+               memcpy(&Start,pCtx->pRx+3,4);
+               pCtx->frame.ERR_NUM = ATTR_SUCCESS;
+               pCtx->frame.FrameLength = 2 + Trace_Read(Start, pCtx->pTx+4, 0xFF-2); //!< 当前写序号 + 至多20条记录
+           }
+           break;
+       }
+
+       case CAttr_Batch: //!< 批量读写普通属性 - 有效帧不定长：指令码 + n*(属性编号 + 数据长度 + 数据)
+           pCtx->frame.InsAttrNum = 0xFF; //!< 不涉及单个属性
+           pCtx->frame.ERR_NUM = FrameBatch(pCtx, pCtx->pRx+3, pCtx->frame.FrameLength-1,
+                                            pCtx->pTx+4, &pCtx->frame.FrameLength);
+           break;
+
        default:
            printErrMsg(frame_Ins.data, event);
            InsState=false;
@@ -323,19 +532,21 @@ static bool FrameIns(void *condition, struct event *event)
  */
 static bool FrameReply(void *condition, struct event *event)
 {
+   TCPCtx_t *pCtx = (TCPCtx_t*)event->data;
+
    /* 打包回复 */
-    *(pTCP_Tx_Buff) = TCP_Send_FH; //!< 帧头
+    *(pCtx->pTx) = TCP_Send_FH; //!< 帧头
 
-   if( tcpframe.ERR_NUM != ATTR_SUCCESS )
-       tcpframe.FrameLength=2; //!< 有效帧只含错误码+回复类型
+   if( pCtx->frame.ERR_NUM != ATTR_SUCCESS )
+       pCtx->frame.FrameLength=2; //!< 有效帧只含错误码+回复类型
 
-   *(pTCP_Tx_Buff+1) = tcpframe.FrameLength;  //!< 有效帧
-   *(pTCP_Tx_Buff+2) = tcpframe.ERR_NUM;      //!< 错误码
-   *(pTCP_Tx_Buff+3) = tcpframe.InsAttrNum;   //!< 回复类型（属性编号）
+   *(pCtx->pTx+1) = pCtx->frame.FrameLength;  //!< 有效帧
+   *(pCtx->pTx+2) = pCtx->frame.ERR_NUM;      //!< 错误码
+   *(pCtx->pTx+3) = pCtx->frame.InsAttrNum;   //!< 回复类型（属性编号）
 
-   *(pTCP_Tx_Buff+tcpframe.FrameLength+2)=TCP_Send_FT; //!< 帧尾
+   *(pCtx->pTx+pCtx->frame.FrameLength+2)=TCP_Send_FT; //!< 帧尾
 
-   fsmFinalState=true; //!< 状态机运行正常
+   pCtx->fsmFinalState=true; //!< 状态机运行正常
 
    return true;
 }
@@ -344,7 +555,7 @@ static void printErrMsg( void *stateData, struct event *event )
 {
     Display_printf(display, 0, 0, "false STATE: %s",(char *)stateData);
 
-    fsmFinalState=false; //!< 状态机从错误状态退出
+    ((TCPCtx_t*)event->data)->fsmFinalState=false; //!< 状态机从错误状态退出
 }
 
 static void printExitMsg( void *stateData, struct event *event )
@@ -353,34 +564,228 @@ static void printExitMsg( void *stateData, struct event *event )
 
 }
 
+/*!
+   \brief  控制通道帧协议解析
+
+   \param  pCtx  - 连接上下文
+           pdata - 需要帧解析的数据
+ */
+static bool TCP_ProcessFSM(TCPCtx_t *pCtx, uint8_t *pdata)
+{
+    uint8_t stateNum; //!< 状态切换的次数/状态机一次被调用轮询的次数
+
+    /* 受框架机制限制的处理方式 - 最多轮4次完成一次帧解析 */
+    for(stateNum=0;stateNum<4;stateNum++)
+    {
+        pCtx->Byte = *pdata++;
+        stateM_handleEvent(&pCtx->fsm,
+                           &(struct event){ Event_TCPFRAME,(void *)pCtx });
+     }
+
+    return pCtx->fsmFinalState;
+}
+
 /*********************************************************************
  * FUNCTIONS
  */
 
-struct stateMachine TCP_Processfsm;
 /*!
-    \brief  控制通道帧协议状态机初始化
+    \brief  分配连接上下文
+
+    上位机TCP连接建立时由tcpHandler调用，上下文内的帧组装缓冲区、回复缓冲区、
+    帧解析结构体及状态机均为该连接独占，多个上位机同时连接互不干扰。
+
+    \param  ClientFd - 连接套接字
+
+    \return 连接上下文，连接数已满时返回NULL
  */
-void TCP_ProcessFSMInit(void)
+TCPCtx_t* TCP_CtxAlloc(int ClientFd)
 {
+    uint8_t i;
 
-    stateM_init( &TCP_Processfsm, &frame_seekhead, &falseState );
+    for(i=0; i<TCP_CTX_NUM; i++)
+    {
+        if( !TCPCtxPool[i].InUse )
+        {
+            TCPCtxPool[i].ClientFd = ClientFd;
+            TCPCtxPool[i].RxLen = 0;
+            TCPCtxPool[i].pRx = TCPCtxPool[i].Rx_Buff;
+            TCPCtxPool[i].pTx = TCPCtxPool[i].Tx_Buff;
+            TCPCtxPool[i].fsmFinalState = false;
+            memset(TCPCtxPool[i].SubInterval, 0xFF, sizeof(TCPCtxPool[i].SubInterval)); //!< TCP_SUB_NONE
+            memset((uint8_t*)TCPCtxPool[i].Notify, 0, sizeof(TCPCtxPool[i].Notify));
+            stateM_init( &TCPCtxPool[i].fsm, &frame_seekhead, &falseState );
+            TCPCtxPool[i].InUse = true;
+
+            return &TCPCtxPool[i];
+        }
+    }
+
+    return NULL;
 }
+
 /*!
-   \brief  控制通道帧协议解析
+    \brief  释放连接上下文，连接断开时由tcpWorker调用
 
-   \param  pdata - 需要帧解析的数据
+    \param  pCtx - 连接上下文
  */
-bool TCP_ProcessFSM(uint8_t *pdata)
+void TCP_CtxFree(TCPCtx_t *pCtx)
 {
-    uint8_t stateNum; //!< 状态切换的次数/状态机一次被调用轮询的次数
+    pCtx->InUse = false;
+}
 
-    /* 受框架机制限制的处理方式 - 最多轮4次完成一次帧解析 */
-    for(stateNum=0;stateNum<4;stateNum++)
+/*!
+    \brief  获取帧组装缓冲区的接收位置
+
+    \param  pCtx  - 连接上下文
+            pSize - 可接收的字节数（to be returned）
+
+    \return recv写入地址，写入后调用TCP_StreamProcess()
+ */
+uint8_t* TCP_StreamRecvBuff(TCPCtx_t *pCtx, uint16_t *pSize)
+{
+    *pSize = TCP_Rx_Buff_Size - pCtx->RxLen;
+
+    return pCtx->Rx_Buff + pCtx->RxLen;
+}
+
+/*!
+    \brief  控制通道帧组装及批量处理
+
+    TCP是字节流，一次recv可能只含半帧，也可能含多个流水线帧。本函数将新接收的字节
+    追加到已缓存的字节之后，依次取出其中所有完整的0xAC...0xCC帧交给状态机解析，
+    各帧回复按顺序连续写入上下文的回复缓冲区，由调用者一次send发出。
+    帧头不符或帧尾不符时逐字节重新同步；不完整的帧保留至下次接收。
+
+    \param  pCtx    - 连接上下文
+            RecvLen - 本次recv写入TCP_StreamRecvBuff()所指位置的字节数
+            pTxLen  - 批量回复字节数（to be returned），0表示无需回复
+
+    \return true  - 回复缓冲区已满，仍有完整帧待处理，发送回复后须以RecvLen=0再次调用
+            false - 已缓存的完整帧处理完毕
+ */
+bool TCP_StreamProcess(TCPCtx_t *pCtx, uint16_t RecvLen, uint16_t *pTxLen)
+{
+    uint8_t *pBuf = pCtx->Rx_Buff;
+    uint16_t Pos = 0, FrameSize, TxLen = 0;
+    bool More = false;
+
+    pCtx->RxLen += RecvLen;
+
+    while( pCtx->RxLen - Pos >= 2 )
     {
-        stateM_handleEvent(&TCP_Processfsm,
-                           &(struct event){ Event_TCPFRAME,(void *)(uint8_t)(*pdata++)});
-     }
+        /* 帧头同步 */
+        if( pBuf[Pos] != TCP_Recv_FH )
+        {
+            Pos++;
+            continue;
+        }
+
+        FrameSize = pBuf[Pos+1] + 3;
+        if( pCtx->RxLen - Pos < FrameSize )
+            break; //!< 不完整，等待后续字节
+
+        /* 帧尾不符或有效帧为空：非本协议帧或误同步，跳过该帧头 */
+        if( (FrameSize < 4) || (pBuf[Pos+FrameSize-1] != TCP_Recv_FT) )
+        {
+            Pos++;
+            continue;
+        }
+
+        if( TCP_Tx_Buff_Size - TxLen < TCP_REPLY_MAX )
+        {
+            More = true; //!< 先发送已有回复
+            break;
+        }
+
+        /* 状态机就地解析本帧，回复写入批量回复缓冲区末尾 */
+        pCtx->pRx = pBuf + Pos;
+        pCtx->pTx = pCtx->Tx_Buff + TxLen;
+        if( TCP_ProcessFSM(pCtx, pCtx->pRx) == true )
+            TxLen += *(pCtx->pTx+1) + 3;
+        else
+            stateM_init( &pCtx->fsm, &frame_seekhead, &falseState ); //!< 指令非法，不回复，状态机回到帧头检测
+
+        Pos += FrameSize;
+    }
+
+    /* 未处理字节移至缓冲区起始 */
+    pCtx->RxLen -= Pos;
+    memmove(pBuf, pBuf + Pos, pCtx->RxLen);
+
+    pCtx->pRx = pBuf;
+    pCtx->pTx = pCtx->Tx_Buff;
+    *pTxLen = TxLen;
+
+    return More;
+}
+
+/*!
+    \brief  属性值变化通知
+
+    由属性层在属性值被上位机、应用层或服务修改后调用，仅为订阅了该属性的连接
+    置待推送标志，不发送、不阻塞，可在任意线程中调用。实际推送由各连接的
+    tcpWorker经TCP_NotifyProcess()完成，限速期间的多次变化合并为一次推送。
+
+    \param  AttrNum - 值变化的属性编号
+ */
+void TCP_AttrNotify(uint8_t AttrNum)
+{
+    uint8_t i;
+
+    if( AttrNum >= TCP_SUB_ATTR_MAX )
+        return;
+
+    for(i=0; i<TCP_CTX_NUM; i++)
+    {
+        if( TCPCtxPool[i].InUse && (TCPCtxPool[i].SubInterval[AttrNum] != TCP_SUB_NONE) )
+            TCPCtxPool[i].Notify[AttrNum] = 1;
+    }
+}
+
+/*!
+    \brief  订阅推送封包
+
+    由tcpWorker在每次接收（或接收超时）后调用，将本连接已变化且已过最小推送间隔的
+    订阅属性按回复帧格式（帧头TCP_Notify_FH，回复类型为属性编号）写入回复缓冲区。
+    先清待推送标志再读属性值，读后发生的变化留待下次推送，不会丢失。
+
+    \param  pCtx - 连接上下文
+
+    \return 推送字节数，0表示无需推送
+ */
+uint16_t TCP_NotifyProcess(TCPCtx_t *pCtx)
+{
+    uint8_t *pTx = pCtx->Tx_Buff;
+    uint16_t TxLen = 0;
+    uint32_t Now = TCP_NowMs();
+    uint8_t i, Len;
+
+    for(i=0; i<TCP_SUB_ATTR_MAX; i++)
+    {
+        if( !pCtx->Notify[i] || (pCtx->SubInterval[i] == TCP_SUB_NONE) )
+            continue;
+
+        if( Now - pCtx->SubLastMs[i] < pCtx->SubInterval[i] )
+            continue; //!< 限速，保留标志
+
+        if( TCP_Tx_Buff_Size - TxLen < TCP_REPLY_MAX )
+            break; //!< 其余留待下次
+
+        pCtx->Notify[i] = 0;
+        if( pattr_CBs->pfnReadAttrCB(i, 0xFF, pTx+4, &Len) != ATTR_SUCCESS )
+            continue;
+
+        pTx[0] = TCP_Notify_FH;
+        pTx[1] = Len + 2;
+        pTx[2] = ATTR_SUCCESS;
+        pTx[3] = i;
+        pTx[Len+4] = TCP_Send_FT;
+
+        pCtx->SubLastMs[i] = Now;
+        TxLen += Len + 5;
+        pTx += Len + 5;
+    }
 
-    return fsmFinalState;
+    return TxLen;
 }
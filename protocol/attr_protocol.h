@@ -6,6 +6,8 @@
  */
 #include <stdbool.h>
 
+#include <utility/stateMachine.h>
+
 /*********************************************************************
  * MARCOS
  */
@@ -17,22 +19,42 @@
 // 设备->上位机 回复
 #define TCP_Send_FH                 0xA2    //!< TCP发送帧头
 #define TCP_Send_FT                 0xC2    //!< TCP发送帧尾
+#define TCP_Notify_FH               0xA3    //!< 订阅推送帧头（帧格式同回复）
 // 指令码
 #define DummyIns                    0x00    //!< 空指令
 #define CAttr_Read                  0x01    //!< 读一个普通属性
 #define CAttr_Write                 0x10    //!< 写一个普通属性
-#define ChxAttr_Read                0x02    //!< 读一个通道属性    //TODO
-#define ChxAttr_Write               0x20    //!< 写一个通道属性    //TODO
+#define ChxAttr_Read                0x02    //!< 读一个通道属性
+#define ChxAttr_Write               0x20    //!< 写一个通道属性
+#define EEGData_Resend              0x05    //!< 请求重发脑电数据帧（NACK）
+#define CAttr_Batch                 0x06    //!< 批量读写普通属性
+#define CAttr_Subscribe             0x07    //!< 订阅属性值变化
+#define CAttr_Unsubscribe           0x08    //!< 取消订阅
+#define Trace_Download              0x09    //!< 下载跟踪记录
 // 错误码
 #define ATTR_SUCCESS                0x00    //!< 属性读写正常
 #define ATTR_ERR_RO                 0x01    //!< 属性不允许写操作
 #define ATTR_ERR_SIZE               0x02    //!< 待写数据长度与属性值长度不符
 #define ATTR_NOT_FOUND              0x03    //!< 待读写的属性不存在
 #define ATTR_VAL_INVALID            0x04    //!< 待读写的属性值非法  //TODO
+#define INS_ERR_BUSY                0x05    //!< 设备忙，指令未受理
+#define ATTR_ERR_OVERFLOW           0x06    //!< 批量回复超出单帧长度，该属性未读取（项数过多时整批未处理）
 
 // 通讯收发缓冲区参数
-#define TCP_Rx_Buff_Size            16
-#define TCP_Tx_Buff_Size            128     //!< try to fix：考虑阻抗值
+#define TCP_FRAME_MAX               258     //!< 单帧最大字节数 = 帧头 + 有效帧长 + 有效帧(最长255) + 帧尾
+#define TCP_Rx_Buff_Size            512     //!< 帧组装缓冲区，须不小于TCP_FRAME_MAX，可容纳多个流水线帧
+#define TCP_Tx_Buff_Size            1024    //!< 批量回复缓冲区，一次send发出
+#define TCP_REPLY_MAX               260     //!< 单帧回复最大字节数 = 帧头 + 有效帧长 + 错误码 + 属性编号 + 属性值(最长255) + 帧尾
+#define TCP_BATCH_REQ_HDR           2       //!< 批量读写请求每项头部 = 属性编号 + 数据长度
+#define TCP_BATCH_RPY_HDR           3       //!< 批量读写回复每项头部 = 属性编号 + 错误码 + 数据长度
+
+// 并发连接
+#define TCP_CTX_NUM                 3       //!< 连接上下文数，即可同时连接的上位机数
+
+// 订阅推送
+#define TCP_SUB_ATTR_MAX            64      //!< 可订阅的属性编号上限
+#define TCP_SUB_NONE                0xFFFF  //!< 未订阅
+#define TCP_NOTIFY_TICK_MS          100     //!< tcpWorker接收超时，即推送检查周期 ms
 
 /*******************************************************************
  * TYPEDEFS
@@ -41,7 +63,7 @@
 /*!
     /brief  声明 读属性回调函数原型
     /param  InsAttrNum - 待读属性编号
-            CHxNum - 通道编号（本版本不涉及 0xFF //TODO）
+            CHxNum - 通道编号（普通属性 0xFF）
             pValue - 属性值 （to be returned）
             pLen - 属性值大小（to be returned）
  */
@@ -51,7 +73,7 @@ typedef uint8_t (*pfnReadAttrCB_t)( uint8_t InsAttrNum, uint8_t CHxNum,
 /*!
     /brief  声明 写属性回调函数原型
     /param  InsAttrNum - 待写入属性编号
-            CHxNum - 通道编号（本版本不涉及 0xFF //TODO）
+            CHxNum - 通道编号（普通属性 0xFF）
             pValue - 待写入数据的指针
             pLen - 待写入数据大小
  */
@@ -84,11 +106,38 @@ typedef struct
    uint8_t *_OP_;          //!< 操作立即数指针（写回调用）
 } TCPFrame_t;
 
+/*!
+    /brief  TCP控制通道连接上下文
+            每个TCP连接独占一个，保存该连接的收发缓冲区与帧解析状态
+ */
+typedef struct
+{
+   uint8_t  Rx_Buff[TCP_Rx_Buff_Size];   //!< 帧组装缓冲区
+   uint8_t  Tx_Buff[TCP_Tx_Buff_Size];   //!< 批量回复缓冲区
+   uint8_t  BatchValue[255];             //!< 批量读属性值暂存
+   uint16_t RxLen;                       //!< 帧组装缓冲区中已接收未处理的字节数
+   uint8_t  *pRx;                        //!< 当前解析帧起始位置
+   uint8_t  *pTx;                        //!< 当前帧回复写入位置
+   uint8_t  Byte;                        //!< 当前送入状态机的字节
+   bool     fsmFinalState;               //!< 标识FSM退出状态
+   volatile bool InUse;                  //!< 上下文已分配
+   int      ClientFd;                    //!< 连接套接字
+   TCPFrame_t frame;                     //!< FSM存储一帧数据
+   struct stateMachine fsm;              //!< 帧处理状态机
+   uint16_t SubInterval[TCP_SUB_ATTR_MAX];       //!< 订阅的最小推送间隔 ms，TCP_SUB_NONE-未订阅
+   uint32_t SubLastMs[TCP_SUB_ATTR_MAX];         //!< 上次推送时刻 ms
+   volatile uint8_t Notify[TCP_SUB_ATTR_MAX];    //!< 属性值已变化，待推送
+} TCPCtx_t;
+
 /**********************************************************************
  * FUNCTIONS
  */
-void TCP_ProcessFSMInit(void);
-bool TCP_ProcessFSM(uint8_t *pdata);
+TCPCtx_t* TCP_CtxAlloc(int ClientFd);
+void TCP_CtxFree(TCPCtx_t *pCtx);
+uint8_t* TCP_StreamRecvBuff(TCPCtx_t *pCtx, uint16_t *pSize);
+bool TCP_StreamProcess(TCPCtx_t *pCtx, uint16_t RecvLen, uint16_t *pTxLen);
+void TCP_AttrNotify(uint8_t AttrNum);
+uint16_t TCP_NotifyProcess(TCPCtx_t *pCtx);
 bool protocol_RegisterAttrCBs(AttrCBs_t *pAttrcallbacks);
 
 #endif  /* __ATTR_PROTOCOL_H__ */
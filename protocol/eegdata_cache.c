@@ -0,0 +1,204 @@
+/**
+ * @file    eegdata_cache.c
+ * @author  gjmsilly
+ * @brief   NanoEEG UDP1脑电数据帧重传缓存
+ *
+ *          发送线程（udp1Worker）将每帧实际发送的字节流按UDP包累加滚动码存入缓存，
+ *          上位机发现丢包后经TCP控制通道发送NACK指令，请求经消息队列转交发送线程，
+ *          由发送线程从缓存中取出对应帧重发。缓存只由发送线程读写，无需加锁。
+ * @version 1.0.0
+ * @date    2022-03-28
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+/* POSIX Header files */
+#include <mqueue.h>
+#include <semaphore.h>
+
+#include "eegdata_protocol.h"
+#include "eegdata_cache.h"
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static uint8_t          CachePool[UDP_CACHE_POOL_SIZE];     //!< 字节池
+static UDPCacheEntry_t  CacheEntry[UDP_CACHE_ENTRY_NUM];    //!< 表项环形缓冲区
+static uint8_t          CacheHead;                          //!< 下一个写入表项
+static uint8_t          CacheCount;                         //!< 有效表项数
+static uint16_t         CachePoolWr;                        //!< 字节池写位置
+
+static mqd_t            ResendMQueue;                       //!< 重传请求队列
+
+/*********************************************************************
+ *  EXTERNAL VARIABLES
+ */
+extern sem_t UDPEEGDataReady;
+
+/*********************************************************************
+ *  LOCAL FUNCTIONS
+ */
+
+/*!
+    \brief  UDP_EEGCacheOldest
+
+    \return 最早的有效表项，调用前须确认CacheCount非零
+ */
+static UDPCacheEntry_t* UDP_EEGCacheOldest(void)
+{
+    return &CacheEntry[(uint8_t)(CacheHead - CacheCount) & (UDP_CACHE_ENTRY_NUM - 1)];
+}
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+
+/*!
+    \brief  UDP_EEGCacheInit
+
+    初始化重传缓存及重传请求队列，须在网络线程创建之前调用
+ */
+void UDP_EEGCacheInit(void)
+{
+    mq_attr attr;
+
+    CacheHead = 0;
+    CacheCount = 0;
+    CachePoolWr = 0;
+
+    attr.mq_maxmsg = UDP_RESEND_REQ_NUM;
+    attr.mq_msgsize = sizeof(UDPResendReq_t);
+    ResendMQueue = mq_open("resend msg q", O_CREAT | O_NONBLOCK, 0, &attr);
+}
+
+/*!
+    \brief  UDP_EEGCachePut
+
+    缓存一帧已发送的数据，由发送线程在发送后调用。
+    字节池按顺序写入，空间不足时回绕并淘汰被覆盖的最早帧；
+    UDP包累加滚动码归零（重新开始采样）时清空缓存。
+
+    \param  pBuf - 已发送的字节流（以脑电数据帧头部开始）
+            Len  - 字节数
+ */
+void UDP_EEGCachePut(const uint8_t *pBuf, uint16_t Len)
+{
+    UDPCacheEntry_t *pEntry;
+    uint32_t UDPNum;
+    uint16_t Offset;
+
+    if( Len > UDP_CACHE_POOL_SIZE )
+        return;
+
+    memcpy(&UDPNum, ((const UDPHeader_t*)pBuf)->UDPNum, 4);
+    if( UDPNum == 0 )
+    {
+        CacheCount = 0; //!< 新的采样，旧数据作废
+    }
+
+    /* 分配字节池空间 */
+    Offset = CachePoolWr;
+    if( Offset + Len > UDP_CACHE_POOL_SIZE )
+    {
+        /* 回绕：字节池尾部剩余空间中的帧为最早的帧，先行淘汰 */
+        while( CacheCount && (UDP_EEGCacheOldest()->Offset >= Offset) )
+            CacheCount--;
+        Offset = 0;
+    }
+
+    /* 淘汰与新帧重叠或超出表项数的最早帧 */
+    while( CacheCount )
+    {
+        pEntry = UDP_EEGCacheOldest();
+        if( (CacheCount < UDP_CACHE_ENTRY_NUM) &&
+            ((pEntry->Offset >= Offset + Len) || (pEntry->Offset + pEntry->Len <= Offset)) )
+            break;
+        CacheCount--;
+    }
+
+    memcpy(&CachePool[Offset], pBuf, Len);
+
+    pEntry = &CacheEntry[CacheHead];
+    pEntry->UDPNum = UDPNum;
+    pEntry->Offset = Offset;
+    pEntry->Len = Len;
+
+    CacheHead = (CacheHead + 1) & (UDP_CACHE_ENTRY_NUM - 1);
+    CacheCount++;
+    CachePoolWr = Offset + Len;
+}
+
+/*!
+    \brief  UDP_EEGCacheGet
+
+    按UDP包累加滚动码查找缓存帧，由发送线程调用
+
+    \param  UDPNum - UDP包累加滚动码
+            pLen   - 帧长度（to be returned）
+
+    \return 缓存帧，已被淘汰或从未发送则返回NULL
+ */
+const uint8_t* UDP_EEGCacheGet(uint32_t UDPNum, uint16_t *pLen)
+{
+    UDPCacheEntry_t *pEntry;
+    uint8_t i;
+
+    for(i=0; i<CacheCount; i++)
+    {
+        pEntry = &CacheEntry[(uint8_t)(CacheHead - 1 - i) & (UDP_CACHE_ENTRY_NUM - 1)];
+        if( pEntry->UDPNum == UDPNum )
+        {
+            *pLen = pEntry->Len;
+            return &CachePool[pEntry->Offset];
+        }
+    }
+    return NULL;
+}
+
+/*!
+    \brief  UDP_EEGResendRequest
+
+    提交重传请求并唤醒发送线程，由TCP控制通道调用
+
+    \param  StartNum - 起始UDP包累加滚动码
+            Count    - 连续帧数
+
+    \return true - 请求已受理
+            false - 请求队列已满
+ */
+bool UDP_EEGResendRequest(uint32_t StartNum, uint16_t Count)
+{
+    UDPResendReq_t Req;
+
+    Req.StartNum = StartNum;
+    Req.Count = Count;
+
+    if( mq_send(ResendMQueue, (char *)&Req, sizeof(Req), 0) != 0 )
+        return false;
+
+    sem_post(&UDPEEGDataReady); //!< 唤醒发送线程
+    return true;
+}
+
+/*!
+    \brief  UDP_EEGResendPending
+
+    取出一个待处理的重传请求，由发送线程每次被唤醒后调用，不阻塞
+
+    \param  pReq - 重传请求（to be returned）
+
+    \return true - 取得请求
+            false - 无待处理请求
+ */
+bool UDP_EEGResendPending(UDPResendReq_t *pReq)
+{
+    return mq_receive(ResendMQueue, (char *)pReq, sizeof(UDPResendReq_t), NULL) > 0;
+}
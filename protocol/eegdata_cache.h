@@ -0,0 +1,60 @@
+/**
+ * @file    eegdata_cache.h
+ * @author  gjmsilly
+ * @brief   NanoEEG UDP1脑电数据帧重传缓存
+ * @version 1.0.0
+ * @date    2022-03-28
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef __EEGDATA_CACHE_H
+#define __EEGDATA_CACHE_H
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*********************************************************************
+ * Macros
+ */
+#define UDP_CACHE_POOL_SIZE         8192    //!< 重传缓存字节池大小（x16 1kSPS 每包10样本约保存120ms，压缩帧约加倍）
+#define UDP_CACHE_ENTRY_NUM         32      //!< 重传缓存最多保存帧数（须为2的幂）
+#define UDP_RESEND_REQ_NUM          4       //!< 待处理重传请求队列深度
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/*!
+    \brief    重传缓存表项 - 一帧已发送数据在字节池中的位置
+ */
+typedef struct
+{
+    uint32_t    UDPNum;             //!< UDP包累加滚动码
+    uint16_t    Offset;             //!< 字节池偏移
+    uint16_t    Len;                //!< 帧长度
+} UDPCacheEntry_t;
+
+/*!
+    \brief    重传请求 - 由TCP控制通道NACK指令产生
+ */
+typedef struct
+{
+    uint32_t    StartNum;           //!< 起始UDP包累加滚动码
+    uint16_t    Count;              //!< 连续帧数
+} UDPResendReq_t;
+
+/**********************************************************************
+ * FUNCTIONS
+ */
+void UDP_EEGCacheInit(void);
+void UDP_EEGCachePut(const uint8_t *pBuf, uint16_t Len);
+const uint8_t* UDP_EEGCacheGet(uint32_t UDPNum, uint16_t *pLen);
+bool UDP_EEGResendRequest(uint32_t StartNum, uint16_t Count);
+bool UDP_EEGResendPending(UDPResendReq_t *pReq);
+
+#endif  /* __EEGDATA_CACHE_H */
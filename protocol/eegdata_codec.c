@@ -0,0 +1,285 @@
+/**
+ * @file    eegdata_codec.c
+ * @author  gjmsilly
+ * @brief   NanoEEG UDP1脑电数据帧无损压缩（线性预测 + Rice编码）
+ *
+ *          一帧数据按列拆分为若干序列：时间戳序列、每通道组的状态序列、每通道的量化值序列。
+ *          每个序列独立选择0/1/2阶预测及Rice参数k，残差经zigzag映射后Rice编码。
+ *          样本起始分隔符与样本序号可由样本数推出，不进入码流。
+ *          码流格式见 @ref protocol/README.md ，上位机参考解码器见 @ref host/eegdata_decode.c
+ * @version 1.0.0
+ * @date    2022-03-25
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "eegdata_codec.h"
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/*!
+    \brief  码流写入对象 - 高位在前
+ */
+typedef struct
+{
+    uint8_t     *pBuf;              //!< 输出缓冲区
+    uint16_t    Size;               //!< 输出缓冲区大小
+    uint16_t    Len;                //!< 已写入字节数
+    uint32_t    Acc;                //!< 未满一字节的待写位
+    uint8_t     AccBits;            //!< 待写位数（<8）
+    bool        Overflow;           //!< 输出缓冲区溢出
+} BitWriter_t;
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static uint32_t SeriesBuf[UDP_SAMPLENUM_MAX];   //!< 待编码序列
+
+/*********************************************************************
+ *  LOCAL FUNCTIONS
+ */
+
+/*!
+    \brief  BitWrite
+
+    写入Bits位（高位在前），Bits最大32
+
+    \param  pW   - 码流写入对象
+            Val  - 待写入值，仅低Bits位有效
+            Bits - 位数
+ */
+static void BitWrite(BitWriter_t *pW, uint32_t Val, uint8_t Bits)
+{
+    uint8_t n;
+
+    while(Bits)
+    {
+        n = (Bits > 24) ? (Bits - 24) : Bits; //!< 分段写入，保证累加器不溢出
+        Bits -= n;
+
+        pW->Acc = (pW->Acc << n) | ((Val >> Bits) & ((1UL << n) - 1));
+        pW->AccBits += n;
+
+        while(pW->AccBits >= 8)
+        {
+            pW->AccBits -= 8;
+            if(pW->Len < pW->Size)
+                pW->pBuf[pW->Len++] = (uint8_t)(pW->Acc >> pW->AccBits);
+            else
+                pW->Overflow = true;
+        }
+        pW->Acc &= (1UL << pW->AccBits) - 1;
+    }
+}
+
+/*!
+    \brief  BitFlush
+
+    补零至字节边界
+ */
+static void BitFlush(BitWriter_t *pW)
+{
+    if(pW->AccBits)
+        BitWrite(pW, 0, 8 - pW->AccBits);
+}
+
+/*!
+    \brief  SeriesResidual
+
+    计算序列第i个值的预测残差，前i<Order个值降阶预测。
+    运算按模2^32进行，解码端同样按模2^32还原，保证无损。
+
+    \param  pV    - 序列
+            i     - 序号
+            Order - 预测阶数
+
+    \return 残差（按有符号数解释）
+ */
+static int32_t SeriesResidual(const uint32_t *pV, uint8_t i, uint8_t Order)
+{
+    if(Order > i)
+        Order = i;
+
+    switch(Order)
+    {
+        case 0:  return (int32_t)pV[i];
+        case 1:  return (int32_t)(pV[i] - pV[i-1]);
+        default: return (int32_t)(pV[i] - 2*pV[i-1] + pV[i-2]);
+    }
+}
+
+/*!
+    \brief  ZigZag - 有符号残差映射为无符号数 0,-1,1,-2,2... -> 0,1,2,3,4...
+ */
+static uint32_t ZigZag(int32_t e)
+{
+    return ((uint32_t)e << 1) ^ (uint32_t)(e >> 31);
+}
+
+/*!
+    \brief  SeriesEncode
+
+    对一个序列选择代价最小的预测阶数及Rice参数并编码
+
+    序列头部：预测阶数(2bit) + Rice参数k(5bit)
+    每个残差：商q=u>>k以一元码写入（q个1后接0）再写入u的低k位；
+              q>=EEG_CODEC_RICE_ESC时写入EEG_CODEC_RICE_ESC个1，其后为u的32位原码
+
+    \param  pW - 码流写入对象
+            pV - 序列
+            n  - 序列长度
+ */
+static void SeriesEncode(BitWriter_t *pW, const uint32_t *pV, uint8_t n)
+{
+    uint64_t Cost;
+    uint64_t BestCost = UINT64_MAX;
+    uint8_t  BestOrder = 0;
+    uint8_t  Order, i, k;
+    uint32_t u, q;
+
+    /* 选择残差绝对值和最小的预测阶数 */
+    for(Order=0; Order<=EEG_CODEC_ORDER_MAX; Order++)
+    {
+        Cost = 0;
+        for(i=0; i<n; i++)
+            Cost += ZigZag(SeriesResidual(pV, i, Order));
+
+        if(Cost < BestCost)
+        {
+            BestCost = Cost;
+            BestOrder = Order;
+        }
+    }
+
+    /* Rice参数 k = floor(log2(残差均值)) */
+    for(k=0; (k < 31) && (((uint64_t)n << (k+1)) <= BestCost); k++);
+
+    BitWrite(pW, BestOrder, EEG_CODEC_ORDER_BITS);
+    BitWrite(pW, k, EEG_CODEC_K_BITS);
+
+    for(i=0; i<n; i++)
+    {
+        u = ZigZag(SeriesResidual(pV, i, BestOrder));
+        q = u >> k;
+
+        if(q < EEG_CODEC_RICE_ESC)
+        {
+            BitWrite(pW, ((1UL << q) - 1) << 1, q + 1); //!< q个1后接0
+            BitWrite(pW, u, k);
+        }
+        else
+        {
+            BitWrite(pW, (1UL << EEG_CODEC_RICE_ESC) - 1, EEG_CODEC_RICE_ESC); //!< 转义
+            BitWrite(pW, u, 32);
+        }
+    }
+}
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+
+/*!
+    \brief  EEG_CodecEncode
+
+    压缩一帧脑电数据：复制帧头部并置位压缩标志，数据域替换为压缩码流。
+    部分通道未启用时帧头部后附通道掩码，仅编码含启用通道的通道组状态及启用通道的量化值。
+    压缩后不短于原始帧时放弃压缩，由调用者发送原始帧。
+
+    \param  pFrame    - 原始帧（帧头部已封包）
+            SampleNum - 本帧样本数
+            ChMask    - 启用的通道掩码 @ref UDP_CHMASK_ALL
+            pOut      - 输出缓冲区
+            OutSize   - 输出缓冲区大小
+
+    \return 压缩帧字节数，0表示放弃压缩
+ */
+uint16_t EEG_CodecEncode(const UDPDtFrame_t *pFrame, uint8_t SampleNum, uint32_t ChMask,
+                         uint8_t *pOut, uint16_t OutSize)
+{
+    BitWriter_t W;
+    const uint8_t *pVal;
+    uint16_t HeaderLen = UDP_HEADER_SIZE;
+    uint8_t GroupMask, Group, Ch, i;
+
+    if(OutSize > UDP_FRAME_SIZE(SampleNum) - 1)
+        OutSize = UDP_FRAME_SIZE(SampleNum) - 1; //!< 必须短于原始帧
+
+    if(ChMask != UDP_CHMASK_ALL)
+        HeaderLen += UDP_CHMASK_SIZE;
+
+    if(OutSize <= HeaderLen)
+        return 0;
+
+    /* 帧头部 */
+    memcpy(pOut, &pFrame->sampleheader, UDP_HEADER_SIZE);
+    ((UDPHeader_t*)pOut)->FrameFmt |= UDP_FMT_COMPRESSED;
+    if(ChMask != UDP_CHMASK_ALL)
+    {
+        ((UDPHeader_t*)pOut)->FrameFmt |= UDP_FMT_CHMASK;
+        ((UDPHeader_t*)pOut)->UDP_ChannelNum = 0;
+        for(i=0; i<CHANNEL_NUM; i++)
+            ((UDPHeader_t*)pOut)->UDP_ChannelNum += (ChMask >> i) & 1;
+        memcpy(pOut + UDP_HEADER_SIZE, &ChMask, UDP_CHMASK_SIZE);
+    }
+
+    W.pBuf = pOut + HeaderLen;
+    W.Size = OutSize - HeaderLen;
+    W.Len = 0;
+    W.Acc = 0;
+    W.AccBits = 0;
+    W.Overflow = false;
+
+    /* 时间戳序列 */
+    for(i=0; i<SampleNum; i++)
+        memcpy(&SeriesBuf[i], pFrame->sampledata[i].Timestamp, 4);
+    SeriesEncode(&W, SeriesBuf, SampleNum);
+
+    /* 逐通道组：状态序列 + 8个通道量化值序列（跳过未启用的通道组及通道） */
+    for(Group=0; Group<UDP_CHGROUP_NUM; Group++)
+    {
+        GroupMask = (uint8_t)(ChMask >> (Group*8));
+        if(!GroupMask)
+            continue;
+
+        for(i=0; i<SampleNum; i++)
+        {
+            pVal = &pFrame->sampledata[i].ChannelVal[Group*UDP_CHGROUP_SIZE];
+            SeriesBuf[i] = ((uint32_t)pVal[0] << 16) | ((uint32_t)pVal[1] << 8) | pVal[2];
+        }
+        SeriesEncode(&W, SeriesBuf, SampleNum);
+
+        for(Ch=0; Ch<8; Ch++)
+        {
+            if(!(GroupMask & (1 << Ch)))
+                continue;
+
+            for(i=0; i<SampleNum; i++)
+            {
+                pVal = &pFrame->sampledata[i].ChannelVal[Group*UDP_CHGROUP_SIZE + 3 + Ch*3];
+                SeriesBuf[i] = (uint32_t)((int32_t)(((uint32_t)pVal[0] << 24) |
+                               ((uint32_t)pVal[1] << 16) | ((uint32_t)pVal[2] << 8)) >> 8); //!< int24补码符号扩展
+            }
+            SeriesEncode(&W, SeriesBuf, SampleNum);
+        }
+
+        if(W.Overflow)
+            return 0;
+    }
+
+    BitFlush(&W);
+    if(W.Overflow)
+        return 0;
+
+    return HeaderLen + W.Len;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file    eegdata_codec.h
+ * @author  gjmsilly
+ * @brief   NanoEEG UDP1脑电数据帧无损压缩（线性预测 + Rice编码）
+ * @version 1.0.0
+ * @date    2022-03-25
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef __EEGDATA_CODEC_H
+#define __EEGDATA_CODEC_H
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "eegdata_protocol.h"
+
+/*********************************************************************
+ * Macros
+ */
+#define EEG_CODEC_ORDER_MAX         2       //!< 最高预测阶数
+#define EEG_CODEC_RICE_ESC          16      //!< Rice码商达到该值时转义，其后为32位原码
+#define EEG_CODEC_ORDER_BITS        2       //!< 序列头部 预测阶数位宽
+#define EEG_CODEC_K_BITS            5       //!< 序列头部 Rice参数位宽
+
+/**********************************************************************
+ * FUNCTIONS
+ */
+uint16_t EEG_CodecEncode(const UDPDtFrame_t *pFrame, uint8_t SampleNum, uint32_t ChMask,
+                         uint8_t *pOut, uint16_t OutSize);
+
+#endif  /* __EEGDATA_CODEC_H */
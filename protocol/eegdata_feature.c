@@ -0,0 +1,142 @@
+/**
+ * @file    eegdata_feature.c
+ * @author  gjmsilly
+ * @brief   NanoEEG UDP1脑电数据通道频带功率特征帧
+ *
+ *          采样线程每计算一次频带功率封装一个特征帧（帧类型UDP_FMT_TYPE_BANDPOWER），
+ *          经脑电数据通道端口发送。特征帧与脑电数据帧的UDP包累加滚动码相互独立，
+ *          不进入重传缓存及前向纠错。单生产者（SampleTask）单消费者（udp1Worker）无锁缓冲。
+ *          帧格式见 @ref protocol/README.md
+ * @version 1.0.0
+ * @date    2022-05-10
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <ti/drivers/net/wifi/slnetifwifi.h>
+
+#include "eegdata_feature.h"
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static uint8_t  FeatureBuff[UDP_FEATURE_SLOTNUM][UDP_FEATURE_BUFF_SIZE]; //!< 特征帧
+static uint16_t FeatureLen[UDP_FEATURE_SLOTNUM];    //!< 各特征帧字节数
+static volatile uint8_t FeatureWrIdx;               //!< 写索引（自由计数）- 仅由采样线程修改
+static volatile uint8_t FeatureRdIdx;               //!< 读索引（自由计数）- 仅由发送线程修改
+static uint32_t FeatureNum;                         //!< 特征帧累加滚动码
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+
+/*!
+    \brief  UDP_EEGFeatureReset
+
+    特征帧累加滚动码清零，由控制任务在开始采样前调用
+ */
+void UDP_EEGFeatureReset(void)
+{
+    FeatureNum = 0;
+}
+
+/*!
+    \brief  UDP_EEGFeaturePut
+
+    封装一个特征帧，由采样线程在频带功率计算完成后调用，不阻塞。
+    发送线程尚未取走前两帧时本帧丢弃，滚动码照常累加，上位机可据此发现丢帧。
+
+    \param  Time       - 窗内最后一个样本的时间（64位系统时间），帧中写入其10us单位的低32位
+            pBandPower - 各通道频带功率 uV^2 @ref EEGBand_Result
+
+    \return true - 已封装，待发送
+            false - 缓冲已满，本帧丢弃
+ */
+bool UDP_EEGFeaturePut(uint64_t Time, const float *pBandPower)
+{
+    extern SlDeviceVersion_t ver;
+
+    uint32_t ChMask = UDP_EEGChMaskGet();
+    uint32_t Timestamp = SAMPLE_TICK_TO_10US(Time);
+    uint8_t Slot = FeatureWrIdx & (UDP_FEATURE_SLOTNUM - 1);
+    UDPHeader_t *pHeader = (UDPHeader_t *)FeatureBuff[Slot];
+    uint8_t *p = FeatureBuff[Slot] + UDP_HEADER_SIZE;
+    uint8_t Ch, ChNum = 0;
+
+    FeatureNum++;
+
+    if( (uint8_t)(FeatureWrIdx - FeatureRdIdx) >= UDP_FEATURE_SLOTNUM )
+        return false;
+
+    if( ChMask != UDP_CHMASK_ALL )
+    {
+        memcpy(p, &ChMask, UDP_CHMASK_SIZE);
+        p += UDP_CHMASK_SIZE;
+    }
+
+    memcpy(p, &Timestamp, 4);
+    p += 4;
+
+    for(Ch=0; Ch<CHANNEL_NUM; Ch++)
+    {
+        if( ChMask & ((uint32_t)1 << Ch) )
+        {
+            memcpy(p, &pBandPower[Ch * EEG_BAND_NUM], EEG_BAND_NUM * 4);
+            p += EEG_BAND_NUM * 4;
+            ChNum++;
+        }
+    }
+
+    pHeader->DevID = ver.ChipId;
+    memcpy(pHeader->UDPNum, &FeatureNum, 4);
+    pHeader->UDPSampleNum[0] = EEG_BAND_NUM;    //!< 每通道频带数
+    pHeader->UDPSampleNum[1] = 0;
+    pHeader->UDP_ChannelNum = ChNum;
+    memset(pHeader->UNIXTimeStamp, 0, 8);
+    pHeader->FrameFmt = UDP_FMT_TYPE_BANDPOWER | ((ChMask != UDP_CHMASK_ALL) ? UDP_FMT_CHMASK : 0);
+    memset(pHeader->ReservedNum, 0xFF, 3);
+
+    FeatureLen[Slot] = (uint16_t)(p - FeatureBuff[Slot]);
+    FeatureWrIdx++;
+
+    return true;
+}
+
+/*!
+    \brief  UDP_EEGFeatureRead
+
+    取待发送的特征帧，由发送线程调用，发送完毕后调用 UDP_EEGFeatureRelease
+
+    \param  pLen - 特征帧字节数（to be returned）
+
+    \return 特征帧，无待发送帧时返回NULL
+ */
+const uint8_t* UDP_EEGFeatureRead(uint16_t *pLen)
+{
+    uint8_t Slot = FeatureRdIdx & (UDP_FEATURE_SLOTNUM - 1);
+
+    if( FeatureRdIdx == FeatureWrIdx )
+        return NULL;
+
+    *pLen = FeatureLen[Slot];
+
+    return FeatureBuff[Slot];
+}
+
+/*!
+    \brief  UDP_EEGFeatureRelease
+
+    释放已发送完毕的特征帧
+ */
+void UDP_EEGFeatureRelease(void)
+{
+    FeatureRdIdx++;
+}
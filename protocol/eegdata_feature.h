@@ -0,0 +1,38 @@
+/**
+ * @file    eegdata_feature.h
+ * @author  gjmsilly
+ * @brief   NanoEEG UDP1脑电数据通道频带功率特征帧
+ * @version 1.0.0
+ * @date    2022-05-10
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef __EEGDATA_FEATURE_H
+#define __EEGDATA_FEATURE_H
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "eegdata_protocol.h"
+#include <service/eeg_bandpower.h>
+
+/*********************************************************************
+ * Macros
+ */
+#define UDP_FEATURE_SLOTNUM         2       //!< 特征帧缓冲数（2的幂）
+#define UDP_FEATURE_BUFF_SIZE       (UDP_HEADER_SIZE + UDP_CHMASK_SIZE + 4 + \
+                                     CHANNEL_NUM * EEG_BAND_NUM * 4)    //!< 特征帧最大字节数
+
+/**********************************************************************
+ * FUNCTIONS
+ */
+void UDP_EEGFeatureReset(void);
+bool UDP_EEGFeaturePut(uint64_t Time, const float *pBandPower);
+const uint8_t* UDP_EEGFeatureRead(uint16_t *pLen);
+void UDP_EEGFeatureRelease(void);
+
+#endif  /* __EEGDATA_FEATURE_H */
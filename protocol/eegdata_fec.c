@@ -0,0 +1,124 @@
+/**
+ * @file    eegdata_fec.c
+ * @author  gjmsilly
+ * @brief   NanoEEG UDP1脑电数据通道XOR前向纠错
+ *
+ *          每连续K个数据帧（按实际发送的字节流，含压缩格式）生成一个校验帧，
+ *          校验帧数据域为K帧逐字节异或（短帧尾部补零），上位机在一组中丢失任意一帧时
+ *          无需重传即可恢复。校验帧只由发送线程（udp1Worker）生成，无需加锁。
+ *          帧格式见 @ref protocol/README.md ，上位机参考恢复函数见 @ref host/eegdata_recover.c
+ * @version 1.0.0
+ * @date    2022-04-02
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "eegdata_fec.h"
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static volatile uint8_t FecKCfg;            //!< 每组数据帧数配置，0-不启用 - 由控制任务修改
+static uint8_t  FecK;                       //!< 当前组数据帧数 - 组开始时锁存
+static uint8_t  FecCnt;                     //!< 当前组已累计数据帧数
+static uint32_t FecNextNum;                 //!< 当前组下一帧应有的UDP包累加滚动码
+static uint16_t FecLenXor;                  //!< 当前组各帧长度异或
+static uint16_t FecMaxLen;                  //!< 当前组最长帧长度
+static uint8_t  FecParityBuff[UDP_FEC_BUFF_SIZE];   //!< 校验帧
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+
+/*!
+    \brief  UDP_EEGFecConfig
+
+    设置每组数据帧数，由控制任务在属性值变化后调用，下一组起生效
+
+    \param  K - 每组数据帧数，0-不启用
+ */
+void UDP_EEGFecConfig(uint8_t K)
+{
+    FecKCfg = K;
+}
+
+/*!
+    \brief  UDP_EEGFecPut
+
+    累计一个已发送的数据帧，由发送线程在发送后调用，一组累计满K帧时返回校验帧。
+    UDP包累加滚动码不连续（环形缓冲区溢出丢帧或重新开始采样）时，
+    放弃当前未满的组，从本帧开始新的一组。
+
+    \param  pBuf       - 已发送的数据帧字节流
+            Len        - 字节数
+            pParityLen - 校验帧字节数（to be returned）
+
+    \return 校验帧，本组未满或未启用时返回NULL
+ */
+const uint8_t* UDP_EEGFecPut(const uint8_t *pBuf, uint16_t Len, uint16_t *pParityLen)
+{
+    UDPHeader_t *pHeader = (UDPHeader_t *)FecParityBuff;
+    uint8_t *pParity = FecParityBuff + UDP_HEADER_SIZE;
+    uint32_t UDPNum;
+    uint16_t i;
+
+    memcpy(&UDPNum, ((const UDPHeader_t*)pBuf)->UDPNum, 4);
+
+    if( FecCnt && (UDPNum != FecNextNum) )
+    {
+        FecCnt = 0; //!< 滚动码不连续，放弃当前组
+    }
+
+    /* 新的一组 */
+    if( FecCnt == 0 )
+    {
+        FecK = FecKCfg;
+        if( FecK < UDP_FEC_K_MIN )
+            return NULL;
+
+        memcpy(&pHeader->DevID, &((const UDPHeader_t*)pBuf)->DevID, 4);
+        memcpy(pHeader->UDPNum, &UDPNum, 4); //!< 本组首帧滚动码
+        FecLenXor = 0;
+        FecMaxLen = 0;
+    }
+
+    if( Len > UDP_DTx_Buff_Size )
+    {
+        FecCnt = 0;
+        return NULL;
+    }
+
+    /* 逐字节异或，超出已累计长度的部分视为与0异或 */
+    if( Len > FecMaxLen )
+    {
+        memset(pParity + FecMaxLen, 0, Len - FecMaxLen);
+        FecMaxLen = Len;
+    }
+    for(i=0; i<Len; i++)
+        pParity[i] ^= pBuf[i];
+
+    FecLenXor ^= Len;
+    FecNextNum = UDPNum + 1;
+
+    if( ++FecCnt < FecK )
+        return NULL;
+
+    /* 一组累计完毕 - 校验帧帧头部 */
+    memcpy(pHeader->UDPSampleNum, &FecLenXor, 2);   //!< 各帧长度异或
+    pHeader->UDP_ChannelNum = FecK;                 //!< 本组数据帧数
+    memset(pHeader->UNIXTimeStamp, 0, 8);
+    pHeader->FrameFmt = UDP_FMT_TYPE_FEC;
+    memset(pHeader->ReservedNum, 0xFF, 3);
+
+    FecCnt = 0;
+    *pParityLen = UDP_HEADER_SIZE + FecMaxLen;
+    return FecParityBuff;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file    eegdata_fec.h
+ * @author  gjmsilly
+ * @brief   NanoEEG UDP1脑电数据通道XOR前向纠错
+ * @version 1.0.0
+ * @date    2022-04-02
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef __EEGDATA_FEC_H
+#define __EEGDATA_FEC_H
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "eegdata_protocol.h"
+
+/*********************************************************************
+ * Macros
+ */
+#define UDP_FEC_K_MIN               2       //!< 每组最少数据帧数
+#define UDP_FEC_K_MAX               16      //!< 每组最多数据帧数
+#define UDP_FEC_BUFF_SIZE           (UDP_HEADER_SIZE + UDP_DTx_Buff_Size)   //!< 校验帧最大字节数
+
+/**********************************************************************
+ * FUNCTIONS
+ */
+void UDP_EEGFecConfig(uint8_t K);
+const uint8_t* UDP_EEGFecPut(const uint8_t *pBuf, uint16_t Len, uint16_t *pParityLen);
+
+#endif  /* __EEGDATA_FEC_H */
@@ -21,18 +21,38 @@
 #include <ti/drivers/net/wifi/slnetifwifi.h>
 
 #include "eegdata_protocol.h"
-#include <service/ads1299.h>
+#include "eegdata_codec.h"
+#include <service/trace.h>
 
 
 /*********************************************************************
  *  LOCAL VARIABLES
  */
 static uint32_t UDPNum;                 //!< UDP包累加滚动码
+static volatile uint8_t EEGDataFmt;     //!< 数据通道可选格式 @ref EEGDATA_OPT_COMPRESS
+static volatile uint32_t EEGChMask = UDP_CHMASK_ALL; //!< 启用的通道掩码
+static uint8_t UDP_DTX_EncBuff[UDP_DTx_Buff_Size]; //!< 压缩帧/稀疏打包帧发送缓冲区 - 仅发送线程使用
+
+/* 内嵌事件 */
+static UDPInlineEvt_t   InlineEvtQ[UDP_EVT_INLINE_QNUM];    //!< 内嵌事件队列
+static volatile uint8_t InlineEvtWrIdx;                     //!< 写索引（自由计数）- 仅由同步线程修改
+static volatile uint8_t InlineEvtRdIdx;                     //!< 读索引（自由计数）- 仅由采样线程修改
+static volatile bool    InlineEvtEnable;                    //!< 接受内嵌事件 - 采样且产生脑电数据帧期间，仅由控制线程修改
+static volatile bool    InlineEvtFlushReq;                  //!< 待丢弃上次采样遗留的事件 - 由采样线程封包时处理
+static volatile uint8_t InlineEvtFlushIdx;                  //!< 上次采样遗留事件的结束位置（开始采样时的写索引）
+static uint64_t         SampleTime[2][UDP_SAMPLENUM_MAX];   //!< 当前帧及前一帧各样本的64位时间
+static uint8_t          SampleTimeNum[2];                   //!< 当前帧及前一帧的样本数，0表示无
+static uint8_t          SampleTimeCur;                      //!< 当前帧所用的SampleTime下标
 
 /*********************************************************************
  *  GLOBAL VARIABLES
  */
-UDPDtFrame_t UDP_DTX_Buff;                //!< UDP发送缓冲区
+UDPDtRing_t UDP_DTX_Ring;               //!< UDP发送环形缓冲区
+
+/*********************************************************************
+ *  EXTERNAL VARIABLES
+ */
+extern SampleTime_t *pSampleTime;
 
 /*********************************************************************
  *  LOCAL FUNCTIONS
@@ -42,91 +62,483 @@ UDPDtFrame_t UDP_DTX_Buff;                //!< UDP发送缓冲区
     \brief  UDP_DataFrameHeaderGet
 
     脑电数据通道 数据帧头部静态变量获取
-    只在第一次帧头封包时调用本函数,帧头部的静态变量在采集过程中不需要更新。
+    帧头部的静态变量在采集过程中不需要更新，但环形缓冲区各帧槽的帧头相互独立，
+    每个帧槽封包时均需调用本函数。
+
+    \param  pFrame    - 待封包的帧槽
+            SampleNum - 本包样本数
  */
-static void UDP_DataFrameHeaderGet()
+static void UDP_DataFrameHeaderGet(UDPDtFrame_t *pFrame, uint8_t SampleNum)
 {
 
     extern SlDeviceVersion_t ver;
 
     /* 设备ID */
-    UDP_DTX_Buff.sampleheader.DevID = ver.ChipId;
+    pFrame->sampleheader.DevID = ver.ChipId;
 
     /* 本UDP包总样本数 */
-    UDP_DTX_Buff.sampleheader.UDPSampleNum[0] = UDP_SAMPLENUM;
+    pFrame->sampleheader.UDPSampleNum[0] = SampleNum;
+    pFrame->sampleheader.UDPSampleNum[1] = 0;
 
     /* 本UDO包有效通道总数 */
-    UDP_DTX_Buff.sampleheader.UDP_ChannelNum = CHANNEL_NUM;
+    pFrame->sampleheader.UDP_ChannelNum = CHANNEL_NUM;
+
+    /* 帧格式 */
+    pFrame->sampleheader.FrameFmt = UDP_FMT_TYPE_EEG;
 
     /* 保留数 */
-    memset((uint8_t*)(UDP_DTX_Buff.sampleheader.ReservedNum),0xFF,4);
+    memset((uint8_t*)(pFrame->sampleheader.ReservedNum),0xFF,3);
 
 }
 
+/*!
+    \brief  UDP_EEGEventEmbed
+
+    将时间落在本帧最后一个样本周期之前的内嵌事件写为帧尾事件记录：
+    样本序号为不晚于事件的最近一个样本相对本帧首样本的序号（事件先于本帧时为负，
+    指向之前的帧），样本内偏移为事件距该样本nDRDY时刻的us数。
+    晚于本帧的事件留待下一帧。
+
+    \param  pFrame    - 待封包的帧槽
+            SampleNum - 本包样本数
+
+    \return 帧尾事件记录字节数，无事件时为0
+ */
+static uint8_t UDP_EEGEventEmbed(UDPDtFrame_t *pFrame, uint8_t SampleNum)
+{
+    const uint64_t *pCur = SampleTime[SampleTimeCur];
+    const uint64_t *pPrev = SampleTime[SampleTimeCur ^ 1];
+    uint8_t PrevNum = SampleTimeNum[SampleTimeCur ^ 1];
+    uint8_t *pRecord = (uint8_t*)pFrame + UDP_FRAME_SIZE(SampleNum);
+    const UDPInlineEvt_t *pEvt;
+    uint64_t Period, Base, k;
+    uint16_t Offset;
+    int16_t Index;
+    uint8_t EvtNum = 0, i;
+
+    /* 采样周期 */
+    if( SampleNum >= 2 )
+        Period = (pCur[SampleNum-1] - pCur[0]) / (SampleNum - 1);
+    else if( PrevNum )
+        Period = pCur[0] - pPrev[PrevNum-1];
+    else
+        Period = 0;
+
+    /* 上次采样遗留的事件按旧的系统时间计时，丢弃，否则阻塞其后的事件 */
+    if( InlineEvtFlushReq )
+    {
+        InlineEvtFlushReq = false;
+        if( (uint8_t)(InlineEvtFlushIdx - InlineEvtRdIdx) <= (uint8_t)(InlineEvtWrIdx - InlineEvtRdIdx) )
+            InlineEvtRdIdx = InlineEvtFlushIdx;
+    }
+
+    while( (InlineEvtRdIdx != InlineEvtWrIdx) && (EvtNum < UDP_EVT_INLINE_MAX) )
+    {
+        pEvt = &InlineEvtQ[InlineEvtRdIdx & (UDP_EVT_INLINE_QNUM - 1)];
+
+        if( pEvt->Time >= pCur[SampleNum-1] + Period )
+            break; //!< 晚于本帧
+
+        if( pEvt->Time >= pCur[0] )
+        {
+            for(i=SampleNum-1; pCur[i] > pEvt->Time; i--);
+            Index = i;
+            Base = pCur[i];
+        }
+        else if( PrevNum && (pEvt->Time >= pPrev[0]) )
+        {
+            for(i=PrevNum-1; pPrev[i] > pEvt->Time; i--);
+            Index = (int16_t)i - PrevNum;
+            Base = pPrev[i];
+        }
+        else
+        {
+            /* 早于已保存的样本，按采样周期外推 */
+            Index = PrevNum ? -(int16_t)PrevNum : 0;
+            Base = PrevNum ? pPrev[0] : pCur[0];
+            k = Period ? (Base - pEvt->Time + Period - 1) / Period : 0;
+            Index -= (int16_t)k;
+            Base -= k * Period;
+        }
+
+        k = (pEvt->Time > Base) ? (pEvt->Time - Base) / SAMPLE_TICK_PER_US : 0;
+        Offset = (k > 0xFFFF) ? 0xFFFF : (uint16_t)k;
+
+        memcpy(pRecord, &Index, 2);
+        memcpy(pRecord + 2, &Offset, 2);
+        pRecord[4] = pEvt->Type;
+        pRecord += UDP_EVT_RECORD_SIZE;
+
+        EvtNum++;
+        InlineEvtRdIdx++; //!< 出队
+    }
+
+    if( EvtNum == 0 )
+        return 0;
+
+    *pRecord = EvtNum; //!< 帧尾最后一字节为事件数
+    pFrame->sampleheader.FrameFmt |= UDP_FMT_EVENTS;
+
+    return EvtNum * UDP_EVT_RECORD_SIZE + 1;
+}
+
 /*********************************************************************
  *  FUNCTIONS
  */
 
 /*!
-    \brief UDP_DataGet 
-    
-    脑电数据通道 数据帧数据域 量化通道值获取，调用本函数获取一个样本，
-    并按照指定样本序号将量化通道值填充至UDP数据帧数据域指定位置。
+    \brief UDP_EEGDataPut
+
+    脑电数据通道 数据帧数据域填充，调用本函数写入一个样本，
+    按照指定样本序号将样本时间戳及量化通道值填充至环形缓冲区当前采集帧槽的指定位置。
 
     \param  SampleIndex - 样本序号
-            Processflag - EEG数据采集状态标志
+            Time        - 样本时间（64位系统时间），帧中写入其10us单位的低32位
+            pChannelVal - 样本通道状态+量化值
 
-    \return true - 读取AD数据成功
- *          false - 异常
+    \return void
  */
-bool UDP_EEGDataGet(uint8_t SampleIndex)
+void UDP_EEGDataPut(uint8_t SampleIndex, uint64_t Time, const uint8_t *pChannelVal)
 {
-    ADS1299_ReadResult((uint8_t *)&(UDP_DTX_Buff.sampledata[SampleIndex].ChannelVal[0]));  //!< 样本每通道量化值
-    //ADS1299_ReadResult((uint8_t *)&(UDP_DTx_Buff[28*SampleIndex])); //for debug
-    return true;
+    UDPData_t *pSample = &UDP_DTX_Ring.Frame[UDP_DTX_Ring.WrIdx].sampledata[SampleIndex];
+    uint32_t Timestamp = SAMPLE_TICK_TO_10US(Time);
+
+    SampleTime[SampleTimeCur][SampleIndex] = Time; //!< 供内嵌事件定位样本
+
+    pSample->FrameHeader = UDP_SAMPLE_FH;                               //!< 样本起始分隔符
+    pSample->Index[0] = SampleIndex;                                    //!< 样本序号 - 低8位，序数从0开始
+    pSample->Index[1] = 0;
+    memcpy((uint8_t*)&(pSample->Timestamp[0]),(uint8_t*)&Timestamp,4);  //!< 每样增量时间戳
+    memcpy(pSample->ChannelVal,pChannelVal,UDP_SampleValSize);          //!< 样本每通道量化值
 }
 
 /*!
     \brief  UDP_DataProcess 
     
-    脑电数据通道 数据帧封包处理，本函数在一包EEG样本获取完毕后调用，
-    本函数负责处理数据域封包和帧头部封包。
+    脑电数据通道 数据帧封包处理，本函数在一包EEG样本经UDP_EEGDataPut写入完毕后调用，
+    本函数负责处理帧头部封包，启用内嵌事件时写入帧尾事件记录，并将封包完毕的帧槽提交给发送线程。
+
+    若下一帧槽仍待发送（发送跟不上采集），本帧被丢弃并记入溢出计数，
+    写索引不前移，下一包继续写入本帧槽；UDP包累加滚动码照常累加，
+    上位机可据此发现丢包。
 
-    \param  pSampleTime  -  EEG样本时间戳定时器对象，该对象应提供一包
-                            数据帧中各个样本的精密时间戳
+    \param  SampleNum    -   本包样本数，帧长度随之确定
             reSampleFlag -   本次采样前发生过采样停止
+            LossFlag     -   自上一帧最后一个样本起检测到样本丢失，帧头部FrameFmt置位UDP_FMT_SAMPLE_LOSS
 
-    \return success - UDP打包数据完毕
-            false - 异常
+    \return true - UDP打包数据完毕，帧槽已提交发送
+            false - 环形缓冲区溢出，本帧被丢弃
  */
-bool UDP_EEGDataProcess(SampleTime_t *pSampleTime,bool reSampleFlag)
+bool UDP_EEGDataProcess(uint8_t SampleNum, bool reSampleFlag, bool LossFlag)
 {
-    uint8_t Index;
-
-    /* 数据域封包 */
-    for(Index=0; Index<UDP_SAMPLENUM; Index++)
-    {
-        UDP_DTX_Buff.sampledata[Index].FrameHeader = UDP_SAMPLE_FH;      //!< 样本起始分隔符
-        UDP_DTX_Buff.sampledata[Index].Index[0] = Index;                 //!< 样本序号 - 低8位，序数从0开始
-        memcpy((uint8_t*)&(UDP_DTX_Buff.sampledata[Index].Timestamp[0]),\
-               (uint8_t*)&(pSampleTime->CurTimeStamp[Index]),4);        //!< 每样增量时间戳
-    }
+    uint8_t NextIdx;
+    UDPDtFrame_t *pFrame = &UDP_DTX_Ring.Frame[UDP_DTX_Ring.WrIdx];
 
      /* 帧头部封包 */
+     UDP_DataFrameHeaderGet(pFrame, SampleNum);
+     if( LossFlag )
+         pFrame->sampleheader.FrameFmt |= UDP_FMT_SAMPLE_LOSS;
+     UDP_DTX_Ring.FrameLen[UDP_DTX_Ring.WrIdx] = UDP_FRAME_SIZE(SampleNum);
 
-     //!< 发生过EEG暂停采集或第一次UDP帧头封包
-     if( reSampleFlag ||  (UDPNum==0) )
+     //!< 发生过EEG暂停采集
+     if( reSampleFlag )
      {
-        UDP_DataFrameHeaderGet(); //!< 重新获取UDP帧头数据
         UDPNum = 0; //!< UDP包累加滚动码重新计数
+        SampleTimeNum[SampleTimeCur ^ 1] = 0; //!< 前一帧属于上次采样
      }
 
+     /* 帧尾事件记录 - 本帧将被丢弃时留待下一帧 */
+     NextIdx = (UDP_DTX_Ring.WrIdx + 1) & (UDP_RING_SLOTNUM - 1);
+     if( NextIdx != UDP_DTX_Ring.RdIdx )
+         UDP_DTX_Ring.FrameLen[UDP_DTX_Ring.WrIdx] += UDP_EEGEventEmbed(pFrame, SampleNum);
+
+     SampleTimeNum[SampleTimeCur] = SampleNum;
+     SampleTimeCur ^= 1;
+
      /* UDP包累加滚动码 */
-     memcpy((uint8_t *)&(UDP_DTX_Buff.sampleheader.UDPNum),(uint8_t *)&UDPNum,4); //!< UDP包累加滚动码,也即UDP帧头封包执行次数
+     memcpy((uint8_t *)&(pFrame->sampleheader.UDPNum),(uint8_t *)&UDPNum,4); //!< UDP包累加滚动码,也即UDP帧头封包执行次数
      UDPNum++;
 
+     /* 提交帧槽 */
+     if( NextIdx == UDP_DTX_Ring.RdIdx )
+     {
+         UDP_DTX_Ring.OverrunCnt++; //!< 发送线程未释放下一帧槽，丢弃本帧
+         Trace_Put(TRACE_PACKET_READY, 0, (uint16_t)(UDPNum - 1)); //!< 本帧滚动码
+         return false;
+     }
+     UDP_DTX_Ring.ReadyTime[UDP_DTX_Ring.WrIdx] = SampleTimestamp_Get(pSampleTime);
+     UDP_DTX_Ring.WrIdx = NextIdx;
+     Trace_Put(TRACE_PACKET_READY, 1, (uint16_t)(UDPNum - 1));
+
      return true;
 }
 
+/*!
+    \brief  UDP_EEGRingRead
+
+    获取环形缓冲区中最早一帧待发送的帧槽，由发送线程在等到
+    UDPEEGDataReady信号量后调用，发送完毕后须调用UDP_EEGRingRelease释放。
+
+    \param  pLen - 帧槽有效字节数（to be returned）
+
+    \return 待发送帧槽，环形缓冲区为空则返回NULL
+ */
+UDPDtFrame_t* UDP_EEGRingRead(uint16_t *pLen)
+{
+    if( UDP_DTX_Ring.RdIdx == UDP_DTX_Ring.WrIdx )
+        return NULL; //!< 信号量由重传请求释放，或本帧已随前一次唤醒发送
+    *pLen = UDP_DTX_Ring.FrameLen[UDP_DTX_Ring.RdIdx];
+    return &UDP_DTX_Ring.Frame[UDP_DTX_Ring.RdIdx];
+}
+
+/*!
+    \brief  UDP_EEGRingReadyTime
+
+    \return 发送中帧槽（UDP_EEGRingRead所得）的封包完毕时刻，用于统计发送时延
+ */
+uint64_t UDP_EEGRingReadyTime(void)
+{
+    return UDP_DTX_Ring.ReadyTime[UDP_DTX_Ring.RdIdx];
+}
+
+/*!
+    \brief  UDP_EEGRingRelease
+
+    释放已发送完毕的帧槽，供采集线程继续写入。
+ */
+void UDP_EEGRingRelease(void)
+{
+    UDP_DTX_Ring.RdIdx = (UDP_DTX_Ring.RdIdx + 1) & (UDP_RING_SLOTNUM - 1);
+}
+
+/*!
+    \brief  UDP_EEGChMaskCount
+
+    \param  ChMask - 通道掩码
+
+    \return 启用的通道数
+ */
+static uint8_t UDP_EEGChMaskCount(uint32_t ChMask)
+{
+    uint8_t Num;
+
+    for(Num=0; ChMask; ChMask &= ChMask - 1)
+        Num++;
+
+    return Num;
+}
+
+/*!
+    \brief  UDP_EEGDataPack
+
+    稀疏打包：帧头部后写入通道掩码，每个样本只保留含启用通道的通道组状态及启用通道的量化值。
+
+    \param  pFrame    - 待发送帧槽
+            SampleNum - 本帧样本数
+            ChMask    - 启用的通道掩码
+            pOut      - 输出缓冲区
+
+    \return 打包后字节数（不含帧尾事件记录）
+ */
+static uint16_t UDP_EEGDataPack(const UDPDtFrame_t *pFrame, uint8_t SampleNum,
+                                uint32_t ChMask, uint8_t *pOut)
+{
+    const uint8_t *pGroup;
+    uint8_t *p = pOut + UDP_HEADER_SIZE + UDP_CHMASK_SIZE;
+    uint8_t GroupMask, Group, Ch, i;
+
+    for(i=0; i<SampleNum; i++)
+    {
+        memcpy(p, &pFrame->sampledata[i], 7); //!< 分隔符 + 样本序号 + 时间戳
+        p += 7;
+
+        for(Group=0; Group<UDP_CHGROUP_NUM; Group++)
+        {
+            GroupMask = (uint8_t)(ChMask >> (Group*8));
+            if( !GroupMask )
+                continue;
+
+            pGroup = &pFrame->sampledata[i].ChannelVal[Group*UDP_CHGROUP_SIZE];
+            memcpy(p, pGroup, 3); //!< 本组通道状态
+            p += 3;
+
+            for(Ch=0; Ch<8; Ch++)
+            {
+                if( GroupMask & (1 << Ch) )
+                {
+                    memcpy(p, pGroup + 3 + Ch*3, 3);
+                    p += 3;
+                }
+            }
+        }
+    }
+
+    return (uint16_t)(p - pOut);
+}
+
+/*!
+    \brief  UDP_EEGDataSerialize
+
+    按照当前数据通道可选格式生成待发送字节流，由发送线程在发送前调用。
+    未启用可选格式或压缩无收益时直接返回原始帧槽。帧尾事件记录不压缩，原样接在码流之后。
+    部分通道未启用时帧头部后附通道掩码，数据域仅含启用的通道（压缩帧同样只编码启用的通道）。
+
+    \param  pFrame - 待发送帧槽
+            pLen   - 输入帧槽有效字节数，输出待发送字节数
+
+    \return 待发送字节流
+ */
+const uint8_t* UDP_EEGDataSerialize(const UDPDtFrame_t *pFrame, uint16_t *pLen)
+{
+    uint8_t SampleNum = pFrame->sampleheader.UDPSampleNum[0];
+    uint16_t TrailerLen = *pLen - UDP_FRAME_SIZE(SampleNum);
+    const uint8_t *pTrailer = (const uint8_t*)pFrame + UDP_FRAME_SIZE(SampleNum);
+    uint32_t ChMask = EEGChMask;
+    uint16_t RawLen, EncLen;
+    UDPHeader_t *pHeader = (UDPHeader_t*)UDP_DTX_EncBuff;
+
+    /* 原始帧（或稀疏打包帧）长度，压缩帧必须短于该长度 */
+    if( ChMask == UDP_CHMASK_ALL )
+        RawLen = UDP_FRAME_SIZE(SampleNum);
+    else
+        RawLen = UDP_HEADER_SIZE + UDP_CHMASK_SIZE + SampleNum * UDP_EEGChMaskSampleSize(ChMask);
+
+    if( EEGDataFmt & EEGDATA_OPT_COMPRESS )
+    {
+        EncLen = EEG_CodecEncode(pFrame, SampleNum, ChMask, UDP_DTX_EncBuff,
+                                 RawLen - 1);
+        if( EncLen )
+        {
+            memcpy(UDP_DTX_EncBuff + EncLen, pTrailer, TrailerLen);
+            *pLen = EncLen + TrailerLen;
+            return UDP_DTX_EncBuff;
+        }
+    }
 
+    if( ChMask == UDP_CHMASK_ALL )
+        return (const uint8_t*)pFrame;
 
+    /* 稀疏打包 */
+    memcpy(pHeader, &pFrame->sampleheader, UDP_HEADER_SIZE);
+    pHeader->FrameFmt |= UDP_FMT_CHMASK;
+    pHeader->UDP_ChannelNum = UDP_EEGChMaskCount(ChMask); //!< 有效通道总数
+    memcpy(UDP_DTX_EncBuff + UDP_HEADER_SIZE, &ChMask, UDP_CHMASK_SIZE);
+
+    RawLen = UDP_EEGDataPack(pFrame, SampleNum, ChMask, UDP_DTX_EncBuff);
+    memcpy(UDP_DTX_EncBuff + RawLen, pTrailer, TrailerLen);
+    *pLen = RawLen + TrailerLen;
+
+    return UDP_DTX_EncBuff;
+}
+
+/*!
+    \brief  UDP_EEGDataFmtSet
+
+    设置数据通道可选格式，由控制任务在属性值变化后调用，下一帧起生效。
+    每帧的实际格式由帧头部FrameFmt标识，上位机逐帧解析。
+
+    \param  Fmt - 可选格式 @ref EEGDATA_OPT_COMPRESS
+ */
+void UDP_EEGDataFmtSet(uint8_t Fmt)
+{
+    EEGDataFmt = Fmt & EEGDATA_OPT_MASK;
+}
+
+/*!
+    \brief  UDP_EEGChMaskSet
+
+    设置启用的通道掩码，由控制任务在通道属性变化后调用（仅停止采样时可修改），下一帧起生效。
+    全部通道启用时数据帧格式不变；否则帧头部FrameFmt置位UDP_FMT_CHMASK，
+    帧头部后附通道掩码，数据域仅含启用的通道。
+
+    \param  ChMask - 启用的通道掩码，bit n对应通道n
+ */
+void UDP_EEGChMaskSet(uint32_t ChMask)
+{
+    ChMask &= UDP_CHMASK_ALL;
+    EEGChMask = ChMask ? ChMask : UDP_CHMASK_ALL; //!< 全部关闭时按全部启用发送，保持帧格式有效
+}
+
+/*!
+    \brief  UDP_EEGChMaskGet
+
+    \return 启用的通道掩码，bit n对应通道n（全部关闭时为全部启用）
+ */
+uint32_t UDP_EEGChMaskGet(void)
+{
+    return EEGChMask;
+}
+
+/*!
+    \brief  UDP_EEGChMaskSampleSize
+
+    \param  ChMask - 启用的通道掩码
+
+    \return 稀疏打包后每样本字节数 = 数据域头部7 + 含启用通道的通道组数 x 状态3 + 启用通道数 x 3
+ */
+uint16_t UDP_EEGChMaskSampleSize(uint32_t ChMask)
+{
+    uint16_t Size = 7;
+    uint8_t Group;
+
+    for(Group=0; Group<UDP_CHGROUP_NUM; Group++)
+    {
+        if( (uint8_t)(ChMask >> (Group*8)) )
+            Size += 3;
+    }
+
+    return Size + UDP_EEGChMaskCount(ChMask) * 3;
+}
+
+/*!
+    \brief  UDP_EEGEventReset
+
+    内嵌事件队列启停，由控制线程在开始及停止采样时调用。
+
+    停止采样（Enable为false）时不再接受内嵌事件，队列中剩余事件随最后几帧发送；
+    开始采样时请求丢弃上次采样遗留的事件（由采样线程封包本次第一帧时丢弃，不与其并发修改读索引），
+    Enable为本次采样是否产生脑电数据帧：仅发送频带功率特征时不接受，事件经事件标签通道发送。
+
+    \param  Enable - true 接受内嵌事件
+ */
+void UDP_EEGEventReset(bool Enable)
+{
+    InlineEvtEnable = false;
+    if( Enable )
+    {
+        InlineEvtFlushIdx = InlineEvtWrIdx;
+        InlineEvtFlushReq = true;
+        InlineEvtEnable = true;
+    }
+}
+
+/*!
+    \brief  UDP_EEGEventPut
+
+    事件标签写入内嵌事件队列，由同步线程调用，不阻塞。
+    未启用内嵌事件、本次采样不产生脑电数据帧或队列已满时返回false，
+    由调用者改经事件标签通道发送，事件不丢弃。
+
+    \param  Time - 事件时间（64位系统时间，已扣除外触发延迟）
+            Type - 标签类型
+
+    \return true - 已入队，随脑电数据帧发送
+            false - 未入队
+ */
+bool UDP_EEGEventPut(uint64_t Time, uint8_t Type)
+{
+    UDPInlineEvt_t *pEvt;
+
+    if( !InlineEvtEnable || !(EEGDataFmt & EEGDATA_OPT_EVENTS) )
+        return false;
+
+    if( (uint8_t)(InlineEvtWrIdx - InlineEvtRdIdx) >= UDP_EVT_INLINE_QNUM )
+        return false;
+
+    pEvt = &InlineEvtQ[InlineEvtWrIdx & (UDP_EVT_INLINE_QNUM - 1)];
+    pEvt->Time = Time;
+    pEvt->Type = Type;
+    InlineEvtWrIdx++; //!< 发布
+
+    return true;
+}
@@ -6,6 +6,7 @@
  */
 #include <string.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <service/timestamp.h>
 
 /*********************************************************************
@@ -13,30 +14,58 @@
  */
 /* 脑电数据通道参数*/
 #define UDP_SAMPLE_FH               0x23    //!< UDP帧数据域 样起始分隔符
-#define UDP_SAMPLENUM               10      //!< UDP每包含样本数
+#define UDP_SAMPLENUM_DEFAULT       10      //!< UDP每包含样本数默认值（属性SAMPLE_NUM可修改）
+#define UDP_RING_SLOTNUM            8       //!< 发送环形缓冲区帧槽数（须为2的幂）
 
 // 发送缓冲区参数
 #ifdef Dev_Ch32
-#define UDP_DTx_Buff_Size           1173    //!< 数据帧头部23 + 样本数10 x（数据域头部7 + (本组通道状态3 + 八通道8 x 每通道量化字节数3）x 通道组数4)字节
 #define UDP_SampleValSize           108     //!< 通道组数4 - 108字节状态+量化值
 #define CHANNEL_NUM                 32      //!< 通道数量  （x8/x16/x24/x32）
 #endif
 #ifdef Dev_Ch24
-#define UDP_DTx_Buff_Size           903     //!< 数据帧头部23 + 样本数10 x（数据域头部7 + (本组通道状态3 + 八通道8 x 每通道量化字节数3）x 通道组数3)字节
 #define UDP_SampleValSize           81      //!< 通道组数3 - 81字节状态+量化值
 #define CHANNEL_NUM                 24      //!< 通道数量  （x8/x16/x24/x32）
 #endif
 #ifdef Dev_Ch16
-#define UDP_DTx_Buff_Size           633     //!< 数据帧头部23 + 样本数10 x（数据域头部7 + (本组通道状态3 + 八通道8 x 每通道量化字节数3）x 通道组数2)字节
 #define UDP_SampleValSize           54      //!< 通道组数2 - 51字节状态+量化值
 #define CHANNEL_NUM                 16      //!< 通道数量  （x8/x16/x24/x32）
 #endif
 #ifdef Dev_Ch8
-#define UDP_DTx_Buff_Size           363     //!< 数据帧头部23 + 样本数10 x（数据域头部7 + (本组通道状态3 + 八通道8 x 每通道量化字节数3）x 通道组数1)字节
 #define UDP_SampleValSize           27      //!< 通道组数1 - 27字节状态+量化值
 #define CHANNEL_NUM                 8      //!< 通道数量  （x8/x16/x24/x32）
 #endif
 
+// 数据帧尺寸
+#define UDP_PAYLOAD_MAX             1472    //!< UDP最大载荷 = 以太网MTU1500 - IP头部20 - UDP头部8，超出则IP分片
+#define UDP_HEADER_SIZE             23      //!< 数据帧头部字节数
+#define UDP_SAMPLE_SIZE             (7 + UDP_SampleValSize) //!< 每样本字节数 = 数据域头部7 + 状态+量化值
+#define UDP_EVT_INLINE_MAX          4       //!< 单帧内嵌事件记录最大数
+#define UDP_EVT_RECORD_SIZE         5       //!< 内嵌事件记录字节数 = 样本序号2 + 样本内偏移2 + 标签类型1
+#define UDP_EVT_TRAILER_MAX         (UDP_EVT_INLINE_MAX * UDP_EVT_RECORD_SIZE + 1) //!< 帧尾事件记录最大字节数（含事件数）
+#define UDP_SAMPLENUM_MAX           ((UDP_PAYLOAD_MAX - 2 * UDP_HEADER_SIZE - UDP_EVT_TRAILER_MAX) / UDP_SAMPLE_SIZE) //!< 单包最大样本数，为校验帧头部及帧尾事件记录留出空间（x8:41 x16:23 x24:15 x32:12）
+#define UDP_FRAME_SIZE(n)           (UDP_HEADER_SIZE + (n) * UDP_SAMPLE_SIZE) //!< 含n个样本的数据帧字节数（不含帧尾事件记录）
+#define UDP_DTx_Buff_Size           (UDP_FRAME_SIZE(UDP_SAMPLENUM_MAX) + UDP_EVT_TRAILER_MAX) //!< 发送缓冲区（帧槽）大小
+#define UDP_EVT_INLINE_QNUM         16      //!< 内嵌事件队列容量（须为2的幂）
+#define UDP_CHGROUP_SIZE            27      //!< 每通道组字节数 = 本组通道状态3 + 八通道8 x 每通道量化字节数3
+#define UDP_CHGROUP_NUM             (UDP_SampleValSize / UDP_CHGROUP_SIZE)  //!< 通道组数
+#define UDP_CHMASK_SIZE             4       //!< 通道掩码字节数（bit n对应通道n）
+#define UDP_CHMASK_ALL              ((uint32_t)(((uint64_t)1 << CHANNEL_NUM) - 1)) //!< 全部通道启用
+
+// 数据帧格式 @ref UDPHeader_t.FrameFmt
+#define UDP_FMT_TYPE_MASK           0x0F    //!< 低4位 帧类型
+#define UDP_FMT_TYPE_EEG            0x00    //!< 帧类型 - 脑电数据帧
+#define UDP_FMT_TYPE_FEC            0x01    //!< 帧类型 - 前向纠错校验帧 @ref protocol/eegdata_fec
+#define UDP_FMT_TYPE_BANDPOWER      0x02    //!< 帧类型 - 频带功率特征帧 @ref protocol/eegdata_feature
+#define UDP_FMT_COMPRESSED          0x10    //!< 数据域经无损压缩 @ref protocol/eegdata_codec
+#define UDP_FMT_EVENTS              0x20    //!< 帧尾附带事件记录
+#define UDP_FMT_CHMASK              0x40    //!< 帧头部后附通道掩码，数据域仅含启用的通道
+#define UDP_FMT_SAMPLE_LOSS         0x80    //!< 本帧样本之前或之间有样本丢失（采集不连续）
+
+// 数据通道可选格式 @ref 属性 EEGDATA_FMT，对应帧头部FrameFmt高4位
+#define EEGDATA_OPT_COMPRESS        0x01    //!< 无损压缩
+#define EEGDATA_OPT_EVENTS          0x02    //!< 事件标签内嵌于脑电数据帧
+#define EEGDATA_OPT_MASK            (EEGDATA_OPT_COMPRESS | EEGDATA_OPT_EVENTS) //!< 本版本支持的可选格式
+
 /*******************************************************************
  * TYPEDEFS
  */
@@ -56,7 +85,8 @@
      uint8_t  UDPSampleNum[2];      //!< 本UDP包总样数
      uint8_t  UDP_ChannelNum;       //!< 本UDP包有效通道总数
      uint8_t  UNIXTimeStamp[8];     //!< Unix时间戳（未用）
-     uint8_t  ReservedNum[4];       //!< 保留数
+     uint8_t  FrameFmt;             //!< 帧格式 - 低4位帧类型 高4位可选格式标志
+     uint8_t  ReservedNum[3];       //!< 保留数
 } UDPHeader_t;
 
 /*!
@@ -87,16 +117,55 @@ typedef //union
        UDPHeader_t  sampleheader;
 
        /* 数据帧数据域 */
-       UDPData_t    sampledata[UDP_SAMPLENUM];
+       UDPData_t    sampledata[UDP_SAMPLENUM_MAX];  //!< 实际样本数见帧头UDPSampleNum
+
+       /* 帧尾事件记录 - 紧接最后一个样本写入，此处仅为样本数最大时预留空间 */
+       uint8_t      evttrailer[UDP_EVT_TRAILER_MAX];
 
    //} UDPframe;
 } UDPDtFrame_t;
 
+/*!
+    \brief    内嵌事件 - 由同步线程写入内嵌事件队列，封包时转为帧尾事件记录
+ */
+typedef struct
+{
+    uint64_t    Time;               //!< 事件时间（64位系统时间，已扣除外触发延迟）
+    uint8_t     Type;               //!< 标签类型
+} UDPInlineEvt_t;
+
+/*!
+    \brief    UDP脑电数据通道发送环形缓冲区
+              单生产者（SampleTask）单消费者（udp1Worker）无锁环形缓冲区，
+              写索引只由生产者修改，读索引只由消费者修改。
+              写索引所指帧槽为采集中的帧，读索引所指帧槽为发送中的帧，
+              两者不重叠，采集不会覆盖正在发送的帧。
+ */
+typedef struct
+{
+    UDPDtFrame_t        Frame[UDP_RING_SLOTNUM];    //!< 帧槽
+    volatile uint8_t    WrIdx;                      //!< 写索引 - 当前采集帧槽
+    volatile uint8_t    RdIdx;                      //!< 读索引 - 当前发送帧槽
+    uint16_t            FrameLen[UDP_RING_SLOTNUM]; //!< 各帧槽有效字节数
+    uint64_t            ReadyTime[UDP_RING_SLOTNUM];//!< 各帧槽封包完毕时刻（64位系统时间）
+    volatile uint32_t   OverrunCnt;                 //!< 溢出计数 - 发送跟不上采集时丢弃的帧数
+} UDPDtRing_t;
+
 /**********************************************************************
  * FUNCTIONS
  */
 
-bool UDP_EEGDataGet(uint8_t SampleIndex);
-bool UDP_EEGDataProcess(SampleTime_t *pSampleTime,bool error);
+void UDP_EEGDataPut(uint8_t SampleIndex, uint64_t Time, const uint8_t *pChannelVal);
+bool UDP_EEGDataProcess(uint8_t SampleNum, bool reSampleFlag, bool LossFlag);
+UDPDtFrame_t* UDP_EEGRingRead(uint16_t *pLen);
+void UDP_EEGRingRelease(void);
+uint64_t UDP_EEGRingReadyTime(void);
+const uint8_t* UDP_EEGDataSerialize(const UDPDtFrame_t *pFrame, uint16_t *pLen);
+void UDP_EEGDataFmtSet(uint8_t Fmt);
+void UDP_EEGChMaskSet(uint32_t ChMask);
+uint32_t UDP_EEGChMaskGet(void);
+uint16_t UDP_EEGChMaskSampleSize(uint32_t ChMask);
+void UDP_EEGEventReset(bool Enable);
+bool UDP_EEGEventPut(uint64_t Time, uint8_t Type);
 
 #endif  /* __EEGDATA_PROTOCOL_H */
@@ -1,7 +1,11 @@
 /**
- * @file    eegdata_protocol.c
+ * @file    evtdata_protocol.c
  * @author  gjmsilly
- * @brief   NanoEEG UDP1脑电数据通道协议
+ * @brief   NanoEEG UDP2事件标签通道协议
+ *
+ *          同步线程（SyncTask）将事件标签写入事件队列，发送线程（udp2Worker）
+ *          每次被唤醒取出队列中全部事件（至多UDP_EVT_BATCH_MAX个）封为一帧发送。
+ *          队列为单生产者单消费者环形缓冲区，队列满时同步线程阻塞等待，事件不丢弃。
  * @version 1.0.0
  * @date    2020-12-27
  *
@@ -18,6 +22,9 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+/* POSIX Header files */
+#include <semaphore.h>
+
 #include <ti/drivers/net/wifi/slnetifwifi.h>
 #include <ti/display/Display.h>
 
@@ -26,7 +33,20 @@
 /*********************************************************************
  *  GLOBAL VARIABLES
  */
-UDPEvtFrame_t UDP_EvtTX_Buff;                //!< UDP发送缓冲区
+static UDPEvtFrame_t UDP_EvtTX_Buff;         //!< UDP发送缓冲区
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static UDPEvtData_t            EvtQueue[UDP_EVT_QUEUE_NUM];    //!< 事件队列
+static volatile uint8_t     EvtWrIdx;                       //!< 写索引（自由计数）- 仅由同步线程修改
+static volatile uint8_t     EvtRdIdx;                       //!< 读索引（自由计数）- 仅由发送线程修改
+static sem_t                EvtSlotFree;                    //!< 事件队列空闲位置数
+
+/*********************************************************************
+ *  EXTERNAL VARIABLES
+ */
+extern sem_t UDPEvtDataReady;
 
 /*********************************************************************
  *  LOCAL FUNCTIONS
@@ -51,11 +71,68 @@ static void UDP_DataFrameHeaderGet()
 /*********************************************************************
  *  FUNCTIONS
  */
-void UDP_DataProcess(uint32_t RecvTimestamp,uint16_t delay, uint8_t type){
+
+/*!
+    \brief  UDP_EvtQueueInit
+
+    初始化事件队列，须在网络线程及同步线程创建之前调用
+ */
+void UDP_EvtQueueInit(void)
+{
+    EvtWrIdx = 0;
+    EvtRdIdx = 0;
+    sem_init(&EvtSlotFree, 0, UDP_EVT_QUEUE_NUM);
+}
+
+/*!
+    \brief  UDP_EvtDataPut
+
+    事件标签入队并唤醒发送线程，由同步线程调用。队列满时阻塞至发送线程取走事件。
+
+    \param  RecvTimestamp - 事件接收时间戳（10us）
+            delay - 外触发信号延迟时间（10us）
+            type - 标签类型
+ */
+void UDP_EvtDataPut(uint32_t RecvTimestamp, uint16_t delay, uint8_t type)
+{
+    UDPEvtData_t *pEvt;
+
+    sem_wait(&EvtSlotFree); //!< 队列满则等待，不丢弃事件
+
+    pEvt = &EvtQueue[EvtWrIdx & (UDP_EVT_QUEUE_NUM - 1)];
+    pEvt->Timestamp = RecvTimestamp - delay;
+    pEvt->evtType = type;
+    EvtWrIdx++; //!< 发布
+
+    sem_post(&UDPEvtDataReady);
+}
+
+/*!
+    \brief  UDP_EvtFrameGet
+
+    取出队列中的事件封为一帧，由发送线程调用，不阻塞
+
+    \param  pLen - 帧字节数（to be returned）
+
+    \return 待发送的帧，队列为空（事件已由前一帧带走）返回NULL
+ */
+const uint8_t* UDP_EvtFrameGet(uint16_t *pLen)
+{
+    uint8_t EvtNum = 0;
 
     UDP_DataFrameHeaderGet();
 
-    UDP_EvtTX_Buff.Evtdata.evtType = type;
-    UDP_EvtTX_Buff.Evtdata.Timestamp = RecvTimestamp - delay;
+    while( (EvtRdIdx != EvtWrIdx) && (EvtNum < UDP_EVT_BATCH_MAX) )
+    {
+        UDP_EvtTX_Buff.Evtdata[EvtNum++] = EvtQueue[EvtRdIdx & (UDP_EVT_QUEUE_NUM - 1)];
+        EvtRdIdx++;
+        sem_post(&EvtSlotFree);
+    }
+
+    if( EvtNum == 0 )
+        return NULL;
 
+    UDP_EvtTX_Buff.EvtNum = EvtNum;
+    *pLen = UDP_EVT_FRAME_SIZE(EvtNum);
+    return (const uint8_t*)&UDP_EvtTX_Buff;
 }
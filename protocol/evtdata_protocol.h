@@ -6,12 +6,15 @@
  */
 #include <string.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <service/timestamp.h>
 
 /*********************************************************************
  * Macros
  */
-#define UDP_EvtTx_Buff_Size           17     //!< 设备ID(4)+UNIX时间戳(8)+精密时间戳(4)+标签类型(1)
+#define UDP_EVT_QUEUE_NUM           32      //!< 事件队列容量（须为2的幂）
+#define UDP_EVT_BATCH_MAX           32      //!< 单帧最多事件数
+#define UDP_EVT_FRAME_SIZE(n)       (sizeof(UDPEvtHeader_t) + 1 + (n) * sizeof(UDPEvtData_t)) //!< 含n个事件的帧字节数 = 设备ID(4)+UNIX时间戳(8)+事件数(1)+n*(精密时间戳(4)+标签类型(1))
 
 
 /*********************************************************************
@@ -30,7 +33,7 @@
 {
      uint32_t DevID;                //!< 设备ID
      uint8_t  UNIXTimeStamp[8];     //!< Unix时间戳（未用）
-} UDPHeader_t;
+} UDPEvtHeader_t;
 
 /*!
     \brief  UDP事件标签通道 数据帧数据域结构体
@@ -42,7 +45,7 @@ typedef struct
 {
     uint32_t    Timestamp;          //!< 精密时间戳
     uint8_t     evtType;            //!< 事件类型
-}UDPData_t;
+}UDPEvtData_t;
 
 /*!
     \brief    UDP数据通道发送缓冲区 联合体
@@ -51,16 +54,19 @@ typedef struct
 typedef struct
 {
        /* 数据帧头部 */
-       UDPHeader_t  Evtheader;
+       UDPEvtHeader_t  Evtheader;
+       uint8_t      EvtNum;                         //!< 本帧事件数
 
        /* 数据帧数据域 */
-       UDPData_t    Evtdata;
+       UDPEvtData_t    Evtdata[UDP_EVT_BATCH_MAX];     //!< 实际事件数见EvtNum
 
 } UDPEvtFrame_t;
 
 /**********************************************************************
  * FUNCTIONS
  */
-void UDP_DataProcess(uint32_t RecvTimestamp,uint16_t delay, uint8_t type);
+void UDP_EvtQueueInit(void);
+void UDP_EvtDataPut(uint32_t RecvTimestamp, uint16_t delay, uint8_t type);
+const uint8_t* UDP_EvtFrameGet(uint16_t *pLen);
 
 #endif  /* __EVTDATA_PROTOCOL_H */
@@ -0,0 +1,317 @@
+/**
+ * @file    udp_subscriber.c
+ * @author  gjmsilly
+ * @brief   NanoEEG UDP数据通道订阅者表
+ *          订阅者由TCP控制通道连接（tcpHandler）或设备探测握手（DetectTask）添加，
+ *          脑电数据通道与事件标签通道据此单播/组播发送，替代局域网广播。
+ * @version 1.0.0
+ * @date    2022-03-20
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+/* BSD support */
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+/* POSIX Header files */
+#include <pthread.h>
+
+#include <ti/drivers/net/wifi/slnetifwifi.h>
+
+#include "udp_subscriber.h"
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static UDPSubscriber_t  Subscriber[UDP_SUBSCRIBER_NUM]; //!< 订阅者表
+static pthread_mutex_t  SubscriberMutex;                //!< 订阅者表互斥锁 - 多个网络线程访问
+
+static uint8_t          StreamMode = STREAM_UNICAST;            //!< 数据通道发送方式
+static uint32_t         StreamMcastAddr = STREAM_MCAST_DEFAULT; //!< 组播地址（主机字节序）
+
+/*********************************************************************
+ *  LOCAL FUNCTIONS
+ */
+
+/*!
+    \brief  UDP_SubscriberNow
+
+    \return 单调时钟 s，用于探测订阅者过期
+ */
+static uint32_t UDP_SubscriberNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint32_t)ts.tv_sec;
+}
+
+/*!
+    \brief  UDP_SubscriberFind
+
+    查找指定IP地址的订阅者，调用前须持有订阅者表互斥锁
+
+    \param  IPAddr - 订阅者IP地址
+
+    \return 订阅者表项，不存在则返回NULL
+ */
+static UDPSubscriber_t* UDP_SubscriberFind(uint32_t IPAddr)
+{
+    uint8_t i;
+
+    for(i=0; i<UDP_SUBSCRIBER_NUM; i++)
+    {
+        if( Subscriber[i].Valid && (Subscriber[i].IPAddr == IPAddr) )
+            return &Subscriber[i];
+    }
+    return NULL;
+}
+
+/*!
+    \brief  UDP_SubscriberAlloc
+
+    分配空闲表项，表满时替换最近一次探测最早的探测订阅者（有TCP会话的订阅者不被替换），
+    调用前须持有订阅者表互斥锁
+
+    \param  IPAddr - 订阅者IP地址
+
+    \return 已清零的表项，无可用表项则返回NULL
+ */
+static UDPSubscriber_t* UDP_SubscriberAlloc(uint32_t IPAddr)
+{
+    uint8_t i;
+    UDPSubscriber_t *pSub = NULL;
+
+    for(i=0; i<UDP_SUBSCRIBER_NUM; i++)
+    {
+        if( !Subscriber[i].Valid )
+        {
+            pSub = &Subscriber[i];
+            break;
+        }
+
+        if( (Subscriber[i].OwnerNum == 0) &&
+            ((pSub == NULL) || (int32_t)(Subscriber[i].DetectTime - pSub->DetectTime) < 0) )
+            pSub = &Subscriber[i];
+    }
+
+    if( pSub )
+    {
+        memset(pSub, 0, sizeof(UDPSubscriber_t));
+        pSub->IPAddr = IPAddr;
+        pSub->Valid = true;
+    }
+    return pSub;
+}
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+
+/*!
+    \brief  UDP_SubscriberInit
+
+    初始化订阅者表，须在网络线程创建之前调用
+ */
+void UDP_SubscriberInit(void)
+{
+    memset(Subscriber,0,sizeof(Subscriber));
+    pthread_mutex_init(&SubscriberMutex, NULL);
+}
+
+/*!
+    \brief  UDP_SubscriberAdd
+
+    添加订阅者。同一IP地址只保留一项，记录持有该项的各TCP会话及最近一次探测时刻：
+    同IP的多个TCP会话共同持有，最后一个会话结束时移除；探测握手每次刷新探测时刻，
+    未再探测的探测订阅者在开始采样时过期。
+
+    \param  IPAddr - 订阅者IP地址（主机字节序）
+            Owner  - 订阅者来源，TCP会话clientfd 或 UDP_SUBSCRIBER_DETECT
+
+    \return true - 添加成功或已存在
+            false - 订阅者表已满
+ */
+bool UDP_SubscriberAdd(uint32_t IPAddr, int Owner)
+{
+    UDPSubscriber_t *pSub;
+    bool ret = true;
+
+    pthread_mutex_lock(&SubscriberMutex);
+
+    pSub = UDP_SubscriberFind(IPAddr);
+    if( pSub == NULL )
+        pSub = UDP_SubscriberAlloc(IPAddr);
+
+    if( pSub == NULL )
+        ret = false;
+    else if( Owner == UDP_SUBSCRIBER_DETECT )
+    {
+        pSub->Detected = true;
+        pSub->DetectTime = UDP_SubscriberNow();
+    }
+    else if( pSub->OwnerNum < UDP_SUBSCRIBER_OWNER_NUM )
+        pSub->Owner[pSub->OwnerNum++] = Owner;
+
+    pthread_mutex_unlock(&SubscriberMutex);
+
+    return ret;
+}
+
+/*!
+    \brief  UDP_SubscriberRemove
+
+    TCP会话结束，在TCP连接断开时调用：该会话不再持有其订阅者，同IP的探测记录一并清除
+    （上位机已断开，不等过期），没有其他会话持有时移除订阅者
+
+    \param  Owner - TCP会话clientfd
+ */
+void UDP_SubscriberRemove(int Owner)
+{
+    UDPSubscriber_t *pSub;
+    uint8_t i, n;
+
+    pthread_mutex_lock(&SubscriberMutex);
+
+    for(i=0; i<UDP_SUBSCRIBER_NUM; i++)
+    {
+        pSub = &Subscriber[i];
+        if( !pSub->Valid )
+            continue;
+
+        for(n=0; n<pSub->OwnerNum; n++)
+        {
+            if( pSub->Owner[n] == Owner )
+                break;
+        }
+        if( n == pSub->OwnerNum )
+            continue;
+
+        pSub->Owner[n] = pSub->Owner[--pSub->OwnerNum];
+        pSub->Detected = false;
+        if( pSub->OwnerNum == 0 )
+            pSub->Valid = false;
+    }
+
+    pthread_mutex_unlock(&SubscriberMutex);
+}
+
+/*!
+    \brief  UDP_SubscriberAge
+
+    清除超过UDP_SUBSCRIBER_DETECT_TTL未再探测的探测记录，没有TCP会话持有的订阅者随之移除。
+    由控制任务在开始采样时调用，不再向已离开的探测方发送数据。
+ */
+void UDP_SubscriberAge(void)
+{
+    uint32_t Now = UDP_SubscriberNow();
+    UDPSubscriber_t *pSub;
+    uint8_t i;
+
+    pthread_mutex_lock(&SubscriberMutex);
+
+    for(i=0; i<UDP_SUBSCRIBER_NUM; i++)
+    {
+        pSub = &Subscriber[i];
+        if( !pSub->Valid || !pSub->Detected )
+            continue;
+
+        if( Now - pSub->DetectTime > UDP_SUBSCRIBER_DETECT_TTL )
+        {
+            pSub->Detected = false;
+            if( pSub->OwnerNum == 0 )
+                pSub->Valid = false;
+        }
+    }
+
+    pthread_mutex_unlock(&SubscriberMutex);
+}
+
+/*!
+    \brief  UDP_SubscriberConfig
+
+    配置数据通道发送方式，由控制任务在属性值变化后调用
+
+    \param  Mode       - 发送方式 STREAM_BROADCAST/STREAM_UNICAST/STREAM_MULTICAST
+            McastAddr  - 组播地址（主机字节序）
+ */
+void UDP_SubscriberConfig(uint8_t Mode, uint32_t McastAddr)
+{
+    pthread_mutex_lock(&SubscriberMutex);
+    StreamMode = Mode;
+    StreamMcastAddr = McastAddr;
+    pthread_mutex_unlock(&SubscriberMutex);
+}
+
+/*!
+    \brief  UDP_SubscriberSendto
+
+    按照当前发送方式发送一帧数据：单播方式下逐个发送至订阅者（订阅者表为空时退回广播），
+    组播方式下发送至组播地址，否则局域网广播。
+    发送前复制订阅者表快照，sendto阻塞期间不持有互斥锁。
+
+    \param  sock - UDP套接字
+            pBuf - 待发送数据
+            len  - 待发送字节数
+            port - 目的端口
+
+    \return 最后一次sendto的返回值，任一次发送失败则返回该次的错误码
+ */
+int UDP_SubscriberSendto(int sock, const void *pBuf, uint16_t len, uint16_t port)
+{
+    struct sockaddr_in destAddr;
+    uint32_t DestIP[UDP_SUBSCRIBER_NUM];
+    uint8_t DestNum = 0;
+    uint8_t i;
+    int status;
+    int ret = -1;
+
+    pthread_mutex_lock(&SubscriberMutex);
+    switch(StreamMode)
+    {
+        case STREAM_UNICAST:
+            for(i=0; i<UDP_SUBSCRIBER_NUM; i++)
+            {
+                if( Subscriber[i].Valid )
+                    DestIP[DestNum++] = Subscriber[i].IPAddr;
+            }
+            break;
+
+        case STREAM_MULTICAST:
+            DestIP[DestNum++] = StreamMcastAddr;
+            break;
+    }
+    pthread_mutex_unlock(&SubscriberMutex);
+
+    if( DestNum == 0 )
+    {
+        DestIP[DestNum++] = SL_IPV4_VAL(255,255,255,255); //!< 局域网广播
+    }
+
+    memset(&destAddr, 0, sizeof(destAddr));
+    destAddr.sin_family = AF_INET;
+    destAddr.sin_port = htons(port);
+
+    for(i=0; i<DestNum; i++)
+    {
+        destAddr.sin_addr.s_addr = htonl(DestIP[i]);
+        status = sendto(sock, pBuf, len, 0,
+                        (struct sockaddr*)&destAddr, sizeof(SlSockAddr_t));
+        if( (ret >= 0) || (i == 0) )
+            ret = status; //!< 保留首个错误码
+    }
+
+    return ret;
+}
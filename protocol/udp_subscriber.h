@@ -0,0 +1,65 @@
+/**
+ * @file    udp_subscriber.h
+ * @author  gjmsilly
+ * @brief   NanoEEG UDP数据通道订阅者表
+ * @version 1.0.0
+ * @date    2022-03-20
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef __UDP_SUBSCRIBER_H
+#define __UDP_SUBSCRIBER_H
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <protocol/attr_protocol.h>
+
+/*********************************************************************
+ * Macros
+ */
+#define UDP_SUBSCRIBER_NUM          4       //!< 订阅者表容量
+#define UDP_SUBSCRIBER_OWNER_NUM    TCP_CTX_NUM //!< 每个订阅者最多TCP会话数，同IP可有多个连接
+#define UDP_SUBSCRIBER_DETECT_TTL   60      //!< 探测订阅者有效期 s，开始采样时清除超过有效期未再探测的订阅者
+
+#define UDP_SUBSCRIBER_DETECT       (-1)    //!< 订阅者来源 - 探测握手（无TCP会话）
+
+/* 数据通道发送方式 @ref 属性 STREAM_MODE */
+#define STREAM_BROADCAST            0       //!< 局域网广播
+#define STREAM_UNICAST              1       //!< 逐订阅者单播，订阅者表为空时退回广播
+#define STREAM_MULTICAST            2       //!< 发送至组播地址
+
+#define STREAM_MCAST_DEFAULT        SL_IPV4_VAL(239,255,0,1)    //!< 默认组播地址
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/*!
+    \brief    UDP数据通道订阅者
+ */
+typedef struct
+{
+    uint32_t    IPAddr;             //!< 订阅者IP地址（主机字节序）
+    int         Owner[UDP_SUBSCRIBER_OWNER_NUM]; //!< 持有该订阅者的TCP会话clientfd
+    uint8_t     OwnerNum;           //!< 持有该订阅者的TCP会话数，最后一个会话结束时移除
+    bool        Detected;           //!< 经探测握手添加且尚未过期
+    uint32_t    DetectTime;         //!< 最近一次探测时刻（单调时钟 s），表满时替换最早的探测订阅者
+    bool        Valid;              //!< 表项有效
+} UDPSubscriber_t;
+
+/**********************************************************************
+ * FUNCTIONS
+ */
+void UDP_SubscriberInit(void);
+bool UDP_SubscriberAdd(uint32_t IPAddr, int Owner);
+void UDP_SubscriberRemove(int Owner);
+void UDP_SubscriberAge(void);
+void UDP_SubscriberConfig(uint8_t Mode, uint32_t McastAddr);
+int UDP_SubscriberSendto(int sock, const void *pBuf, uint16_t len, uint16_t port);
+
+#endif  /* __UDP_SUBSCRIBER_H */
@@ -29,6 +29,10 @@
 static uint8_t  DummyByte=0x00;
 SPI_Handle      masterSpi;
 
+static SPI_CallbackFxn  pAcqCallback = NULL;    //!< 采集回调 - 非空则采样期间SPI工作于回调模式
+static SPI_Transaction  AcqTransaction;         //!< 回调模式读取量化值的传输对象（须在传输期间保持有效）
+static bool             SpiCallbackMode = false;//!< SPI工作于回调模式 - 此时不允许访问寄存器
+
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
@@ -39,6 +43,8 @@ static void WaitUs(unsigned long  iWaitUs);
 static void ADS1299_SendCommand(uint8_t command);
 static void ADS1299_WriteREG(uint8_t dev, uint8_t address, uint8_t value);
 static uint8_t ADS1299_ReadREG(uint8_t dev, uint8_t address);
+static void ADS1299_SPIOpen(SPI_TransferMode transferMode);
+static uint8_t ADS1299_GainCode(uint8_t gain);
 
 /****************************************************************/
 /*  WaitUs                                                      */
@@ -145,6 +151,8 @@ void ADS1299_SendCommand(uint8_t command)
     SPI_Transaction transaction;
     bool            transferOK;
 
+    if (SpiCallbackMode)
+        return; //!< 回调模式下传输立即返回，栈上传输对象失效且完成回调被当作样本
 
     Mod_CS_Enable
     WaitUs(6);
@@ -192,6 +200,9 @@ void ADS1299_WriteREG (uint8_t dev, uint8_t address, uint8_t value)
     SPI_Transaction transaction;
     bool            transferOK;
 
+    if (SpiCallbackMode)
+        return; //!< 采样期间不允许访问寄存器 @ref SpiCallbackMode
+
     Mod_CS_Enable
 
     for (i= 0; i < 3; i++)
@@ -232,10 +243,13 @@ uint8_t ADS1299_ReadREG (uint8_t dev, uint8_t address)
     address += 0x20;
     uint8_t         i;
     uint8_t         transmitBuffer[3] = {address,0x00,DummyByte}; // address / reg number-1 =0x00 / DummyByte=0xaa
-    uint8_t         receiveBuffer[3];
+    uint8_t         receiveBuffer[3] = {0};
     SPI_Transaction transaction;
     bool            transferOK;
 
+    if (SpiCallbackMode)
+        return 0; //!< 采样期间不允许访问寄存器 @ref SpiCallbackMode
+
     Mod_CS_Enable
 
     for (i= 0; i < 3; i++)
@@ -254,42 +268,77 @@ uint8_t ADS1299_ReadREG (uint8_t dev, uint8_t address)
   return receiveBuffer[2];
 }
 
-/*********************************************************************
- * FUNCTIONS
- */
-
 /****************************************************************/
-/*  ADS1299_init                                                */
+/*  ADS1299_SPIOpen                                             */
 /** Operation:
- *      - initial the SPI module and DReady interrupts
+ *      - (Re)open the SPI module in the given transfer mode
  *
  * Parameters:
- *      - None
+ *      - transferMode: SPI_MODE_BLOCKING for register access,
+ *                      SPI_MODE_CALLBACK for ISR driven sampling
  *
  * Return value:
  *     - None
  *
  * Globals modified:
- *     - None
+ *     - masterSpi
  *
  * Resources used:
  *     - None
  */
 /****************************************************************/
-void ADS1299_Init(uint8_t dev)
+static void ADS1299_SPIOpen(SPI_TransferMode transferMode)
 {
     SPI_Params      spiParams;
 
+    if (masterSpi != NULL) {
+        SPI_close(masterSpi);
+    }
+
     /* Open SPI as master (default) */
     SPI_Params_init(&spiParams);
     spiParams.dataSize = 8;
     spiParams.frameFormat = SPI_POL0_PHA1;
     spiParams.bitRate = 10000000; //!< 10MHz
 
+    if (transferMode == SPI_MODE_CALLBACK) {
+        spiParams.transferMode = SPI_MODE_CALLBACK;
+        spiParams.transferCallbackFxn = pAcqCallback;
+    }
+
     masterSpi = SPI_open(CONFIG_SPI_0, &spiParams);
     if (masterSpi == NULL) {
         while (1);
     }
+    SpiCallbackMode = (transferMode == SPI_MODE_CALLBACK);
+}
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/****************************************************************/
+/*  ADS1299_init                                                */
+/** Operation:
+ *      - initial the SPI module and DReady interrupts
+ *
+ * Parameters:
+ *      - None
+ *
+ * Return value:
+ *     - None
+ *
+ * Globals modified:
+ *     - None
+ *
+ * Resources used:
+ *     - None
+ */
+/****************************************************************/
+void ADS1299_Init(uint8_t dev)
+{
+    /* Open SPI as master (default) */
+    ADS1299_SPIOpen(SPI_MODE_BLOCKING);
 
     /* Initial the ads1299 */
     Mod_DRDY_INT_Disable
@@ -572,6 +621,8 @@ void ADS1299_Mode_Config(uint8_t Mode)
  *      - result:point to the buffer to store result
  *
  * Return value:
+ *      - true  transfer completed
+ *      - false transfer failed, result is invalid
  *
  * Globals modified:
  *     - None
@@ -580,33 +631,71 @@ void ADS1299_Mode_Config(uint8_t Mode)
  *     - None
  */
 /****************************************************************/
-void ADS1299_ReadResult(uint8_t *result)
+bool ADS1299_ReadResult(uint8_t *result)
 {
     SPI_Transaction transaction;
-    bool            transferOK;
 
     //DMA
-    #ifdef Dev_Ch32
-    transaction.count = 108;
-    #endif
-    #ifdef Dev_Ch24
-    transaction.count = 81;
-    #endif
-    #ifdef Dev_Ch16
-    transaction.count = 54;
-    #endif
-    #ifdef Dev_Ch8
-    transaction.count = 27;
-    #endif
+    transaction.count = ADS1299_RESULT_SIZE;
 
     transaction.txBuf = (void *)NULL;
     transaction.rxBuf = (void *)result;
 
-    transferOK = SPI_transfer(masterSpi, &transaction);
-    if (!transferOK) 
-	{
-		while(1);
-	}
+    return SPI_transfer(masterSpi, &transaction); //!< 失败时由调用者计数并丢弃本样本
+}
+
+/****************************************************************/
+/*  ADS1299_ReadResultAsync                                     */
+/** Operation:
+ *      - Start reading ADS1299 output data by DMA without blocking,
+ *        the callback registered by ADS1299_RegisterAcqCB() is
+ *        called from ISR context once the transfer completes.
+ *        Only valid while sampling with an acquisition callback.
+ *
+ * Parameters:
+ *      - result:point to the buffer to store result
+ *
+ * Return value:
+ *      - true  transfer started
+ *      - false previous transfer still in progress
+ *
+ * Globals modified:
+ *     - None
+ *
+ * Resources used:
+ *     - None
+ */
+/****************************************************************/
+bool ADS1299_ReadResultAsync(uint8_t *result)
+{
+    AcqTransaction.count = ADS1299_RESULT_SIZE;
+    AcqTransaction.txBuf = (void *)NULL;
+    AcqTransaction.rxBuf = (void *)result;
+
+    return SPI_transfer(masterSpi, &AcqTransaction);
+}
+
+/****************************************************************/
+/*  ADS1299_RegisterAcqCB                                       */
+/** Operation:
+ *      - Register the SPI transfer callback used while sampling.
+ *        Once registered, ADS1299_Sampling_Control() switches the
+ *        SPI module to callback mode on start and back to blocking
+ *        mode on stop, register access stays blocking.
+ *
+ * Parameters:
+ *      - pfnAcqCB: SPI transfer callback, NULL to disable
+ *
+ * Globals modified:
+ *     - None
+ *
+ * Resources used:
+ *     - None
+ */
+/****************************************************************/
+void ADS1299_RegisterAcqCB(SPI_CallbackFxn pfnAcqCB)
+{
+    pAcqCallback = pfnAcqCB;
 }
 
 /****************************************************************/
@@ -629,6 +718,12 @@ void ADS1299_Sampling_Control(uint8_t Sampling)
     switch(Sampling)
     {
         case 0:
+            if(pAcqCallback)
+            {
+                Mod_DRDY_INT_Disable
+                SPI_transferCancel(masterSpi);
+                ADS1299_SPIOpen(SPI_MODE_BLOCKING); //!< 恢复阻塞模式以发送命令
+            }
             ADS1299_SendCommand(ADS1299_CMD_STOP);
             ADS1299_SendCommand(ADS1299_CMD_SDATAC);;
             //Mod_DRDY_INT_Disable
@@ -639,8 +734,17 @@ void ADS1299_Sampling_Control(uint8_t Sampling)
         case 1:
             ADS1299_SendCommand(ADS1299_CMD_START);
             ADS1299_SendCommand(ADS1299_CMD_RDATAC);
-            Mod_DRDY_INT_Enable
-            Mod_CS_Enable;
+            if(pAcqCallback)
+            {
+                ADS1299_SPIOpen(SPI_MODE_CALLBACK); //!< 采样期间由nDRDY中断启动DMA传输
+                Mod_CS_Enable;
+                Mod_DRDY_INT_Enable
+            }
+            else
+            {
+                Mod_DRDY_INT_Enable
+                Mod_CS_Enable;
+            }
         break;
 
     }
@@ -653,7 +757,9 @@ void ADS1299_Sampling_Control(uint8_t Sampling)
  *
  * Parameters:
  *      - dev: dev to set //TODO
- *      - Samplerate:the sampling rate need to set
+ *      - Samplerate:the sampling rate need to set, 250~2000 for
+ *        direct output, up to 16000 for oversampling with on-chip
+ *        decimation (see eeg_decim.c)
  *
  * Globals modified:
  *     - None
@@ -668,6 +774,9 @@ bool ADS1299_SetSamplerate(uint8_t dev, uint16_t Samplerate){
     uint8_t valset = 0;
     uint8_t valget = 0;
 
+    if (SpiCallbackMode)
+        return false; //!< 采样期间不允许访问寄存器
+
     switch(Samplerate)
     {
         case 250:
@@ -686,6 +795,18 @@ bool ADS1299_SetSamplerate(uint8_t dev, uint16_t Samplerate){
             valset = 0x93;
         break;
 
+        case 4000:
+            valset = 0x92;
+        break;
+
+        case 8000:
+            valset = 0x91;
+        break;
+
+        case 16000:
+            valset = 0x90;
+        break;
+
         default:
             valset = 0x94; //default 1kHz
         break;
@@ -703,6 +824,33 @@ bool ADS1299_SetSamplerate(uint8_t dev, uint16_t Samplerate){
 
 }
 
+/****************************************************************/
+/*  ADS1299_GainCode                                            */
+/** Operation:
+ *      - Convert the gain to CHnSET gain bits
+ *
+ * Parameters:
+ *      - gain:the gain need to set
+ *
+ * Return value:
+ *      - CHnSET gain bits, x24 if the gain is not supported
+ */
+/****************************************************************/
+static uint8_t ADS1299_GainCode(uint8_t gain)
+{
+    switch(gain)
+    {
+        case 1:     return 0;
+        case 2:     return 1;
+        case 4:     return 2;
+        case 6:     return 3;
+        case 8:     return 4;
+        case 12:    return 5;
+        case 24:    return 6;
+        default:    return 6; //default x24
+    }
+}
+
 /****************************************************************/
 /*  ADS1299_SetGain                                             */
 /** Operation:
@@ -724,40 +872,10 @@ bool ADS1299_SetGain(uint8_t dev, uint8_t gain){
     uint8_t valget,i;
     TADS1299CHnSET ChVal;
 
-    switch(gain)
-     {
-         case 1:
-             ChVal.control_bit.gain = 0;
-         break;
-
-         case 2:
-             ChVal.control_bit.gain = 1;
-         break;
-
-         case 4:
-             ChVal.control_bit.gain = 2;
-         break;
-
-         case 6:
-             ChVal.control_bit.gain = 3;
-         break;
-
-         case 8:
-             ChVal.control_bit.gain = 4;
-         break;
-
-         case 12:
-             ChVal.control_bit.gain = 5;
-         break;
-
-         case 24:
-             ChVal.control_bit.gain = 6;
-         break;
+    if (SpiCallbackMode)
+        return false; //!< 采样期间不允许访问寄存器
 
-         default:
-             ChVal.control_bit.gain = 6; //default x24
-         break;
-     }
+    ChVal.control_bit.gain = ADS1299_GainCode(gain);
      ChVal.control_bit.pd = 0;
      ChVal.control_bit.mux = 0;
      ChVal.control_bit.srb2 = 0;
@@ -775,4 +893,96 @@ bool ADS1299_SetGain(uint8_t dev, uint8_t gain){
      return true;
 }
 
+/****************************************************************/
+/*  ADS1299_SetChannel                                          */
+/** Operation:
+ *      - Set one channel of the ads1299 module
+ *        关闭的通道断电（PD=1）且输入短接（MUX=001），降低模拟功耗
+ *
+ * Parameters:
+ *      - dev: dev to set //TODO
+ *      - channel: CHnSET number 0~7
+ *      - enable: 0-power down 1-normal operation
+ *      - gain:the gain need to set
+ *      - mux:channel input 0~7
+ *
+ * Globals modified:
+ *     - None
+ *
+ * Resources used:
+ *     - None
+ */
+/****************************************************************/
+bool ADS1299_SetChannel(uint8_t dev, uint8_t channel, bool enable, uint8_t gain, uint8_t mux){
+
+    uint8_t valget;
+    TADS1299CHnSET ChVal;
+
+    if (SpiCallbackMode)
+        return false; //!< 采样期间不允许访问寄存器
+
+    ChVal.control_bit.gain = ADS1299_GainCode(gain);
+    ChVal.control_bit.pd = enable ? 0 : 1;
+    ChVal.control_bit.mux = enable ? mux : 1; //!< 关闭的通道输入短接
+    ChVal.control_bit.srb2 = 0;
+
+    /* 尝试配置 */
+    ADS1299_Channel_Config(0,channel,ChVal);
+    /* 回读一次 */
+    valget = ADS1299_ReadREG(0,ADS1299_REG_CH1SET+channel);
+
+    return (valget == ChVal.value);
+}
+
+/****************************************************************/
+/*  ADS1299_SetLeadOff                                          */
+/** Operation:
+ *      - Set the ads1299 lead-off excitation for impedance measurement
+ *        交流激励：6uA方波电流注入各通道正输入端，负输入端接共用参考电极，关闭偏置驱动；
+ *        关闭激励：恢复EEG_ACQ的导联脱落与偏置驱动配置
+ *
+ * Parameters:
+ *      - dev: dev to set //TODO
+ *      - flead: ADS1299_LOFF_OFF / ADS1299_LOFF_AC_7HZ8 / ADS1299_LOFF_AC_31HZ2
+ *
+ * Globals modified:
+ *     - None
+ *
+ * Resources used:
+ *     - None
+ */
+/****************************************************************/
+bool ADS1299_SetLeadOff(uint8_t dev, uint8_t flead){
+
+    uint8_t valset;
+    uint8_t valget;
+
+    if (SpiCallbackMode)
+        return false; //!< 采样期间不允许访问寄存器
+
+    if(flead == ADS1299_LOFF_OFF)
+    {
+        valset = 0x00;
+        ADS1299_WriteREG(0,ADS1299_REG_LOFFSENSP,0x00);
+        ADS1299_WriteREG(0,ADS1299_REG_LOFFSENSN,0x00);
+        ADS1299_WriteREG(0,ADS1299_REG_BIASSENSN,0x00);
+        ADS1299_WriteREG(0,ADS1299_REG_BIASSENSP,0xFF);
+    }
+    else
+    {
+        valset = 0x08 | (flead & 0x03);     //[3:2]=10(6uA); [1:0]=01(7.8Hz),10(31.2Hz)
+        ADS1299_WriteREG(0,ADS1299_REG_LOFFSENSP,0xFF);
+        ADS1299_WriteREG(0,ADS1299_REG_LOFFSENSN,0x00);
+        ADS1299_WriteREG(0,ADS1299_REG_BIASSENSN,0x00);
+        ADS1299_WriteREG(0,ADS1299_REG_BIASSENSP,0x00);
+    }
+
+    /* 尝试配置 */
+    ADS1299_WriteREG(0,ADS1299_REG_LOFF,valset);
+    /* 回读一次 */
+    valget = ADS1299_ReadREG(0,ADS1299_REG_LOFF);
+
+    return (valget == valset);
+}
+
 
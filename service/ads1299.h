@@ -13,6 +13,7 @@
 #define __ADS1299_H
 
 #include <ti/drivers/GPIO.h>
+#include <ti/drivers/SPI.h>
 #include "ti_drivers_config.h"
 #include <stdbool.h>
 
@@ -22,6 +23,11 @@
 #define EEG_ACQ             0x01
 #define IMP_MEAS            0x02
 
+/* 导联脱落激励 @ref ADS1299_SetLeadOff LOFF[1:0] FLEAD_OFF */
+#define ADS1299_LOFF_OFF        0x00    //!< 关闭激励
+#define ADS1299_LOFF_AC_7HZ8    0x01    //!< 交流激励 7.8Hz
+#define ADS1299_LOFF_AC_31HZ2   0x02    //!< 交流激励 31.2Hz
+
 /****************************************************************/
 /* return types and return codes                                */
 /****************************************************************/
@@ -543,6 +549,20 @@ typedef struct
 #define ADS1299_ParaGroup_STBY  3
 #define ADS1299_ParaGroup_TSIG  4 // internal test signal
 
+/* 单次读取量化值字节数（每片ADS1299 3字节状态+8通道*3字节） */
+#ifdef Dev_Ch32
+#define ADS1299_RESULT_SIZE     108
+#endif
+#ifdef Dev_Ch24
+#define ADS1299_RESULT_SIZE     81
+#endif
+#ifdef Dev_Ch16
+#define ADS1299_RESULT_SIZE     54
+#endif
+#ifdef Dev_Ch8
+#define ADS1299_RESULT_SIZE     27
+#endif
+
 
 #define Mod_CS_Enable	 GPIO_write(Mod_nCS,0);
 #define Mod_CS_Disable   GPIO_write(Mod_nCS,1);
@@ -557,7 +577,9 @@ typedef struct
 
 void ADS1299_Init(uint8_t dev);
 
-void ADS1299_ReadResult(uint8_t *result);
+bool ADS1299_ReadResult(uint8_t *result);
+bool ADS1299_ReadResultAsync(uint8_t *result);
+void ADS1299_RegisterAcqCB(SPI_CallbackFxn pfnAcqCB);
 
 void ADS1299_Channel_Config(uint8_t dev, uint8_t channel, TADS1299CHnSET Para);
 void ADS1299_Parameter_Config(uint8_t mode,uint8_t sample,uint8_t gain);
@@ -566,6 +588,8 @@ void ADS1299_Mode_Config(uint8_t Mode);
 void ADS1299_Sampling_Control(uint8_t Sampling);
 bool ADS1299_SetSamplerate(uint8_t dev, uint16_t Samplerate);
 bool ADS1299_SetGain(uint8_t dev, uint8_t gain);
+bool ADS1299_SetChannel(uint8_t dev, uint8_t channel, bool enable, uint8_t gain, uint8_t mux);
+bool ADS1299_SetLeadOff(uint8_t dev, uint8_t flead);
 
 #endif /* __ADS1299_H */
 
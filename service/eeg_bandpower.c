@@ -0,0 +1,459 @@
+/**
+ * @file    eeg_bandpower.c
+ * @author  gjmsilly
+ * @brief   NanoEEG 设备端频带功率特征（逐通道加窗定点基4 FFT，δ/θ/α/β/γ频带功率）
+ * @version 1.0.0
+ * @date    2022-05-10
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*******************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "eeg_bandpower.h"
+
+/*******************************************************************
+ *  LOCAL VARIABLES
+ */
+
+/*!
+    \brief  cos(2πk/N) Q31，k = 0~N-1
+            同时用作FFT旋转因子（sin(2πk/N) = cos(2π(k-N/4)/N)）与Hann窗（w[n] = (1 - cos(2πn/N)) / 2）
+ */
+static const int32_t BandCosTbl[EEG_BAND_FFT_N] = {
+     2147483647,  2146836866,  2144896910,  2141664948,  2137142927,  2131333572,  2124240380,  2115867626,
+     2106220352,  2095304370,  2083126254,  2069693342,  2055013723,  2039096241,  2021950484,  2003586779,
+     1984016189,  1963250501,  1941302225,  1918184581,  1893911494,  1868497586,  1841958164,  1814309216,
+     1785567396,  1755750017,  1724875040,  1692961062,  1660027308,  1626093616,  1591180426,  1555308768,
+     1518500250,  1480777044,  1442161874,  1402678000,  1362349204,  1321199781,  1279254516,  1236538675,
+     1193077991,  1148898640,  1104027237,  1058490808,  1012316784,   965532978,   918167572,   870249095,
+      821806413,   772868706,   723465451,   673626408,   623381598,   572761285,   521795963,   470516330,
+      418953276,   367137861,   315101295,   262874923,   210490206,   157978697,   105372028,    52701887,
+              0,   -52701887,  -105372028,  -157978697,  -210490206,  -262874923,  -315101295,  -367137861,
+     -418953276,  -470516330,  -521795963,  -572761285,  -623381598,  -673626408,  -723465451,  -772868706,
+     -821806413,  -870249095,  -918167572,  -965532978, -1012316784, -1058490808, -1104027237, -1148898640,
+    -1193077991, -1236538675, -1279254516, -1321199781, -1362349204, -1402678000, -1442161874, -1480777044,
+    -1518500250, -1555308768, -1591180426, -1626093616, -1660027308, -1692961062, -1724875040, -1755750017,
+    -1785567396, -1814309216, -1841958164, -1868497586, -1893911494, -1918184581, -1941302225, -1963250501,
+    -1984016189, -2003586779, -2021950484, -2039096241, -2055013723, -2069693342, -2083126254, -2095304370,
+    -2106220352, -2115867626, -2124240380, -2131333572, -2137142927, -2141664948, -2144896910, -2146836866,
+      INT32_MIN, -2146836866, -2144896910, -2141664948, -2137142927, -2131333572, -2124240380, -2115867626,
+    -2106220352, -2095304370, -2083126254, -2069693342, -2055013723, -2039096241, -2021950484, -2003586779,
+    -1984016189, -1963250501, -1941302225, -1918184581, -1893911494, -1868497586, -1841958164, -1814309216,
+    -1785567396, -1755750017, -1724875040, -1692961062, -1660027308, -1626093616, -1591180426, -1555308768,
+    -1518500250, -1480777044, -1442161874, -1402678000, -1362349204, -1321199781, -1279254516, -1236538675,
+    -1193077991, -1148898640, -1104027237, -1058490808, -1012316784,  -965532978,  -918167572,  -870249095,
+     -821806413,  -772868706,  -723465451,  -673626408,  -623381598,  -572761285,  -521795963,  -470516330,
+     -418953276,  -367137861,  -315101295,  -262874923,  -210490206,  -157978697,  -105372028,   -52701887,
+              0,    52701887,   105372028,   157978697,   210490206,   262874923,   315101295,   367137861,
+      418953276,   470516330,   521795963,   572761285,   623381598,   673626408,   723465451,   772868706,
+      821806413,   870249095,   918167572,   965532978,  1012316784,  1058490808,  1104027237,  1148898640,
+     1193077991,  1236538675,  1279254516,  1321199781,  1362349204,  1402678000,  1442161874,  1480777044,
+     1518500250,  1555308768,  1591180426,  1626093616,  1660027308,  1692961062,  1724875040,  1755750017,
+     1785567396,  1814309216,  1841958164,  1868497586,  1893911494,  1918184581,  1941302225,  1963250501,
+     1984016189,  2003586779,  2021950484,  2039096241,  2055013723,  2069693342,  2083126254,  2095304370,
+     2106220352,  2115867626,  2124240380,  2131333572,  2137142927,  2141664948,  2144896910,  2146836866,
+};
+
+/*!
+    \brief  频带对应的FFT频点范围 [Lo, Hi]，频点k对应频率 k x 250 / 256 Hz，
+            频带取半开区间[f1, f2)：Lo = ceil(f1 x 256 / 250)，Hi = ceil(f2 x 256 / 250) - 1
+ */
+static const struct
+{
+    uint8_t     Lo;                 //!< 起始频点
+    uint8_t     Hi;                 //!< 结束频点（含）
+} BandBinTbl[EEG_BAND_NUM] = {
+    {  2,  4 },                     //!< δ 1~4Hz
+    {  5,  8 },                     //!< θ 4~8Hz
+    {  9, 13 },                     //!< α 8~13Hz
+    { 14, 30 },                     //!< β 13~30Hz
+    { 31, 46 },                     //!< γ 30~45Hz
+};
+
+#define EEG_BAND_BIN_MAX    46      //!< 参与计算的最高频点
+
+static uint8_t          BandMode;                               //!< 特征流模式 @ref EEG_BAND_MODE_OFF
+static uint8_t          BandDecim;                              //!< CIC抽取比 = 输出采样率 / 250
+static uint8_t          BandDecimShift;                         //!< CIC增益D^3对应的右移位数
+static uint8_t          BandDecimIdx;                           //!< 抽取计数
+static uint16_t         BandHopLen;                             //!< 更新间隔（分析样本数）
+static uint16_t         BandHopIdx;                             //!< 更新间隔内分析样本计数
+static uint16_t         BandFill;                               //!< 窗内已填充的分析样本数
+static uint8_t          BandWrIdx;                              //!< 环形缓冲区写位置（即窗内最早样本）
+static uint64_t         BandCicInt[CHANNEL_NUM][3];             //!< CIC积分器（模2^64运算）
+static uint64_t         BandCicComb[CHANNEL_NUM][3];            //!< CIC梳状器延迟
+static uint8_t          BandHist[CHANNEL_NUM][EEG_BAND_FFT_N][3]; //!< 各通道分析样本环形缓冲区，大端int24（CIC输出不超出输入范围）
+static int32_t          BandFftBuf[2 * EEG_BAND_FFT_N];         //!< FFT缓冲区，实部虚部交替
+static float            BandScale[CHANNEL_NUM];                 //!< |X|^2 到 uV^2 的换算系数
+static float            BandDroop[EEG_BAND_BIN_MAX + 1];        //!< CIC通带衰减补偿 1 / |H(k)|^2
+static float            BandPower[CHANNEL_NUM * EEG_BAND_NUM];  //!< 频带功率 uV^2
+
+/*******************************************************************
+ *  LOCAL FUNCTIONS
+ */
+
+/*!
+    \brief  EEGBand_Twiddle
+
+    p = (Re + jIm) x W^Idx，W = e^(-j2π/N)，Q31乘法（SMULL）
+
+    \param  p   - 输出（实部、虚部）
+            Re  - 实部
+            Im  - 虚部
+            Idx - 旋转因子指数
+ */
+static void EEGBand_Twiddle(int32_t *p, int32_t Re, int32_t Im, uint16_t Idx)
+{
+    int32_t c, s;
+
+    if( Idx == 0 )
+    {
+        p[0] = Re;
+        p[1] = Im;
+        return;
+    }
+
+    c = BandCosTbl[Idx & (EEG_BAND_FFT_N - 1)];
+    s = BandCosTbl[(Idx + EEG_BAND_FFT_N * 3 / 4) & (EEG_BAND_FFT_N - 1)];
+
+    p[0] = (int32_t)(((int64_t)Re * c + (int64_t)Im * s) >> 31);
+    p[1] = (int32_t)(((int64_t)Im * c - (int64_t)Re * s) >> 31);
+}
+
+/*!
+    \brief  EEGBand_Fft
+
+    N = 256 基4按频率抽取FFT，原位计算，4级，每级输入右移2位防溢出（输出为DFT / N）。
+    输出为基4位序反转顺序，频点k位于 EEGBand_Rev4(k)。
+
+    \param  pBuf - 输入输出，实部虚部交替，输入绝对值不超过2^29
+ */
+static void EEGBand_Fft(int32_t *pBuf)
+{
+    uint16_t L, q, Step, j, g;
+    int32_t *p0, *p1, *p2, *p3;
+    int32_t ar, ai, br, bi, cr, ci, dr, di;
+    int32_t t0r, t0i, t1r, t1i, t2r, t2i, t3r, t3i;
+
+    for(L = EEG_BAND_FFT_N, Step = 1; L >= 4; L >>= 2, Step <<= 2)
+    {
+        q = L >> 2;
+        for(j=0; j<q; j++)
+        {
+            for(g=j; g<EEG_BAND_FFT_N; g+=L)
+            {
+                p0 = pBuf + 2 * g;
+                p1 = p0 + 2 * q;
+                p2 = p1 + 2 * q;
+                p3 = p2 + 2 * q;
+
+                ar = p0[0] >> 2;    ai = p0[1] >> 2;
+                br = p1[0] >> 2;    bi = p1[1] >> 2;
+                cr = p2[0] >> 2;    ci = p2[1] >> 2;
+                dr = p3[0] >> 2;    di = p3[1] >> 2;
+
+                t0r = ar + cr;      t0i = ai + ci;
+                t1r = ar - cr;      t1i = ai - ci;
+                t2r = br + dr;      t2i = bi + di;
+                t3r = br - dr;      t3i = bi - di;
+
+                p0[0] = t0r + t2r;
+                p0[1] = t0i + t2i;
+                EEGBand_Twiddle(p1, t1r + t3i, t1i - t3r, j * Step);
+                EEGBand_Twiddle(p2, t0r - t2r, t0i - t2i, 2 * j * Step);
+                EEGBand_Twiddle(p3, t1r - t3i, t1i + t3r, 3 * j * Step);
+            }
+        }
+    }
+}
+
+/*!
+    \brief  EEGBand_Rev4
+
+    \return 8位下标的基4位序反转
+ */
+static uint8_t EEGBand_Rev4(uint8_t k)
+{
+    return (uint8_t)(((k & 0x03) << 6) | ((k & 0x0C) << 2) | ((k & 0x30) >> 2) | ((k & 0xC0) >> 6));
+}
+
+/*!
+    \brief  EEGBand_HistGet
+
+    \return 环形缓冲区中的分析样本（int24符号扩展）
+ */
+static inline int32_t EEGBand_HistGet(const uint8_t *pVal)
+{
+    return (int32_t)(((uint32_t)pVal[0] << 24) | ((uint32_t)pVal[1] << 16) | ((uint32_t)pVal[2] << 8)) >> 8;
+}
+
+/*!
+    \brief  EEGBand_WindowLoad
+
+    窗内样本按时间先后去均值、左移EEG_BAND_FFT_SHIFT位、乘Hann窗后写入FFT缓冲区
+
+    \param  Ch   - 通道
+            Part - 0 写入实部 1 写入虚部
+ */
+static void EEGBand_WindowLoad(uint8_t Ch, uint8_t Part)
+{
+    uint8_t (*pHist)[3] = BandHist[Ch];
+    int64_t Sum = 0;
+    int32_t Mean, v, w;
+    uint16_t n;
+    uint8_t Idx;
+
+    for(n=0; n<EEG_BAND_FFT_N; n++)
+        Sum += EEGBand_HistGet(pHist[n]);
+    Mean = (int32_t)(Sum / EEG_BAND_FFT_N);
+
+    Idx = BandWrIdx;
+    for(n=0; n<EEG_BAND_FFT_N; n++, Idx++)
+    {
+        v = (EEGBand_HistGet(pHist[Idx]) - Mean) * (1 << EEG_BAND_FFT_SHIFT);
+        w = (int32_t)(((int64_t)INT32_MAX - BandCosTbl[n]) >> 1);   //!< Hann窗 Q31
+        BandFftBuf[2 * n + Part] = (int32_t)(((int64_t)v * w) >> 31);
+    }
+}
+
+/*!
+    \brief  EEGBand_Compute
+
+    两个实数通道合为一个复数序列 z = a + jb 做一次FFT，再分离两通道的频谱：
+    A[k] = (Z[k] + Z*[N-k]) / 2，B[k] = (Z[k] - Z*[N-k]) / 2j，逐频带累加|A|^2、|B|^2。
+ */
+static void EEGBand_Compute(void)
+{
+    uint32_t ChMask = UDP_EEGChMaskGet();
+    const int32_t *pZ, *pZn;
+    int64_t Re, Im;
+    float SumA, SumB;
+    uint8_t Ch, Band, k;
+
+    for(Ch=0; Ch<CHANNEL_NUM; Ch+=2)
+    {
+        if( !((ChMask >> Ch) & 0x03) )
+            continue; //!< 两通道均未启用
+
+        EEGBand_WindowLoad(Ch, 0);
+        EEGBand_WindowLoad(Ch + 1, 1);
+        EEGBand_Fft(BandFftBuf);
+
+        for(Band=0; Band<EEG_BAND_NUM; Band++)
+        {
+            SumA = 0;
+            SumB = 0;
+            for(k=BandBinTbl[Band].Lo; k<=BandBinTbl[Band].Hi; k++)
+            {
+                pZ = &BandFftBuf[2 * EEGBand_Rev4(k)];
+                pZn = &BandFftBuf[2 * EEGBand_Rev4((uint8_t)(EEG_BAND_FFT_N - k))];
+
+                /* 4|A|^2 */
+                Re = (int64_t)pZ[0] + pZn[0];
+                Im = (int64_t)pZ[1] - pZn[1];
+                SumA += (float)(Re * Re + Im * Im) * BandDroop[k];
+
+                /* 4|B|^2 */
+                Re = (int64_t)pZ[1] + pZn[1];
+                Im = (int64_t)pZ[0] - pZn[0];
+                SumB += (float)(Re * Re + Im * Im) * BandDroop[k];
+            }
+
+            BandPower[Ch * EEG_BAND_NUM + Band] = SumA * BandScale[Ch];
+            BandPower[(Ch + 1) * EEG_BAND_NUM + Band] = SumB * BandScale[Ch + 1];
+        }
+    }
+}
+
+/*******************************************************************
+ *  FUNCTIONS
+ */
+
+/*!
+    \brief  EEGBand_IsSupported
+
+    特征流模式能否在该输出采样率下实现，供属性层写特征流模式及采样率时校验。
+    关闭时任意采样率均可；启用时输出采样率须能以2的幂CIC抽取到250SPS，即250/500/1000/2000SPS。
+
+    \param  Mode       - 特征流模式 @ref EEG_BAND_MODE_OFF
+            Samplerate - 输出采样率
+
+    \return true - 支持
+ */
+bool EEGBand_IsSupported(uint8_t Mode, uint16_t Samplerate)
+{
+    if( Mode > EEG_BAND_MODE_ONLY )
+        return false;
+    if( Mode == EEG_BAND_MODE_OFF )
+        return true;
+
+    return (Samplerate == 250) || (Samplerate == 500) || (Samplerate == 1000) || (Samplerate == 2000);
+}
+
+/*!
+    \brief  EEGBand_Config
+
+    配置频带功率特征，须在开始采样之前调用，清空窗内样本与CIC状态。
+    输出采样率高于250SPS时先经三阶CIC抽取到250SPS，频带内的CIC衰减逐频点补偿。
+
+    \param  Mode       - 特征流模式 @ref EEG_BAND_MODE_OFF
+            Samplerate - 输出采样率 250/500/1000/2000
+            HopMs      - 更新间隔 ms
+            pGain      - 各通道增益，CHANNEL_NUM个
+
+    \return true - 配置完成
+            false - 采样率不支持（属性层已按EEGBand_IsSupported()校验），不计算频带功率
+ */
+bool EEGBand_Config(uint8_t Mode, uint16_t Samplerate, uint16_t HopMs, const uint8_t *pGain)
+{
+    float Lsb, s;
+    uint8_t Ch, k;
+
+    BandMode = EEG_BAND_MODE_OFF;
+    if( Mode == EEG_BAND_MODE_OFF )
+        return true;
+
+    switch(Samplerate)
+    {
+        case 250:   BandDecim = 1; BandDecimShift = 0; break;
+        case 500:   BandDecim = 2; BandDecimShift = 3; break;
+        case 1000:  BandDecim = 4; BandDecimShift = 6; break;
+        case 2000:  BandDecim = 8; BandDecimShift = 9; break;
+        default:    return false;
+    }
+
+    /* CIC幅频响应 H(k) = [sin(πk/256) / (D sin(πk/256D))]^3 */
+    BandDroop[0] = 1.0f;
+    for(k=1; k<=EEG_BAND_BIN_MAX; k++)
+    {
+        s = sinf(3.14159265f * k / EEG_BAND_FFT_N) /
+            (BandDecim * sinf(3.14159265f * k / EEG_BAND_FFT_N / BandDecim));
+        BandDroop[k] = 1.0f / (s * s * s * s * s * s);
+    }
+
+    /*
+        Hann窗功率归一 Σw^2 = 3N/8：单边功率 P = 2Σ|X|^2 / (N Σw^2) = (16/3) Σ|X/N|^2，
+        FFT输出为DFT / N，输入放大2^EEG_BAND_FFT_SHIFT，累加值为4|X/N|^2
+     */
+    for(Ch=0; Ch<CHANNEL_NUM; Ch++)
+    {
+        Lsb = EEG_BAND_UV_PER_LSB / (pGain[Ch] ? pGain[Ch] : 1);
+        BandScale[Ch] = 16.0f / 3.0f / 4.0f / (float)(1UL << (2 * EEG_BAND_FFT_SHIFT)) * Lsb * Lsb;
+    }
+
+    BandHopLen = (uint16_t)((uint32_t)HopMs * EEG_BAND_RATE / 1000);
+    if( BandHopLen == 0 )
+        BandHopLen = 1;
+
+    BandDecimIdx = 0;
+    BandHopIdx = 0;
+    BandFill = 0;
+    BandWrIdx = 0;
+    memset(BandCicInt, 0, sizeof(BandCicInt));
+    memset(BandCicComb, 0, sizeof(BandCicComb));
+    memset(BandPower, 0, sizeof(BandPower));
+
+    BandMode = Mode;
+
+    return true;
+}
+
+/*!
+    \brief  EEGBand_Mode
+
+    \return 特征流模式 @ref EEG_BAND_MODE_OFF
+ */
+uint8_t EEGBand_Mode(void)
+{
+    return BandMode;
+}
+
+/*!
+    \brief  EEGBand_SamplePut
+
+    送入一个输出样本（设备端滤波之后），由采样线程调用。
+    窗内样本填满后每个更新间隔计算一次全部通道的频带功率。
+
+    \param  pChannelVal - 一个样本的ADS1299输出（逐通道组：状态3字节 + 8通道 x 大端int24）
+
+    \return true - 本样本完成一次计算，结果由 EEGBand_Result 取得
+ */
+bool EEGBand_SamplePut(const uint8_t *pChannelVal)
+{
+    const uint8_t *pVal;
+    uint64_t *pInt, *pComb;
+    uint64_t y, d;
+    int32_t x;
+    uint8_t Ch;
+
+    if( BandMode == EEG_BAND_MODE_OFF )
+        return false;
+
+    BandDecimIdx++;
+
+    for(Ch=0; Ch<CHANNEL_NUM; Ch++)
+    {
+        pVal = pChannelVal + (Ch >> 3) * UDP_CHGROUP_SIZE + 3 + (Ch & 0x07) * 3;
+        x = (int32_t)(((uint32_t)pVal[0] << 24) | ((uint32_t)pVal[1] << 16) | ((uint32_t)pVal[2] << 8)) >> 8;
+
+        if( BandDecim > 1 )
+        {
+            /* 三阶CIC：积分器按输入速率、梳状器按分析速率运行，模2^64运算溢出自动抵消 */
+            pInt = BandCicInt[Ch];
+            pInt[0] += (uint64_t)(int64_t)x;
+            pInt[1] += pInt[0];
+            pInt[2] += pInt[1];
+
+            if( BandDecimIdx < BandDecim )
+                continue;
+
+            pComb = BandCicComb[Ch];
+            y = pInt[2];
+            d = y - pComb[0];   pComb[0] = y;   y = d;
+            d = y - pComb[1];   pComb[1] = y;   y = d;
+            d = y - pComb[2];   pComb[2] = y;   y = d;
+            x = (int32_t)((int64_t)y >> BandDecimShift);
+        }
+
+        BandHist[Ch][BandWrIdx][0] = (uint8_t)(x >> 16);
+        BandHist[Ch][BandWrIdx][1] = (uint8_t)(x >> 8);
+        BandHist[Ch][BandWrIdx][2] = (uint8_t)x;
+    }
+
+    if( BandDecimIdx < BandDecim )
+        return false;
+
+    BandDecimIdx = 0;
+    BandWrIdx++;    //!< 8位自然回绕，N = 256
+
+    if( BandFill < EEG_BAND_FFT_N )
+        BandFill++;
+    if( BandHopIdx < BandHopLen )
+        BandHopIdx++;
+
+    if( (BandFill < EEG_BAND_FFT_N) || (BandHopIdx < BandHopLen) )
+        return false;
+
+    BandHopIdx = 0;
+    EEGBand_Compute();
+
+    return true;
+}
+
+/*!
+    \brief  EEGBand_Result
+
+    \return 最近一次计算的频带功率 uV^2，按通道依次为 δ θ α β γ，共CHANNEL_NUM x EEG_BAND_NUM个
+ */
+const float* EEGBand_Result(void)
+{
+    return BandPower;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file    eeg_bandpower.h
+ * @author  gjmsilly
+ * @brief   NanoEEG 设备端频带功率特征（逐通道加窗定点基4 FFT，δ/θ/α/β/γ频带功率）
+ * @version 1.0.0
+ * @date    2022-05-10
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef SERVICE_EEG_BANDPOWER_H_
+#define SERVICE_EEG_BANDPOWER_H_
+/*******************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <protocol/eegdata_protocol.h>
+
+/*******************************************************************
+ * CONSTANTS
+ */
+/* 特征流模式 @ref 属性 FEATURE_MODE */
+#define EEG_BAND_MODE_OFF           0           //!< 不计算频带功率
+#define EEG_BAND_MODE_WITH_RAW      1           //!< 频带功率 + 原始脑电数据
+#define EEG_BAND_MODE_ONLY          2           //!< 仅频带功率，不发送原始脑电数据
+
+/* 更新间隔 @ref 属性 FEATURE_HOP */
+#define EEG_BAND_HOP_DEFAULT        250         //!< 默认更新间隔 ms
+#define EEG_BAND_HOP_MIN            100         //!< 最小更新间隔 ms
+#define EEG_BAND_HOP_MAX            2000        //!< 最大更新间隔 ms
+
+/* 分析参数 */
+#define EEG_BAND_RATE               250         //!< 分析采样率，输出采样率经CIC抽取到该速率
+#define EEG_BAND_FFT_N              256         //!< FFT点数，窗长1.024s，频率分辨率0.977Hz
+#define EEG_BAND_FFT_SHIFT          5           //!< 去均值后左移位数，int24差值放大至不超过2^29
+#define EEG_BAND_NUM                5           //!< 频带数 δ θ α β γ
+
+/*!
+    每LSB对应的电压 uV：增益1时LSB = 2 x VREF(4.5V) / 2^24，除以通道增益
+ */
+#define EEG_BAND_UV_PER_LSB         (9.0f / 16777216.0f * 1e6f)
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+bool EEGBand_IsSupported(uint8_t Mode, uint16_t Samplerate);
+bool EEGBand_Config(uint8_t Mode, uint16_t Samplerate, uint16_t HopMs, const uint8_t *pGain);
+uint8_t EEGBand_Mode(void);
+bool EEGBand_SamplePut(const uint8_t *pChannelVal);
+const float* EEGBand_Result(void);
+
+#endif /* SERVICE_EEG_BANDPOWER_H_ */
@@ -0,0 +1,241 @@
+/**
+ * @file    eeg_decim.c
+ * @author  gjmsilly
+ * @brief   NanoEEG 过采样抽取（ADS1299高速率采集，级联半带FIR逐块抽取到输出采样率）
+ * @version 1.0.0
+ * @date    2022-05-03
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*******************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "eeg_decim.h"
+
+/*******************************************************************
+ * TYPEDEFS
+ */
+
+/*!
+    \brief  半带抽取节
+            h[c] = 1/2，h[c±d]（d为偶数）= 0，仅存储奇数偏移d = 1, 3, ..., c 的系数
+ */
+typedef struct
+{
+    uint8_t         Len;                //!< 抽头数 L = 4k + 3
+    uint8_t         CoefNum;            //!< 非零对称系数对数 (L + 1) / 4
+    const int32_t   *pCoef;             //!< h[c+d]，Q31
+} EEGDecimStage_t;
+
+/*******************************************************************
+ *  LOCAL VARIABLES
+ */
+
+/*!
+    \brief  半带系数（Kaiser窗，Q31，1/2 + 2Σh = 1 精确成立，直流增益为1）
+ */
+static const int32_t DecimCoefEarly[(EEG_DECIM_TAPS_EARLY + 1) / 4] = {
+    642173129, -128088440, 25191909, -2420939, 15253
+};
+
+static const int32_t DecimCoefMid[(EEG_DECIM_TAPS_MID + 1) / 4] = {
+    664228748, -175468527, 65003341, -21426621, 5254085, -735560, 15446
+};
+
+static const int32_t DecimCoefFinal[(EEG_DECIM_TAPS_FINAL + 1) / 4] = {
+    680128445, -217718123, 120408873, -76003719, 49991781, -33015386, 21443210, -13495579,
+    8122147, -4607328, 2417797, -1141362, 461263, -142661, 21554
+};
+
+static const EEGDecimStage_t DecimStageEarly = { EEG_DECIM_TAPS_EARLY, (EEG_DECIM_TAPS_EARLY + 1) / 4, DecimCoefEarly };
+static const EEGDecimStage_t DecimStageMid   = { EEG_DECIM_TAPS_MID,   (EEG_DECIM_TAPS_MID + 1) / 4,   DecimCoefMid };
+static const EEGDecimStage_t DecimStageFinal = { EEG_DECIM_TAPS_FINAL, (EEG_DECIM_TAPS_FINAL + 1) / 4, DecimCoefFinal };
+
+static const EEGDecimStage_t *pDecimStage[EEG_DECIM_STAGE_MAX];     //!< 级联各节
+static uint8_t  DecimStageNum;                                      //!< 级联节数，0为不抽取
+static uint8_t  DecimRatio = 1;                                     //!< 抽取比
+static uint32_t DecimDelay;                                         //!< 群时延（输入样本数）
+
+static int32_t  DecimHist[CHANNEL_NUM][EEG_DECIM_HIST_MAX];         //!< 逐通道各节历史样本（各节依次排列）
+static int32_t  DecimBuf[2][EEG_DECIM_TAPS_FINAL - 1 + EEG_DECIM_RATIO_MAX]; //!< 当前通道 各节输入（历史 + 本块）
+
+/*******************************************************************
+ *  LOCAL FUNCTIONS
+ */
+
+/*!
+    \brief  EEGDecim_Halfband
+
+    半带FIR在一个输出时刻的值：对称抽头先相加再乘（Cortex-M4 SMLAL单周期乘累加），
+    零系数抽头跳过，每输出 (L+1)/4 次乘累加。
+
+    \param  pStage - 半带节
+            pWin   - 窗口首样本，窗口为 pWin[0] ~ pWin[L-1]
+
+    \return 输出（整数LSB，四舍五入）
+ */
+static inline int32_t EEGDecim_Halfband(const EEGDecimStage_t *pStage, const int32_t *pWin)
+{
+    const int32_t *pMid = pWin + (pStage->Len >> 1);
+    int64_t Acc = (int64_t)pMid[0] << 30;
+    uint8_t i;
+
+    for(i=0; i<pStage->CoefNum; i++)
+        Acc += (int64_t)pStage->pCoef[i] * (pMid[-(2 * i + 1)] + pMid[2 * i + 1]);
+
+    return (int32_t)((Acc + ((int64_t)1 << 30)) >> 31);
+}
+
+/*******************************************************************
+ *  FUNCTIONS
+ */
+
+/*!
+    \brief  EEGDecim_Config
+
+    配置抽取比并清零各通道历史，须在开始采集之前调用（采样线程不加锁访问）。
+    抽取比2^S由S节半带抽2级联实现，越靠后的节输入速率越低、过渡带越窄、阶数越高。
+
+    \param  Ratio - 抽取比 1、2、4 ... EEG_DECIM_RATIO_MAX，1为不抽取
+
+    \return true - 配置完成
+            false - 抽取比不支持，不抽取
+ */
+bool EEGDecim_Config(uint8_t Ratio)
+{
+    uint8_t StageNum = 0;
+    uint8_t i;
+
+    while( ((uint16_t)1 << StageNum) < Ratio )
+        StageNum++;
+
+    DecimStageNum = 0;
+    DecimRatio = 1;
+    DecimDelay = 0;
+    memset(DecimHist, 0, sizeof(DecimHist));
+
+    if( (Ratio == 0) || (Ratio > EEG_DECIM_RATIO_MAX) || (((uint16_t)1 << StageNum) != Ratio) )
+        return false;
+
+    for(i=0; i<StageNum; i++)
+    {
+        if( i == StageNum - 1 )
+            pDecimStage[i] = &DecimStageFinal;
+        else if( i == StageNum - 2 )
+            pDecimStage[i] = &DecimStageMid;
+        else
+            pDecimStage[i] = &DecimStageEarly;
+
+        DecimDelay += (uint32_t)(pDecimStage[i]->Len >> 1) << i; //!< 第i节群时延(L-1)/2个本节输入样本，即2^i倍输入样本
+    }
+
+    DecimStageNum = StageNum;
+    DecimRatio = Ratio;
+
+    return true;
+}
+
+/*!
+    \brief  EEGDecim_GroupDelay
+
+    \return 级联半带的群时延（ADS1299输出样本数），输出样本时间戳须前移该时长
+ */
+uint32_t EEGDecim_GroupDelay(void)
+{
+    return DecimDelay;
+}
+
+/*!
+    \brief  EEGDecim_BlockProcess
+
+    原位抽取一个采集块，由采样线程调用。逐通道取出本块全部样本，依次经过各节，
+    第m个输出写回第m个样本位置，通道状态字节取自该输出对应的最后一个输入样本。
+    块长须为抽取比的整数倍，块间历史连续。
+
+    \param  pChannelVal - 采集块样本（逐通道组：状态3字节 + 8通道 x 大端int24），抽取后前RawNum/Ratio个有效
+            RawNum      - 本块ADS1299输出样本数
+ */
+void EEGDecim_BlockProcess(uint8_t (*pChannelVal)[UDP_SampleValSize], uint16_t RawNum)
+{
+    const EEGDecimStage_t *pStage;
+    int32_t *pHist;
+    int32_t *pIn, *pOut;
+    uint8_t *pVal;
+    uint16_t Len, OutOff, Offset, i;
+    int32_t x;
+    uint8_t Ch, Sec, Grp;
+
+    if( DecimStageNum == 0 )
+        return;
+
+    for(Ch=0; Ch<CHANNEL_NUM; Ch++)
+    {
+        Offset = (Ch >> 3) * UDP_CHGROUP_SIZE + 3 + (Ch & 0x07) * 3;
+        pHist = DecimHist[Ch];
+        pIn = DecimBuf[0];
+        Len = RawNum;
+
+        /* 第一节输入：历史 + 本块样本 */
+        memcpy(pIn, pHist, (pDecimStage[0]->Len - 1) * sizeof(int32_t));
+        for(i=0; i<Len; i++)
+        {
+            pVal = pChannelVal[i] + Offset;
+            pIn[pDecimStage[0]->Len - 1 + i] =
+                (int32_t)(((uint32_t)pVal[0] << 24) | ((uint32_t)pVal[1] << 16) | ((uint32_t)pVal[2] << 8)) >> 8;
+        }
+
+        for(Sec=0; Sec<DecimStageNum; Sec++)
+        {
+            pStage = pDecimStage[Sec];
+            pOut = DecimBuf[(Sec + 1) & 1];
+            OutOff = 0;
+
+            /* 下一节输入以其历史开头 */
+            if( Sec + 1 < DecimStageNum )
+            {
+                OutOff = pDecimStage[Sec + 1]->Len - 1;
+                memcpy(pOut, pHist + pStage->Len - 1, OutOff * sizeof(int32_t));
+            }
+
+            /* 每两个输入样本输出一个，对应每对中的后一个 */
+            for(i=0; i<(Len >> 1); i++)
+                pOut[OutOff + i] = EEGDecim_Halfband(pStage, pIn + 2 * i + 1);
+
+            /* 本节历史更新为输入末尾L-1个样本 */
+            memcpy(pHist, pIn + Len, (pStage->Len - 1) * sizeof(int32_t));
+
+            pHist += pStage->Len - 1;
+            pIn = pOut;
+            Len >>= 1;
+        }
+
+        /* 输出饱和到int24写回 */
+        for(i=0; i<Len; i++)
+        {
+            x = pIn[i];
+            if( x > 0x7FFFFF )
+                x = 0x7FFFFF;
+            else if( x < -0x800000 )
+                x = -0x800000;
+
+            pVal = pChannelVal[i] + Offset;
+            pVal[0] = (uint8_t)(x >> 16);
+            pVal[1] = (uint8_t)(x >> 8);
+            pVal[2] = (uint8_t)x;
+        }
+    }
+
+    /* 通道状态字节 */
+    for(i=0; i<RawNum / DecimRatio; i++)
+    {
+        for(Grp=0; Grp<UDP_CHGROUP_NUM; Grp++)
+            memcpy(pChannelVal[i] + Grp * UDP_CHGROUP_SIZE,
+                   pChannelVal[(i + 1) * DecimRatio - 1] + Grp * UDP_CHGROUP_SIZE, 3);
+    }
+}
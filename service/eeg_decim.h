@@ -0,0 +1,53 @@
+/**
+ * @file    eeg_decim.h
+ * @author  gjmsilly
+ * @brief   NanoEEG 过采样抽取（ADS1299高速率采集，级联半带FIR逐块抽取到输出采样率）
+ * @version 1.0.0
+ * @date    2022-05-03
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef SERVICE_EEG_DECIM_H_
+#define SERVICE_EEG_DECIM_H_
+/*******************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <protocol/eegdata_protocol.h>
+
+/*******************************************************************
+ * CONSTANTS
+ */
+/*!
+    ADS1299最高采集速率：SPI 10MHz读取一个样本（UDP_SampleValSize字节）须在一个采样周期内完成，
+    x8 21.6us、x16 43.2us可用16kSPS（62.5us），x24 64.8us、x32 86.4us只能用8kSPS（125us）
+ */
+#if (CHANNEL_NUM <= 16)
+#define EEG_DECIM_ADC_RATE_MAX      16000
+#define EEG_DECIM_STAGE_MAX         6                               //!< 最多级联半带节数，log2(64)
+#else
+#define EEG_DECIM_ADC_RATE_MAX      8000
+#define EEG_DECIM_STAGE_MAX         5                               //!< 最多级联半带节数，log2(32)
+#endif
+
+#define EEG_DECIM_RATIO_MAX         (EEG_DECIM_ADC_RATE_MAX / 250)  //!< 最大抽取比（输出250SPS时），2的幂
+
+/* 半带节阶数（抽头数），抽取比2^S时前S-2节为EARLY，倒数第二节为MID，最后一节为FINAL */
+#define EEG_DECIM_TAPS_EARLY        19      //!< 输入速率不低于8倍输出采样率，阻带衰减>100dB
+#define EEG_DECIM_TAPS_MID          27      //!< 输入速率为4倍输出采样率，阻带衰减>99dB
+#define EEG_DECIM_TAPS_FINAL        59      //!< 输入速率为2倍输出采样率，通带0~0.4fs，阻带0.6fs起衰减>89dB
+
+#define EEG_DECIM_HIST_MAX          ((EEG_DECIM_STAGE_MAX - 2) * (EEG_DECIM_TAPS_EARLY - 1) + \
+                                     (EEG_DECIM_TAPS_MID - 1) + (EEG_DECIM_TAPS_FINAL - 1)) //!< 每通道各节历史样本总数上限
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+bool EEGDecim_Config(uint8_t Ratio);
+uint32_t EEGDecim_GroupDelay(void);
+void EEGDecim_BlockProcess(uint8_t (*pChannelVal)[UDP_SampleValSize], uint16_t RawNum);
+
+#endif /* SERVICE_EEG_DECIM_H_ */
@@ -0,0 +1,262 @@
+/**
+ * @file    eeg_filter.c
+ * @author  gjmsilly
+ * @brief   NanoEEG 设备端脑电滤波（级联双二阶IIR：工频陷波、高通、低通，Q30定点）
+ * @version 1.0.0
+ * @date    2022-04-25
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*******************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "eeg_filter.h"
+#include <protocol/eegdata_protocol.h>
+
+/*******************************************************************
+ *  LOCAL VARIABLES
+ */
+
+/*!
+    \brief  双二阶节系数表 [方案][采样率 250/500/1000/2000SPS]，Q30
+            按RBJ Audio EQ Cookbook以双线性变换设计（预畸变），Butterworth节Q=1/√2
+ */
+static const EEGBiquadCoef_t NotchCoefTbl[2][4] = {
+    /* 50Hz */
+    {{  1048805003,  -648197140,  1048805003,  -648197140,  1023868182 },
+     {  1058192082, -1712190755,  1058192082, -1712190755,  1042642339 },
+     {  1065510304, -2026721036,  1065510304, -2026721036,  1057278784 },
+     {  1069558927, -2112781764,  1069558927, -2112781764,  1065376030 }},
+    /* 60Hz */
+    {{  1047603419,  -131559126,  1047603419,  -131559126,  1021465013 },
+     {  1055675337, -1539108402,  1055675337, -1539108402,  1037608849 },
+     {  1063950169, -1978471700,  1063950169, -1978471700,  1054158515 },
+     {  1068735298, -2099610116,  1068735298, -2099610116,  1063728773 }},
+};
+
+static const EEGBiquadCoef_t HpCoefTbl[3][4] = {
+    /* 0.1Hz */
+    {{  1071835315, -2143670630,  1071835315, -2143667245,  1069932191 },
+     {  1072788146, -2145576292,  1072788146, -2145575445,  1071835315 },
+     {  1073264879, -2146529758,  1073264879, -2146529546,  1072788146 },
+     {  1073503325, -2147006650,  1073503325, -2147006597,  1073264879 }},
+    /* 0.5Hz */
+    {{  1064243069, -2128486138,  1064243069, -2128402107,  1054828346 },
+     {  1068981896, -2137963793,  1068981896, -2137942692,  1064243070 },
+     {  1071359217, -2142718434,  1071359217, -2142713147,  1068981897 },
+     {  1072549859, -2145099718,  1072549859, -2145098394,  1071359217 }},
+    /* 1Hz */
+    {{  1054828333, -2109656665,  1054828333, -2109323487,  1036248020 },
+     {  1064243069, -2128486138,  1064243069, -2128402107,  1054828346 },
+     {  1068981896, -2137963793,  1068981896, -2137942692,  1064243070 },
+     {  1071359217, -2142718434,  1071359217, -2142713147,  1068981897 }},
+};
+
+static const EEGBiquadCoef_t LpCoefTbl[3][4] = {
+    /* 35Hz */
+    {{   126004716,   252009432,   126004716,  -886086522,   316363563 },
+     {    39271931,    78543862,    39271931, -1493462436,   576808336 },
+     {    11201719,    22403437,    11201719, -1815693534,   786758584 },
+     {     3008728,     6017457,     3008728, -1980815729,   919108819 }},
+    /* 70Hz */
+    {{   376181559,   752363118,   376181559,   237461695,   193522716 },
+     {   126004716,   252009432,   126004716,  -886086522,   316363563 },
+     {    39271931,    78543862,    39271931, -1493462436,   576808336 },
+     {    11201719,    22403437,    11201719, -1815693534,   786758584 }},
+    /* 100Hz */
+    {{   686062534,  1372125067,   686062534,  1227265970,   443242341 },
+     {   221805086,   443610172,   221805086,  -396777000,   210255520 },
+     {    72429549,   144859098,    72429549, -1227265970,   443242341 },
+     {    21564350,    43128699,    21564350, -1676130396,   688645970 }},
+};
+
+static EEGBiquadCoef_t      FilterCoef[EEG_FILTER_SECTION_MAX];                 //!< 级联各节系数
+static uint8_t              FilterSectionNum;                                   //!< 级联节数，0为不滤波
+static EEGBiquadState_t     FilterState[CHANNEL_NUM][EEG_FILTER_SECTION_MAX];   //!< 逐通道逐节状态
+
+/*******************************************************************
+ *  LOCAL FUNCTIONS
+ */
+
+/*!
+    \brief  EEGFilter_RateIndex
+
+    \return 系数表采样率下标，不支持的采样率返回-1
+ */
+static int8_t EEGFilter_RateIndex(uint16_t Samplerate)
+{
+    switch(Samplerate)
+    {
+        case 250:   return 0;
+        case 500:   return 1;
+        case 1000:  return 2;
+        case 2000:  return 3;
+        default:    return -1;
+    }
+}
+
+/*!
+    \brief  EEGFilter_Design
+
+    按滤波方案取出级联各节系数（陷波、高通、低通顺序）
+
+    \param  pCoef - 各节系数（to be returned），至少EEG_FILTER_SECTION_MAX节
+
+    \return 级联节数，采样率不支持或方案非法返回-1
+ */
+static int8_t EEGFilter_Design(EEGBiquadCoef_t *pCoef, uint16_t Samplerate,
+                               uint8_t Notch, uint8_t Highpass, uint8_t Lowpass)
+{
+    int8_t Rate = EEGFilter_RateIndex(Samplerate);
+    int8_t Num = 0;
+
+    if( !EEGFilter_IsSupported(Samplerate, Notch, Highpass, Lowpass) )
+        return -1;
+
+    if( Notch != EEG_FILTER_NOTCH_OFF )
+        pCoef[Num++] = NotchCoefTbl[Notch - 1][Rate];
+    if( Highpass != EEG_FILTER_HP_OFF )
+        pCoef[Num++] = HpCoefTbl[Highpass - 1][Rate];
+    if( Lowpass != EEG_FILTER_LP_OFF )
+        pCoef[Num++] = LpCoefTbl[Lowpass - 1][Rate];
+
+    return Num;
+}
+
+/*!
+    \brief  EEGFilter_Biquad
+
+    直接I型双二阶节：5次32x32→64位乘累加（Cortex-M4单周期SMLAL），累加器Q30截断为整数LSB。
+    截断误差e按 +2e[n-1]-e[n-2] 反馈（二阶误差整形），量化噪声传递函数为(1-z^-1)^2/A(z)，
+    抵消高通在z=1附近的双极点，0.1Hz高通在2kSPS下也不会把截断误差放大为低频漂移。
+
+    \return y[n]（整数LSB，未饱和）
+ */
+static inline int32_t EEGFilter_Biquad(const EEGBiquadCoef_t *c, EEGBiquadState_t *s, int32_t x)
+{
+    int64_t Acc;
+    int32_t y;
+
+    Acc  = (int64_t)c->b0 * x;
+    Acc += (int64_t)c->b1 * s->x1;
+    Acc += (int64_t)c->b2 * s->x2;
+    Acc -= (int64_t)c->a1 * s->y1;
+    Acc -= (int64_t)c->a2 * s->y2;
+    Acc += 2 * (int64_t)s->e1 - s->e2;
+
+    y = (int32_t)(Acc >> EEG_FILTER_COEF_FRAC);
+
+    s->e2 = s->e1;
+    s->e1 = (int32_t)(Acc - ((int64_t)y << EEG_FILTER_COEF_FRAC));
+    s->x2 = s->x1;
+    s->x1 = x;
+    s->y2 = s->y1;
+    s->y1 = y;
+
+    return y;
+}
+
+/*******************************************************************
+ *  FUNCTIONS
+ */
+
+/*!
+    \brief  EEGFilter_IsSupported
+
+    滤波方案能否在该采样率下实现，供属性层写滤波方案及采样率时校验。
+    全部关闭时任意采样率均可；任一节启用时采样率须为系数表中的250/500/1000/2000SPS。
+
+    \param  Samplerate - 采样率
+            Notch      - 工频陷波 @ref EEG_FILTER_NOTCH_OFF
+            Highpass   - 高通 @ref EEG_FILTER_HP_OFF
+            Lowpass    - 低通 @ref EEG_FILTER_LP_OFF
+
+    \return true - 支持
+ */
+bool EEGFilter_IsSupported(uint16_t Samplerate, uint8_t Notch, uint8_t Highpass, uint8_t Lowpass)
+{
+    if( (Notch > EEG_FILTER_NOTCH_60HZ) || (Highpass > EEG_FILTER_HP_1HZ) || (Lowpass > EEG_FILTER_LP_100HZ) )
+        return false;
+
+    if( (Notch == EEG_FILTER_NOTCH_OFF) && (Highpass == EEG_FILTER_HP_OFF) && (Lowpass == EEG_FILTER_LP_OFF) )
+        return true;
+
+    return (EEGFilter_RateIndex(Samplerate) >= 0);
+}
+
+/*!
+    \brief  EEGFilter_Config
+
+    配置滤波方案并清零各通道状态，须在开始采集之前调用（采样线程不加锁访问）。
+
+    \param  Samplerate - 采样率
+            Notch      - 工频陷波 @ref EEG_FILTER_NOTCH_OFF
+            Highpass   - 高通 @ref EEG_FILTER_HP_OFF
+            Lowpass    - 低通 @ref EEG_FILTER_LP_OFF
+
+    \return true - 配置完成（全部关闭时不滤波）
+            false - 采样率不支持或方案非法（属性层已按EEGFilter_IsSupported()校验），不滤波
+ */
+bool EEGFilter_Config(uint16_t Samplerate, uint8_t Notch, uint8_t Highpass, uint8_t Lowpass)
+{
+    int8_t Num;
+
+    Num = EEGFilter_Design(FilterCoef, Samplerate, Notch, Highpass, Lowpass);
+
+    FilterSectionNum = (Num < 0) ? 0 : (uint8_t)Num;
+    memset(FilterState, 0, sizeof(FilterState));
+
+    return (Num >= 0);
+}
+
+/*!
+    \brief  EEGFilter_IsEnabled
+
+    \return true - 至少一节滤波器启用
+ */
+bool EEGFilter_IsEnabled(void)
+{
+    return (FilterSectionNum != 0);
+}
+
+/*!
+    \brief  EEGFilter_SamplePut
+
+    原位滤波一个样本，由采样线程在写入UDP发送环形缓冲区之前调用。
+    逐通道取出大端int24，依次经过各节，结果饱和到int24写回，通道状态字节不变。
+
+    \param  pChannelVal - 一个样本的ADS1299输出（逐通道组：状态3字节 + 8通道 x 大端int24）
+ */
+void EEGFilter_SamplePut(uint8_t *pChannelVal)
+{
+    uint8_t *pVal;
+    int32_t x;
+    uint8_t Ch, Sec;
+
+    if( FilterSectionNum == 0 )
+        return;
+
+    for(Ch=0; Ch<CHANNEL_NUM; Ch++)
+    {
+        pVal = pChannelVal + (Ch >> 3) * UDP_CHGROUP_SIZE + 3 + (Ch & 0x07) * 3;
+        x = (int32_t)(((uint32_t)pVal[0] << 24) | ((uint32_t)pVal[1] << 16) | ((uint32_t)pVal[2] << 8)) >> 8;
+
+        for(Sec=0; Sec<FilterSectionNum; Sec++)
+            x = EEGFilter_Biquad(&FilterCoef[Sec], &FilterState[Ch][Sec], x);
+
+        if( x > 0x7FFFFF )
+            x = 0x7FFFFF;
+        else if( x < -0x800000 )
+            x = -0x800000;
+
+        pVal[0] = (uint8_t)(x >> 16);
+        pVal[1] = (uint8_t)(x >> 8);
+        pVal[2] = (uint8_t)x;
+    }
+}
@@ -0,0 +1,81 @@
+/**
+ * @file    eeg_filter.h
+ * @author  gjmsilly
+ * @brief   NanoEEG 设备端脑电滤波（级联双二阶IIR：工频陷波、高通、低通，Q30定点）
+ * @version 1.0.0
+ * @date    2022-04-25
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef SERVICE_EEG_FILTER_H_
+#define SERVICE_EEG_FILTER_H_
+/*******************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************
+ * CONSTANTS
+ */
+/* 工频陷波 @ref 属性 FILTER_NOTCH */
+#define EEG_FILTER_NOTCH_OFF        0           //!< 不陷波
+#define EEG_FILTER_NOTCH_50HZ       1           //!< 50Hz陷波，Q=20（-3dB带宽2.5Hz）
+#define EEG_FILTER_NOTCH_60HZ       2           //!< 60Hz陷波，Q=20（-3dB带宽3Hz）
+
+/* 高通 @ref 属性 FILTER_HP，二阶Butterworth */
+#define EEG_FILTER_HP_OFF           0           //!< 不滤波（保留直流）
+#define EEG_FILTER_HP_0HZ1          1           //!< 截止频率0.1Hz
+#define EEG_FILTER_HP_0HZ5          2           //!< 截止频率0.5Hz
+#define EEG_FILTER_HP_1HZ           3           //!< 截止频率1Hz
+
+/* 低通 @ref 属性 FILTER_LP，二阶Butterworth */
+#define EEG_FILTER_LP_OFF           0           //!< 不滤波
+#define EEG_FILTER_LP_35HZ          1           //!< 截止频率35Hz
+#define EEG_FILTER_LP_70HZ          2           //!< 截止频率70Hz
+#define EEG_FILTER_LP_100HZ         3           //!< 截止频率100Hz
+
+#define EEG_FILTER_SECTION_MAX      3           //!< 最多级联节数（陷波、高通、低通各一节）
+#define EEG_FILTER_COEF_FRAC        30          //!< 系数小数位数，Q30可表示[-2, 2)
+
+/*******************************************************************
+ * TYPEDEFS
+ */
+
+/*!
+    \brief  双二阶节系数（Q30）
+            H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2)
+ */
+typedef struct
+{
+    int32_t     b0;
+    int32_t     b1;
+    int32_t     b2;
+    int32_t     a1;
+    int32_t     a2;
+} EEGBiquadCoef_t;
+
+/*!
+    \brief  双二阶节状态（直接I型，每通道每节一份）
+ */
+typedef struct
+{
+    int32_t     x1;                     //!< x[n-1]
+    int32_t     x2;                     //!< x[n-2]
+    int32_t     y1;                     //!< y[n-1]
+    int32_t     y2;                     //!< y[n-2]
+    int32_t     e1;                     //!< 量化误差 e[n-1]（Q30，0~2^30-1）
+    int32_t     e2;                     //!< 量化误差 e[n-2]
+} EEGBiquadState_t;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+bool EEGFilter_IsSupported(uint16_t Samplerate, uint8_t Notch, uint8_t Highpass, uint8_t Lowpass);
+bool EEGFilter_Config(uint16_t Samplerate, uint8_t Notch, uint8_t Highpass, uint8_t Lowpass);
+bool EEGFilter_IsEnabled(void);
+void EEGFilter_SamplePut(uint8_t *pChannelVal);
+
+#endif /* SERVICE_EEG_FILTER_H_ */
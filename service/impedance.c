@@ -0,0 +1,283 @@
+/**
+ * @file    impedance.c
+ * @author  gjmsilly
+ * @brief   NanoEEG 电极阻抗测量服务（交流导联脱落激励 + 定点Goertzel解调）
+ * @version 1.0.0
+ * @date    2022-04-18
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*******************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "impedance.h"
+#include <attr/attrTbl.h>
+#include <protocol/eegdata_protocol.h>
+
+/*******************************************************************
+ *  LOCAL VARIABLES
+ */
+
+/*!
+    \brief  Goertzel系数 - 激励周期P个样本时 cos(2π/P)、sin(2π/P)，Q30
+            采样率250~2000SPS、激励7.8125/31.25Hz时P为8~256
+            ADS1299 sinc3数字滤波器在激励频率（fDR/P）处的衰减 sinc(1/P)^3 由增益补偿
+ */
+static const struct
+{
+    uint16_t    Period;             //!< 激励周期样本数
+    int32_t     CosQ30;             //!< cos(2π/P) Q30
+    int32_t     SinQ30;             //!< sin(2π/P) Q30
+    uint16_t    GainQ14;            //!< 1 / sinc(1/P)^3 Q14
+} ImpCoefTbl[] = {
+    {   8,  759250125,  759250125, 17704 },
+    {  16,  992008094,  410903207, 16703 },
+    {  32, 1053110176,  209476638, 16463 },
+    {  64, 1068571464,  105245103, 16404 },
+    { 128, 1072448455,   52686014, 16389 },
+    { 256, 1073418433,   26350943, 16385 },
+};
+
+static volatile bool    ImpRunning;                 //!< 测量中
+static int32_t          ImpCos;                     //!< cos(ω) Q30
+static int32_t          ImpSin;                     //!< sin(ω) Q30
+static uint16_t         ImpGain;                    //!< 数字滤波器衰减补偿 Q14
+static uint16_t         ImpBlockLen;                //!< 解调块样本数N（整数个激励周期）
+static uint16_t         ImpBlockIdx;                //!< 解调块内样本序号
+static uint32_t         ImpIntervalLen;             //!< 刷新间隔样本数
+static uint32_t         ImpIntervalIdx;             //!< 刷新间隔内样本计数
+static int64_t          ImpS1[CHANNEL_NUM];         //!< Goertzel状态 s[n-1]
+static int64_t          ImpS2[CHANNEL_NUM];         //!< Goertzel状态 s[n-2]
+static uint64_t         ImpAmpSum[CHANNEL_NUM];     //!< 本刷新间隔各解调块基波幅值累加（LSB）
+static uint16_t         ImpBlockCnt;                //!< 本刷新间隔完成的解调块数
+static uint32_t         ImpClipMask;                //!< 本刷新间隔饱和的通道
+
+/*******************************************************************
+ *  EXTERNAL VARIABLES
+ */
+
+/*******************************************************************
+ *  LOCAL FUNCTIONS
+ */
+
+/*!
+    \brief  MulQ30
+
+    64位状态与Q30系数相乘，分高低两段计算避免中间结果溢出
+
+    \return (c * s) >> 30
+ */
+static int64_t MulQ30(int32_t c, int64_t s)
+{
+    return ((int64_t)c * (s >> 16) >> 14) + ((int64_t)c * (s & 0xFFFF) >> 30);
+}
+
+/*!
+    \brief  ISqrt64
+
+    \return floor(sqrt(v))
+ */
+static uint32_t ISqrt64(uint64_t v)
+{
+    uint64_t Root = 0;
+    uint64_t Bit = (uint64_t)1 << 62;
+
+    while(Bit > v)
+        Bit >>= 2;
+
+    while(Bit)
+    {
+        if(v >= Root + Bit)
+        {
+            v -= Root + Bit;
+            Root = (Root >> 1) + Bit;
+        }
+        else
+            Root >>= 1;
+        Bit >>= 2;
+    }
+
+    return (uint32_t)Root;
+}
+
+/*!
+    \brief  Imp_BlockEnd
+
+    一个解调块结束：由Goertzel状态求基波幅值并累加，清零状态。
+    解调块为整数个激励周期，激励频率恰在DFT频点上，直流偏置不进入结果。
+ */
+static void Imp_BlockEnd(void)
+{
+    int64_t Re, Im;
+    uint8_t Ch;
+
+    for(Ch=0; Ch<CHANNEL_NUM; Ch++)
+    {
+        Re = ImpS1[Ch] - MulQ30(ImpCos, ImpS2[Ch]);
+        Im = MulQ30(ImpSin, ImpS2[Ch]);
+
+        /* |X| = N x A / 2，|X| < 2^31，平方和不溢出 */
+        ImpAmpSum[Ch] += (uint64_t)ISqrt64((uint64_t)(Re * Re) + (uint64_t)(Im * Im)) * 2 / ImpBlockLen;
+
+        ImpS1[Ch] = 0;
+        ImpS2[Ch] = 0;
+    }
+
+    ImpBlockCnt++;
+}
+
+/*!
+    \brief  Imp_Publish
+
+    刷新间隔到达：各通道平均基波幅值换算为kΩ写入属性IMPValue，并通知订阅者。
+ */
+static void Imp_Publish(void)
+{
+    float Kohm[CHANNEL_NUM];
+    uint8_t Ch;
+
+    for(Ch=0; Ch<CHANNEL_NUM; Ch++)
+    {
+        if(ImpClipMask & ((uint32_t)1 << Ch))
+            Kohm[Ch] = IMP_KOHM_CLIPPED;
+        else
+            Kohm[Ch] = (float)((ImpAmpSum[Ch] / ImpBlockCnt * ImpGain) >> 14) * IMP_KOHM_PER_LSB;
+
+        ImpAmpSum[Ch] = 0;
+    }
+
+    ImpBlockCnt = 0;
+    ImpClipMask = 0;
+
+    App_WriteMsgAttr(IMPVAULE, Kohm);
+    Attr_Notify(IMPVAULE);
+}
+
+/*******************************************************************
+ *  FUNCTIONS
+ */
+
+/*!
+    \brief  Imp_Start
+
+    开始阻抗测量，须在ADS1299配置为交流导联脱落激励之后、开始采集之前调用。
+    解调块取整数个激励周期且不长于IMP_BLOCK_MS，刷新间隔内各解调块的幅值取平均。
+
+    \param  Samplerate - 采样率
+            Freq       - 激励频率 @ref IMP_FREQ_7HZ8
+            IntervalMs - 刷新间隔 ms
+
+    \return true - 开始测量
+            false - 采样率下激励周期不是整数个样本
+ */
+bool Imp_Start(uint16_t Samplerate, uint8_t Freq, uint16_t IntervalMs)
+{
+    float Kohm[CHANNEL_NUM];
+    uint32_t Period;
+    uint8_t i;
+
+    /* 激励周期样本数：7.8125Hz为采样率 x 0.128，31.25Hz为采样率 x 0.032 */
+    Period = (Freq == IMP_FREQ_31HZ2) ? (uint32_t)Samplerate * 4 / 125 :
+                                        (uint32_t)Samplerate * 16 / 125;
+
+    for(i=0; i<sizeof(ImpCoefTbl)/sizeof(ImpCoefTbl[0]); i++)
+    {
+        if(ImpCoefTbl[i].Period == Period)
+            break;
+    }
+    if(i == sizeof(ImpCoefTbl)/sizeof(ImpCoefTbl[0]))
+        return false;
+
+    ImpCos = ImpCoefTbl[i].CosQ30;
+    ImpSin = ImpCoefTbl[i].SinQ30;
+    ImpGain = ImpCoefTbl[i].GainQ14;
+
+    ImpBlockLen = (uint16_t)Period * (uint16_t)((uint32_t)Samplerate * IMP_BLOCK_MS / 1000 / Period);
+    if(ImpBlockLen == 0)
+        ImpBlockLen = (uint16_t)Period;
+
+    ImpIntervalLen = (uint32_t)Samplerate * IntervalMs / 1000;
+    if(ImpIntervalLen < ImpBlockLen)
+        ImpIntervalLen = ImpBlockLen;
+
+    ImpBlockIdx = 0;
+    ImpIntervalIdx = 0;
+    ImpBlockCnt = 0;
+    ImpClipMask = 0;
+    memset(ImpS1, 0, sizeof(ImpS1));
+    memset(ImpS2, 0, sizeof(ImpS2));
+    memset(ImpAmpSum, 0, sizeof(ImpAmpSum));
+    memset(Kohm, 0, sizeof(Kohm));
+    App_WriteMsgAttr(IMPVAULE, Kohm);
+
+    ImpRunning = true;
+
+    return true;
+}
+
+/*!
+    \brief  Imp_Stop
+
+    停止阻抗测量，须在ADS1299停止采集之后调用。属性IMPValue保留最后一次结果。
+ */
+void Imp_Stop(void)
+{
+    ImpRunning = false;
+}
+
+/*!
+    \brief  Imp_IsRunning
+
+    \return true - 阻抗测量中，样本由本服务处理，不发送脑电数据
+ */
+bool Imp_IsRunning(void)
+{
+    return ImpRunning;
+}
+
+/*!
+    \brief  Imp_SamplePut
+
+    送入一个样本，由采样线程调用。逐通道执行Goertzel迭代
+    s[n] = x[n] + 2cos(ω)s[n-1] - s[n-2]，状态为64位定点，系数Q30。
+
+    \param  pChannelVal - 一个样本的ADS1299输出（逐通道组：状态3字节 + 8通道 x 大端int24）
+ */
+void Imp_SamplePut(const uint8_t *pChannelVal)
+{
+    const uint8_t *pVal;
+    int32_t x;
+    int64_t s0;
+    uint8_t Ch;
+
+    for(Ch=0; Ch<CHANNEL_NUM; Ch++)
+    {
+        pVal = pChannelVal + (Ch >> 3) * UDP_CHGROUP_SIZE + 3 + (Ch & 0x07) * 3;
+        x = (int32_t)(((uint32_t)pVal[0] << 24) | ((uint32_t)pVal[1] << 16) | ((uint32_t)pVal[2] << 8)) >> 8;
+
+        if((x > IMP_CLIP_LIMIT) || (x < -IMP_CLIP_LIMIT))
+            ImpClipMask |= (uint32_t)1 << Ch;
+
+        s0 = x + 2 * MulQ30(ImpCos, ImpS1[Ch]) - ImpS2[Ch];
+        ImpS2[Ch] = ImpS1[Ch];
+        ImpS1[Ch] = s0;
+    }
+
+    if(++ImpBlockIdx == ImpBlockLen)
+    {
+        ImpBlockIdx = 0;
+        Imp_BlockEnd();
+    }
+
+    if((++ImpIntervalIdx >= ImpIntervalLen) && ImpBlockCnt)
+    {
+        ImpIntervalIdx = 0;
+        Imp_Publish();
+    }
+}
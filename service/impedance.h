@@ -0,0 +1,52 @@
+/**
+ * @file    impedance.h
+ * @author  gjmsilly
+ * @brief   NanoEEG 电极阻抗测量服务（交流导联脱落激励 + 定点Goertzel解调）
+ * @version 1.0.0
+ * @date    2022-04-18
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef SERVICE_IMPEDANCE_H_
+#define SERVICE_IMPEDANCE_H_
+/*******************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************
+ * CONSTANTS
+ */
+/* 激励频率 @ref 属性 IMPMEAS_MODE */
+#define IMP_FREQ_7HZ8               0           //!< 交流激励 fCLK/2^18 = 7.8125Hz
+#define IMP_FREQ_31HZ2              1           //!< 交流激励 fCLK/2^16 = 31.25Hz
+
+/* 刷新间隔 @ref 属性 IMPMEAS_INTERVAL */
+#define IMP_INTERVAL_DEFAULT        1000        //!< 默认刷新间隔 ms
+#define IMP_INTERVAL_MIN            200         //!< 最小刷新间隔 ms，不短于一个解调块
+#define IMP_INTERVAL_MAX            10000       //!< 最大刷新间隔 ms
+
+/* 解调参数 */
+#define IMP_BLOCK_MAX               256         //!< 解调块最大样本数（整数个激励周期）
+#define IMP_BLOCK_MS                125         //!< 解调块目标时长 ms
+#define IMP_CLIP_LIMIT              0x7FFF00    //!< 量化值绝对值超过该值视为饱和
+#define IMP_KOHM_CLIPPED            (-1.0f)     //!< 饱和（电极脱落或阻抗超量程）时的阻抗值
+
+/*!
+    每LSB对应的阻抗 kΩ：增益1时LSB = 2 x VREF(4.5V) / 2^24，
+    方波激励电流6uA的基波幅值为 4/π x 6uA，阻抗 = 基波电压幅值 / 基波电流幅值
+ */
+#define IMP_KOHM_PER_LSB            (4.5f / 8388608.0f * 3.14159265f / 4.0f / 6e-6f / 1000.0f)
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+bool Imp_Start(uint16_t Samplerate, uint8_t Freq, uint16_t IntervalMs);
+void Imp_Stop(void);
+bool Imp_IsRunning(void);
+void Imp_SamplePut(const uint8_t *pChannelVal);
+
+#endif /* SERVICE_IMPEDANCE_H_ */
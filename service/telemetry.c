@@ -0,0 +1,272 @@
+/**
+ * @file    telemetry.c
+ * @author  gjmsilly
+ * @brief   NanoEEG 运行统计（逐线程CPU占用、栈使用峰值、数据通路时延直方图）
+ *
+ *          CPU占用：各线程在阻塞等待前后调用 Telem_TaskIdle / Telem_TaskBusy，
+ *          以DWT周期计数器累计唤醒至再次阻塞的时长。内核配置（Load模块、任务切换钩子）
+ *          不在本工程中，故在应用层统计，所得为线程处理时长，含被高优先级线程及中断抢占的时间。
+ *          栈使用峰值：内核创建线程时以填充字初始化栈，Task_stat() 扫描得出。
+ *          时延直方图：以系统时间计，按2的幂分档，由采样线程和UDP1线程各自写入。
+ *          统计结果写入诊断属性并推送订阅者，见 @ref attr/README.md
+ * @version 1.0.0
+ * @date    2022-05-24
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <ti/sysbios/knl/Task.h>
+#include <ti/devices/cc32xx/inc/hw_types.h>
+
+#include <service/timestamp.h>
+#include <service/trace.h>
+#include <attr/attrTbl.h>
+
+#include "telemetry.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+/* Cortex-M4 DWT周期计数器 */
+#define TELEM_DEMCR                 0xE000EDFC  //!< Debug Exception and Monitor Control Register
+#define TELEM_DEMCR_TRCENA          0x01000000  //!< 使能DWT
+#define TELEM_DWT_CTRL              0xE0001000  //!< DWT控制寄存器
+#define TELEM_DWT_CYCCNTENA         0x00000001  //!< 使能周期计数
+#define TELEM_DWT_CYCCNT            0xE0001004  //!< 周期计数值，80MHz下约53.7s回绕
+
+/*!
+    刷新最小间隔（周期数）：控制线程属性消息频繁时每次处理后都会调用 Telem_Update，
+    限速为约每统计周期一次；取统计周期的7/8，超时唤醒早于统计周期时不漏刷新
+ */
+#define TELEM_UPDATE_MIN_CYCLES     ((uint32_t)TELEM_CPU_FREQ / 8 * 7 * TELEM_PERIOD_S)
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct
+{
+    Task_Handle         Handle;         //!< 线程句柄，未注册为NULL
+    uint32_t            BusyStart;      //!< 本次唤醒时刻（周期计数值）
+    volatile uint32_t   BusyCycles;     //!< 处理时长累计（周期数，模2^32）- 仅由该线程修改
+    uint32_t            BusyLast;       //!< 上次刷新时的处理时长累计 - 仅由控制线程修改
+}TelemTask_t;
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static TelemTask_t      TelemTask[TELEM_TASK_NUM];
+static uint32_t         TelemLastUpdate;                //!< 上次刷新时刻（周期计数值）
+static uint32_t         TelemLatNotified[TELEM_LAT_NUM]; //!< 上次推送时各直方图的样本数
+static LatencyHist_t    TelemLatency[TELEM_LAT_NUM];    //!< 时延直方图 - 每次记录后整体写入属性
+
+/*********************************************************************
+ *  EXTERNAL VARIABLES
+ */
+extern SampleTime_t *pSampleTime;
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+
+/*!
+    \brief  Telem_Cycles
+
+    自由运行的时钟，不随采样启停，可在中断中调用 @ref 跟踪记录时间
+
+    \return DWT周期计数值（80MHz）
+ */
+uint32_t Telem_Cycles(void)
+{
+    return HWREG(TELEM_DWT_CYCCNT);
+}
+
+/*!
+    \brief  TelemHistAttr
+
+    \return 直方图对应的属性编号
+ */
+static uint8_t TelemHistAttr(uint8_t Hist)
+{
+    return (Hist == TELEM_LAT_ACQ) ? LATENCY_ACQ : LATENCY_TX;
+}
+
+/*!
+    \brief  TelemHistCount
+
+    \return 直方图样本总数
+ */
+static uint32_t TelemHistCount(const LatencyHist_t *pHist)
+{
+    uint32_t Sum = 0;
+    uint8_t Bin;
+
+    for(Bin=0; Bin<LATENCY_BIN_NUM; Bin++)
+        Sum += pHist->Count[Bin];
+
+    return Sum;
+}
+
+/*!
+    \brief  Telem_Init
+
+    使能DWT周期计数器，须在创建各线程前调用
+ */
+void Telem_Init(void)
+{
+    HWREG(TELEM_DEMCR) |= TELEM_DEMCR_TRCENA;
+    HWREG(TELEM_DWT_CYCCNT) = 0;
+    HWREG(TELEM_DWT_CTRL) |= TELEM_DWT_CYCCNTENA;
+
+    memset(TelemTask, 0, sizeof(TelemTask));
+    TelemLastUpdate = Telem_Cycles();
+}
+
+/*!
+    \brief  Telem_TaskRegister
+
+    由各线程入口调用，登记线程句柄，此后线程视为处理中直至首次 Telem_TaskIdle
+
+    \param  Task - 线程 @ref TELEM_TASK_TCP ...
+ */
+void Telem_TaskRegister(uint8_t Task)
+{
+    TelemTask_t *pTask = &TelemTask[Task];
+
+    pTask->BusyStart = Telem_Cycles();
+    pTask->Handle = Task_self();
+}
+
+/*!
+    \brief  Telem_TaskBusy
+
+    线程从阻塞等待返回，开始处理
+
+    \param  Task - 线程 @ref TELEM_TASK_TCP ...
+ */
+void Telem_TaskBusy(uint8_t Task)
+{
+    TelemTask[Task].BusyStart = Telem_Cycles();
+}
+
+/*!
+    \brief  Telem_TaskIdle
+
+    线程处理完毕，即将阻塞等待，累计本次处理时长
+
+    \param  Task - 线程 @ref TELEM_TASK_TCP ...
+ */
+void Telem_TaskIdle(uint8_t Task)
+{
+    TelemTask_t *pTask = &TelemTask[Task];
+
+    pTask->BusyCycles += Telem_Cycles() - pTask->BusyStart;
+}
+
+/*!
+    \brief  Telem_Update
+
+    由控制线程每次唤醒后调用，距上次刷新满约一个统计周期时：
+    按统计周期内各线程处理时长计算CPU占用，读取各线程栈使用峰值，写入属性TASK_STAT并推送；
+    时延直方图有新样本时推送属性LATENCY_ACQ、LATENCY_TX。
+    仍在处理中的线程本次处理时长计入其阻塞后的统计周期。
+ */
+void Telem_Update(void)
+{
+    uint32_t Now = Telem_Cycles();
+    uint32_t Elapsed = Now - TelemLastUpdate;
+    uint32_t Busy, Count;
+    uint64_t Load;
+    Task_Stat Stat;
+    TaskStat_t TaskStat[TELEM_TASK_NUM];
+    uint8_t i;
+
+    if( Elapsed < TELEM_UPDATE_MIN_CYCLES )
+        return;
+    TelemLastUpdate = Now;
+
+    memset(TaskStat, 0, sizeof(TaskStat));
+    for(i=0; i<TELEM_TASK_NUM; i++)
+    {
+        TelemTask_t *pTask = &TelemTask[i];
+
+        if( pTask->Handle == NULL )
+            continue; //!< 网络就绪前线程尚未创建
+
+        Busy = pTask->BusyCycles;
+        Load = (uint64_t)(Busy - pTask->BusyLast) * 1000 / Elapsed;
+        pTask->BusyLast = Busy;
+
+        Task_stat(pTask->Handle, &Stat);
+        TaskStat[i].Load_pm = (uint16_t)((Load > 1000) ? 1000 : Load);
+        TaskStat[i].StackPeak = (uint16_t)Stat.used;
+        TaskStat[i].StackSize = (uint16_t)Stat.stackSize;
+    }
+    App_WriteMsgAttr(TASK_STAT, TaskStat);
+    Attr_Notify(TASK_STAT);
+    Trace_Put(TRACE_TICK, 0, 0); //!< 跟踪记录时间展开参考
+
+    for(i=0; i<TELEM_LAT_NUM; i++)
+    {
+        Count = TelemHistCount(&TelemLatency[i]);
+        if( Count != TelemLatNotified[i] )
+        {
+            TelemLatNotified[i] = Count;
+            Attr_Notify(TelemHistAttr(i));
+        }
+    }
+}
+
+/*!
+    \brief  Telem_LatencyReset
+
+    清空时延直方图，由控制线程在开始采样（系统时间清零后重新计时）前调用
+ */
+void Telem_LatencyReset(void)
+{
+    uint8_t i;
+
+    memset(TelemLatency, 0, sizeof(TelemLatency));
+    memset(TelemLatNotified, 0, sizeof(TelemLatNotified));
+    for(i=0; i<TELEM_LAT_NUM; i++)
+        App_WriteMsgAttr(TelemHistAttr(i), &TelemLatency[i]);
+}
+
+/*!
+    \brief  Telem_LatencyPut
+
+    记录一次时延：起点至当前系统时间，并整体写入对应属性。每个直方图只由一个线程写入。
+    第0档为2us以下，第k档为[2^k, 2^(k+1))us，最后一档含32.768ms及以上。
+    起点晚于当前时间（期间停止采样，系统时间已清零）时不计。
+
+    \param  Hist      - 直方图 @ref TELEM_LAT_ACQ TELEM_LAT_TX
+            StartTime - 起点（64位系统时间）
+ */
+void Telem_LatencyPut(uint8_t Hist, uint64_t StartTime)
+{
+    LatencyHist_t *pHist = &TelemLatency[Hist];
+    uint64_t Now = SampleTimestamp_Get(pSampleTime);
+    uint32_t Delay_us, v;
+    uint8_t Bin = 0;
+
+    if( StartTime > Now )
+        return;
+
+    Delay_us = (uint32_t)((Now - StartTime) / SAMPLE_TICK_PER_US);
+
+    for(v = Delay_us >> 1; v && (Bin < LATENCY_BIN_NUM - 1); v >>= 1)
+        Bin++;
+
+    pHist->Count[Bin]++;
+    if( Delay_us > pHist->Max_us )
+        pHist->Max_us = Delay_us;
+
+    App_WriteMsgAttr(TelemHistAttr(Hist), pHist);
+}
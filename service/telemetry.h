@@ -0,0 +1,54 @@
+/**
+ * @file    telemetry.h
+ * @author  gjmsilly
+ * @brief   NanoEEG 运行统计（逐线程CPU占用、栈使用峰值、数据通路时延直方图）
+ * @version 1.0.0
+ * @date    2022-05-24
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef SERVICE_TELEMETRY_H_
+#define SERVICE_TELEMETRY_H_
+/*******************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************
+ * CONSTANTS
+ */
+/* 统计的线程 @ref 属性 TASK_STAT，即SimpleLinkNetAppEventHandler创建的线程 */
+#define TELEM_TASK_TCP              0           //!< tcpHandler  TCP控制通道监听
+#define TELEM_TASK_UDP1             1           //!< udp1Worker  脑电数据通道
+#define TELEM_TASK_CONTROL          2           //!< controlTask 属性值变化处理
+#define TELEM_TASK_SAMPLE           3           //!< SampleTask  采集
+#define TELEM_TASK_UDP2             4           //!< udp2Worker  事件标签通道
+#define TELEM_TASK_SYNC             5           //!< SyncTask    事件标签同步
+#define TELEM_TASK_DETECT           6           //!< DetectTask  设备探测
+#define TELEM_TASK_NUM              7
+
+/* 时延直方图 */
+#define TELEM_LAT_ACQ               0           //!< nDRDY → 一包封包完毕 @ref 属性 LATENCY_ACQ
+#define TELEM_LAT_TX                1           //!< 封包完毕 → sendto返回 @ref 属性 LATENCY_TX
+#define TELEM_LAT_NUM               2
+
+/* 统计周期 */
+#define TELEM_PERIOD_S              1           //!< CPU占用与栈使用刷新间隔 s
+#define TELEM_CPU_FREQ              80000000    //!< 内核时钟 Hz，DWT周期计数器计数频率
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+void Telem_Init(void);
+uint32_t Telem_Cycles(void);
+void Telem_TaskRegister(uint8_t Task);
+void Telem_TaskBusy(uint8_t Task);
+void Telem_TaskIdle(uint8_t Task);
+void Telem_Update(void);
+void Telem_LatencyReset(void);
+void Telem_LatencyPut(uint8_t Hist, uint64_t StartTime);
+
+#endif /* SERVICE_TELEMETRY_H_ */
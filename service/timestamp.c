@@ -12,6 +12,9 @@
 /*******************************************************************
  * INCLUDES
  */
+#include <stdint.h>
+#include <stdbool.h>
+
 #include "timestamp.h"
 #include "ti_drivers_config.h"
 
@@ -42,7 +45,7 @@ static SampleTime_t SampleTime; //传递该对象地址到应用层
  */
 static void SampleTimerCB(Timer_Handle handle, int_fast16_t status)
 {
-    SampleTime.BaseTime_10us += 4000000;
+    SampleTime.OverflowCnt++;
 }
 
 
@@ -62,7 +65,8 @@ SampleTime_t* SampleTimestamp_Service_Init(Timer_Params *params)
 	
     /* CC3235S 每个32bit的timer由16bit的timerA和timerB串联构成，时钟为80MHz，最多计时约50s
      * 以us为单位计算，计数约每53687091次溢出中断，触发回调，此处设置40s触发一次中断进行软计数
-     * 写入数据帧的时间戳时间精度为 10us,处理方式为: 4000000*计时器中断次数 + 计时器当前值/800 (单位:10us)
+     * 64位时间为 计时器中断次数*SAMPLE_TIMER_PERIOD + 计时器当前值 (单位:12.5ns)，
+     * 写入数据帧的时间戳为其/800 (单位:10us) 的低32位
      * */
 
     Timer_Params_init(params);
@@ -79,6 +83,9 @@ SampleTime_t* SampleTimestamp_Service_Init(Timer_Params *params)
         while (1) {}
     }
 
+    Timer_HWAttrs const *hwAttrs = SampleTime.SampleTimer->hwAttrs;
+    SampleTime.TimerBase = hwAttrs->baseAddress;
+
     return(&SampleTime);
 
 }
@@ -93,14 +100,104 @@ SampleTime_t* SampleTimestamp_Service_Init(Timer_Params *params)
 void SampleTimestamp_Reset(SampleTime_t* SampleTime){
 
     // 清空时钟的值，TI Driver不支持，用driverlib实现
-    // pSampleTime->SampleTimer - Timer0
-    Timer_HWAttrs const *hwAttrs = SampleTime->SampleTimer->hwAttrs;
-    uint32_t TimerBase = hwAttrs->baseAddress;
+    // pSampleTime->SampleTimer - Timer0，须在定时器停止后调用
+    TimerValueSet(SampleTime->TimerBase,TIMER_A,0x00);
+    TimerValueSet(SampleTime->TimerBase,TIMER_B,0x00);
+    TimerIntClear(SampleTime->TimerBase,TIMER_TIMA_TIMEOUT);
+
+    SampleTime->OverflowCnt = 0;
+    SampleTime->SyncCnt = 0;
+
+}
+
+/*!
+     \brief SampleTimestamp_Get
+
+     读取64位系统时间，任意上下文（含中断）可调用，无锁。
+     溢出次数在读取计数值前后不一致（期间发生溢出中断）则重读；
+     计数值已回绕但溢出中断尚未处理（调用者处于更高优先级中断中）时，
+     由定时器原始中断标志补计一次溢出。
+
+     \return 64位系统时间（单位12.5ns）
+ */
+uint64_t SampleTimestamp_Get(SampleTime_t* SampleTime)
+{
+    uint32_t OverflowCnt, Cnt;
+    bool Pending;
+
+    do{
+        OverflowCnt = SampleTime->OverflowCnt;
+        Cnt = Timer_getCount(SampleTime->SampleTimer);
+        Pending = (TimerIntStatus(SampleTime->TimerBase,false) & TIMER_TIMA_TIMEOUT) != 0;
+    }while( OverflowCnt != SampleTime->OverflowCnt );
+
+    if( Pending && (Cnt < SAMPLE_TIMER_PERIOD/2) )
+        OverflowCnt++; //!< 已回绕，溢出中断待处理
+
+    return (uint64_t)OverflowCnt * SAMPLE_TIMER_PERIOD + Cnt;
+}
+
+/*!
+     \brief SampleTimestamp_SyncMark
+
+     记录当前时间为本次同步沿的同步时间Tsoc，由同步时钟中断调用（唯一写者）。
+     先写入时间再累加同步沿计数，读者据计数判断是否已被覆盖。
+
+     \return None
+ */
+void SampleTimestamp_SyncMark(SampleTime_t* SampleTime)
+{
+    uint32_t SyncCnt = SampleTime->SyncCnt;
 
-    TimerValueSet(TimerBase,TIMER_A,0x00);
-    TimerValueSet(TimerBase,TIMER_B,0x00);
+    SampleTime->SyncTime[SyncCnt & (SYNC_HIST_NUM - 1)] = SampleTimestamp_Get(SampleTime);
+    SampleTime->SyncCnt = SyncCnt + 1;
+}
+
+/*!
+     \brief SampleTimestamp_GetSyncCnt
+
+     \return 开始采样以来的同步沿个数，最近一次同步沿序号为其减1
+ */
+uint32_t SampleTimestamp_GetSyncCnt(SampleTime_t* SampleTime)
+{
+    return SampleTime->SyncCnt;
+}
+
+/*!
+     \brief SampleTimestamp_GetSyncAt
+
+     读取指定序号同步沿的同步时间Tsoc，线程上下文调用，无锁
+
+     \param  SyncIdx   - 同步沿序号
+             pSyncTime - 同步时间（单位12.5ns）（to be returned）
 
-    SampleTime->LastSyncTime_10us = 0x00;
+     \return true - 读取成功
+             false - 尚未发生或已被覆盖
+ */
+bool SampleTimestamp_GetSyncAt(SampleTime_t* SampleTime, uint32_t SyncIdx, uint64_t *pSyncTime)
+{
+    if( (uint32_t)(SampleTime->SyncCnt - SyncIdx - 1) >= SYNC_HIST_NUM )
+        return false;
+
+    *pSyncTime = SampleTime->SyncTime[SyncIdx & (SYNC_HIST_NUM - 1)];
 
+    /* 读取期间同步时钟中断覆盖了该位置 */
+    return (uint32_t)(SampleTime->SyncCnt - SyncIdx) <= SYNC_HIST_NUM;
 }
 
+/*!
+     \brief SampleTimestamp_GetSync
+
+     读取最近一次同步时间Tsoc，线程上下文调用，无锁
+
+     \return 最近一次同步时间（单位12.5ns），尚未同步时为0
+ */
+uint64_t SampleTimestamp_GetSync(SampleTime_t* SampleTime)
+{
+    uint64_t SyncTime = 0;
+
+    while( SampleTime->SyncCnt &&
+           !SampleTimestamp_GetSyncAt(SampleTime, SampleTime->SyncCnt - 1, &SyncTime) );
+
+    return SyncTime;
+}
@@ -14,8 +14,22 @@
 /*******************************************************************
  * INCLUDES
  */
+#include <stdint.h>
+#include <stdbool.h>
 #include <ti/drivers/Timer.h>
 
+/*******************************************************************
+ * CONSTANTS
+ */
+#define SAMPLE_TIMER_FREQ           80000000    //!< 系统定时器计数频率 80MHz（12.5ns）
+#define SAMPLE_TIMER_PERIOD         3200000000u //!< 系统定时器溢出周期 40s 对应的计数值
+#define SAMPLE_TICK_PER_US          80          //!< 每us计数值
+#define SAMPLE_TICK_PER_10US        800         //!< 每10us计数值
+
+#define SYNC_HIST_NUM               8           //!< 保存的同步时间个数（须为2的幂）
+
+#define SAMPLE_TICK_TO_10US(t)      ((uint32_t)((t) / SAMPLE_TICK_PER_10US)) //!< 64位时间转换为协议中的32位10us时间戳
+
 /*******************************************************************
  * TYPEDEFS
  */
@@ -24,13 +38,16 @@
     \brief  SampleTime_t
 
     每样本精密时间戳 结构体
+    64位时间 = 溢出次数 * SAMPLE_TIMER_PERIOD + 定时器当前计数值，单位12.5ns，约7万年不回绕，
+    一律经SampleTimestamp_Get()读取
  */
 typedef struct
 {
-    Timer_Handle    SampleTimer;        //!< 系统定时器
-    uint32_t        BaseTime_10us;      //!< 基础时间/10us = 计时器溢出次数*4000000
-    uint32_t        CurTimeStamp[10];   //!< 每样本当前时间
-    uint32_t        LastSyncTime_10us;  //!< 最近一次同步时间/10us Tsoc
+    Timer_Handle        SampleTimer;    //!< 系统定时器
+    uint32_t            TimerBase;      //!< 系统定时器基地址
+    volatile uint32_t   OverflowCnt;    //!< 系统定时器溢出次数 - 仅由溢出中断修改
+    volatile uint32_t   SyncCnt;        //!< 同步沿计数 - 仅由同步时钟中断修改
+    volatile uint64_t   SyncTime[SYNC_HIST_NUM]; //!< 最近若干次同步时间 Tsoc（计数值），按同步沿序号循环存放
 
 }SampleTime_t;
 
@@ -41,5 +58,10 @@ typedef struct
 /* 时间戳服务 */
 SampleTime_t* SampleTimestamp_Service_Init(Timer_Params *params);
 void SampleTimestamp_Reset(SampleTime_t* SampleTime);
+uint64_t SampleTimestamp_Get(SampleTime_t* SampleTime);
+void SampleTimestamp_SyncMark(SampleTime_t* SampleTime);
+uint64_t SampleTimestamp_GetSync(SampleTime_t* SampleTime);
+uint32_t SampleTimestamp_GetSyncCnt(SampleTime_t* SampleTime);
+bool SampleTimestamp_GetSyncAt(SampleTime_t* SampleTime, uint32_t SyncIdx, uint64_t *pSyncTime);
 
 #endif /* SERVICE_TIMESTAMP_H_ */
@@ -0,0 +1,136 @@
+/**
+ * @file    trace.c
+ * @author  gjmsilly
+ * @brief   NanoEEG 二进制跟踪记录（定长带时间戳记录，中断与线程均可写入的RAM环形缓冲区）
+ *
+ *          各跟踪点调用 Trace_Put 写入一条12字节记录，时间取DWT周期计数器，不随采样启停。
+ *          写入方只在领取序号时屏蔽中断数条指令，不使用互斥量与信号量，不阻塞，中断中亦可调用；
+ *          记录写入前序号先置为反码，写完再写入序号，读出方前后两次比对序号，
+ *          不会取到写入中或读取期间被覆盖的记录。缓冲区写满后覆盖最早的记录。
+ *          经TCP控制通道指令 Trace_Download 分段下载，格式见 @ref protocol/README.md
+ * @version 1.0.0
+ * @date    2022-05-27
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <ti/drivers/dpl/HwiP.h>
+#include <service/telemetry.h>
+
+#include "trace.h"
+
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static volatile TraceRecord_t   TraceRing[TRACE_RECORD_NUM];    //!< 环形缓冲区
+static volatile uint32_t        TraceWrSeq;                     //!< 下一条记录序号（自由计数）
+static volatile uint32_t        TraceMask = TRACE_MASK_DEFAULT; //!< 跟踪点使能 @ref 属性 TRACE_MASK
+
+/*********************************************************************
+ *  FUNCTIONS
+ */
+
+/*!
+    \brief  Trace_MaskSet
+
+    \param  Mask - 按位使能跟踪点，bit n对应跟踪点编号n，0为停止记录（已有记录保留）
+ */
+void Trace_MaskSet(uint32_t Mask)
+{
+    TraceMask = Mask & TRACE_MASK_ALL;
+}
+
+/*!
+    \brief  Trace_Put
+
+    写入一条跟踪记录，中断与线程均可调用。跟踪点未使能时直接返回。
+
+    \param  Id    - 跟踪点编号 @ref TRACE_TICK ...
+            Arg8  - 参数
+            Arg16 - 参数
+ */
+void Trace_Put(uint8_t Id, uint8_t Arg8, uint16_t Arg16)
+{
+    volatile TraceRecord_t *pRec;
+    uintptr_t Key;
+    uint32_t Seq;
+
+    if( !(TraceMask & ((uint32_t)1 << Id)) )
+        return;
+
+    /* 领取序号，记录时间随序号单调 */
+    Key = HwiP_disable();
+    Seq = TraceWrSeq++;
+    pRec = &TraceRing[Seq & (TRACE_RECORD_NUM - 1)];
+    pRec->Seq = ~Seq; //!< 标记写入中
+    pRec->Time = Telem_Cycles();
+    HwiP_restore(Key);
+
+    pRec->Id = Id;
+    pRec->Arg8 = Arg8;
+    pRec->Arg16 = Arg16;
+    pRec->Seq = Seq; //!< 写入完毕
+}
+
+/*!
+    \brief  Trace_Read
+
+    按序号顺序取出跟踪记录，由tcpWorker处理下载指令时调用，记录照常写入。
+    起始序号早于缓冲区中最早的记录时从最早的记录开始（期间的记录已被覆盖）；
+    遇到尚在写入中的记录（写入线程被抢占）即停止，留待下次读取。
+
+    \param  Start - 起始序号，首次下载为0，之后为上次取得的最后一条记录序号+1
+            pOut  - 输出：当前写序号4 + n条记录 @ref TraceRecord_t
+            Size  - pOut字节数
+
+    \return 输出字节数
+ */
+uint16_t Trace_Read(uint32_t Start, uint8_t *pOut, uint16_t Size)
+{
+    uint32_t WrSeq = TraceWrSeq;
+    uint32_t Seq = Start;
+    uint16_t Len = TRACE_READ_HDR;
+    volatile TraceRecord_t *pRec;
+    TraceRecord_t Rec;
+
+    memcpy(pOut, &WrSeq, 4);
+
+    if( (int32_t)(WrSeq - Seq) < 0 )
+        return Len; //!< 起始序号尚未写入
+    if( WrSeq - Seq > TRACE_RECORD_NUM )
+        Seq = WrSeq - TRACE_RECORD_NUM;
+
+    for(; (Seq != WrSeq) && (Len + TRACE_RECORD_SIZE <= Size); Seq++)
+    {
+        pRec = &TraceRing[Seq & (TRACE_RECORD_NUM - 1)];
+
+        if( pRec->Seq != Seq )
+        {
+            if( TraceWrSeq - Seq > TRACE_RECORD_NUM )
+                continue; //!< 已被覆盖
+            break; //!< 写入中
+        }
+
+        Rec.Seq = Seq;
+        Rec.Time = pRec->Time;
+        Rec.Id = pRec->Id;
+        Rec.Arg8 = pRec->Arg8;
+        Rec.Arg16 = pRec->Arg16;
+
+        if( pRec->Seq != Seq )
+            continue; //!< 读取期间被覆盖
+
+        memcpy(pOut + Len, &Rec, TRACE_RECORD_SIZE);
+        Len += TRACE_RECORD_SIZE;
+    }
+
+    return Len;
+}
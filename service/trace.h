@@ -0,0 +1,76 @@
+/**
+ * @file    trace.h
+ * @author  gjmsilly
+ * @brief   NanoEEG 二进制跟踪记录（定长带时间戳记录，中断与线程均可写入的RAM环形缓冲区）
+ * @version 1.0.0
+ * @date    2022-05-27
+ *
+ * @copyright (c) 2022 gjmsilly
+ *
+ */
+
+#ifndef SERVICE_TRACE_H_
+#define SERVICE_TRACE_H_
+/*******************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************
+ * CONSTANTS
+ */
+#define TRACE_RECORD_NUM            512         //!< 环形缓冲区记录数（须为2的幂），6KB RAM
+#define TRACE_RECORD_SIZE           12          //!< 每条记录字节数 @ref TraceRecord_t
+#define TRACE_CLOCK_HZ              80000000    //!< 记录时间计数频率，即DWT周期计数器频率
+
+/* 跟踪点编号，属性 TRACE_MASK 按位使能 */
+#define TRACE_TICK                  0           //!< 运行统计刷新（约每秒），上位机据此展开32位时间
+#define TRACE_DRDY                  1           //!< nDRDY中断         Arg16: 采集块内样本序号
+#define TRACE_SPI_CPL               2           //!< 样本读取完毕      Arg8: 1-成功 0-失败 Arg16: 采集块内样本序号
+#define TRACE_PACKET_READY          3           //!< 数据帧封包完毕    Arg8: 1-提交发送 0-溢出丢弃 Arg16: UDP包累加滚动码低16位
+#define TRACE_SENDTO_START          4           //!< sendto开始        Arg8: 通道 Arg16: 脑电数据通道为帧头滚动码低16位，事件标签通道为帧字节数
+#define TRACE_SENDTO_END            5           //!< sendto返回        Arg8: 通道 Arg16: 返回值，失败为0xFFFF
+#define TRACE_EVT_WAKEUP            6           //!< cc1310事件标签唤醒中断
+#define TRACE_I2C_EVT               7           //!< 事件标签I2C读取完毕 Arg8: 1-成功 0-失败 Arg16: 标签类型
+#define TRACE_SYNC_PULSE            8           //!< 同步时钟中断      Arg16: 同步脉冲计数低16位
+#define TRACE_ATTR_CHANGE           9           //!< 属性值变化        Arg8: 属性编号，0xFE为通道属性
+#define TRACE_ID_NUM                10
+
+/* sendto 通道 @ref TRACE_SENDTO_START */
+#define TRACE_CH_EEG                0           //!< 脑电数据帧
+#define TRACE_CH_FEATURE            1           //!< 频带功率特征帧
+#define TRACE_CH_FEC                2           //!< 前向纠错校验帧
+#define TRACE_CH_RESEND             3           //!< 重传帧
+#define TRACE_CH_EVT                4           //!< 事件标签帧
+
+#define TRACE_MASK_ALL              (((uint32_t)1 << TRACE_ID_NUM) - 1)
+#define TRACE_MASK_DEFAULT          (TRACE_MASK_ALL & ~(((uint32_t)1 << TRACE_DRDY) | \
+                                                        ((uint32_t)1 << TRACE_SPI_CPL))) //!< 默认关闭逐样本跟踪点
+
+#define TRACE_READ_HDR              4           //!< 下载回复头部 = 当前写序号4
+
+/*******************************************************************
+ * TYPEDEFS
+ */
+/*!
+ *  @brief      跟踪记录，小端
+ */
+typedef struct
+{
+    uint32_t Seq;               //!< 记录序号（自由计数），写入中为其反码
+    uint32_t Time;              //!< DWT周期计数值（80MHz，约53.7s回绕）
+    uint8_t  Id;                //!< 跟踪点编号
+    uint8_t  Arg8;              //!< 参数
+    uint16_t Arg16;             //!< 参数
+
+}TraceRecord_t;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+void Trace_MaskSet(uint32_t Mask);
+void Trace_Put(uint8_t Id, uint8_t Arg8, uint16_t Arg16);
+uint16_t Trace_Read(uint32_t Start, uint8_t *pOut, uint16_t Size);
+
+#endif /* SERVICE_TRACE_H_ */
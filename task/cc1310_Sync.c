@@ -19,9 +19,6 @@
 
 /* TI-DRIVERS Header files */
 #include "ti_drivers_config.h"
-#include <ti/devices/cc32xx/driverlib/i2c.h>
-#include <ti/devices/cc32xx/inc/hw_i2c.h>
-#include <ti/devices/cc32xx/driverlib/utils.h>
 
 /* TI-RTOS Header files */
 #include <ti/drivers/GPIO.h>
@@ -34,7 +31,10 @@
 
 /* User defined Header files */
 #include <protocol/evtdata_protocol.h>
+#include <protocol/eegdata_protocol.h>
 #include <attr/attrTbl.h>
+#include <service/telemetry.h>
+#include <service/trace.h>
 
 /*********************************************************************
  *  MACROS
@@ -47,26 +47,56 @@
 #define RAT_SYNCNT      4000000
 #define CC3235_1SCNT    100000
 
-#define QUICKANSWER     4290967296
+#define RAT_TO_TICK     (SAMPLE_TIMER_FREQ / RAT_1SCNT) //!< RAT计数值（4MHz）换算为系统时间（80MHz）的标称比例
+#define RAT_WRAP        4294967296.0                    //!< RAT回绕周期（计数值）
+
+// 同步模型
+#define SYNC_WINDOW         16                          //!< 滑动窗口同步点对数
+#define SYNC_MATCH_TOL      (SAMPLE_TIMER_FREQ / 4)     //!< 同步点对匹配容差 250ms（同步周期1s）
+#define SYNC_SKEW_TOL       1e-3                        //!< 拟合斜率偏离标称比例的最大允许值（1000ppm）
+
+/*********************************************************************
+ *  TYPEDEFS
+ */
+
+/*!
+    \brief  同一同步沿在两侧时钟上的时间（同步点对）
+ */
+typedef struct
+{
+    int64_t     Sor;                //!< Tsor - RAT计数值（已展开回绕）
+    uint64_t    Soc;                //!< Tsoc - 系统时间
+} SyncPair_t;
 
 /*********************************************************************
  *  GLOBAL VARIABLES
  */
 static uint32_t         Tror;
 static uint32_t         Tsor;
-static uint32_t         Troc;
+static uint64_t         Troc;
 static uint8_t          type;
-static uint16_t         delay;
+static uint32_t         delay;
+static uint32_t         sampling;
 
 static uint8_t          I2C_BUFF[16];
 
+/* 同步模型 Tsoc = SyncSoc0 + SyncA + SyncB * (Tsor - SyncSor0) */
+static SyncPair_t       SyncWin[SYNC_WINDOW];       //!< 同步点对滑动窗口
+static uint8_t          SyncWinHead;                //!< 下一个写入位置
+static uint8_t          SyncWinNum;                 //!< 有效同步点对数
+static uint32_t         SyncLastSorRaw;             //!< 最近一个同步点对的Tsor原始值
+static int64_t          SyncSor0;                   //!< 模型参考点 - 最近一个同步点对
+static uint64_t         SyncSoc0;
+static double           SyncA;                      //!< 截距（系统时间计数值）
+static double           SyncB = RAT_TO_TICK;        //!< 斜率（系统时间计数值/RAT计数值）
+
 Timer_Handle pSyncTime = NULL;      //!< 同步时钟
 uint32_t SyncTimerBase;
+volatile bool cc1310_I2CBusy;       //!< 正在经I2C读取事件标签
 
 /*********************************************************************
  *  EXTERNAL VARIABLES
  */
-extern sem_t UDPEvtDataReady;
 extern sem_t EvtDataRecv;
 extern SampleTime_t *pSampleTime;
 extern I2C_Handle i2cHandle;
@@ -90,8 +120,8 @@ extern Display_Handle display;
 static void SyncOutputHandle(Timer_Handle handle, int_fast16_t status)
 {
     // 获取当前时间作为Tsoc @ref task/README.md
-    pSampleTime->LastSyncTime_10us = pSampleTime->BaseTime_10us + \
-            Timer_getCount(pSampleTime->SampleTimer)/800;
+    SampleTimestamp_SyncMark(pSampleTime);
+    Trace_Put(TRACE_SYNC_PULSE, 0, (uint16_t)SampleTimestamp_GetSyncCnt(pSampleTime));
 
     GPIO_toggle(CC1310_Sync_PWM); // CC1310 RAT should set both edge as input
 }
@@ -108,6 +138,7 @@ static void SyncOutputHandle(Timer_Handle handle, int_fast16_t status)
 */
 static void EventRecvHandle(uint_least8_t index)
 {
+    Trace_Put(TRACE_EVT_WAKEUP, 0, 0);
     GPIO_toggle(LED_RED_GPIO); // RED_LED to indicate working well
     /* 释放信号量 */
     sem_post(&EvtDataRecv);
@@ -122,102 +153,221 @@ static void EventRecvHandle(uint_least8_t index)
 
     I2C transfer to get event from cc1310
 
+    经I2C驱动读取事件标签：驱动由I2C中断逐字节收发，调用线程在传输期间阻塞于驱动内部信号量，
+    不关中断，nDRDY等中断照常响应。总线与bq25895共用，由驱动互斥。
+    传输期间置位cc1310_I2CBusy，供nDRDY中断统计与I2C传输重叠的样本。
+
     \param  i2cHandle - I2C object
             pdata - write the event data to this point
+            num - 读取字节数
 
-    \return void
+    \return true - 读取成功
+            false - 从机无应答或总线错误
 
 */
 static bool cc1310_EventGet(I2C_Handle i2cHandle, uint8_t* pdata, uint8_t num)
 {
-    bool ret = true;
-
-    uint32_t errstate; //TODO
-    uint8_t datanum = num;
-    uint8_t dataget = 0;
-    uint32_t key;
-
-    I2C_HWAttrs const *hwAttrs = i2cHandle->hwAttrs;
-    uint32_t I2C_BASE = hwAttrs->baseAddr;
-
-    /* Master RECEIVE of Multiple Data Bytes */
-     key = HwiP_disable();
-     /* Write Slave Address to I2CMSA, receive mode */
-     I2CMasterSlaveAddrSet( I2C_BASE,                \
-                            CC1310_ADDR,             \
-                            true);  ///< true - I2C read
-     /* Write ---01011 to I2C_O_MCS */
-     I2CMasterControl(I2C_BASE,I2C_MASTER_CMD_BURST_RECEIVE_START);
-
-     /* wait until no busy & no error */
-     while((HWREG(I2C_BASE + I2C_O_MCS) & I2C_MCS_ADRACK));
-     while(I2CMasterBusy(I2C_BASE) == true);
-     errstate = I2CMasterErr(I2C_BASE);
-
-     if(errstate == I2C_MASTER_ERR_NONE){
-         /* read one byte from I2CMDR */
-         *pdata = I2CMasterDataGet(I2C_BASE);
-         dataget++;
-     }
-     while((HWREG(I2C_BASE + I2C_O_MCS) & I2C_MCS_ACK));
-
-     while( dataget!= (datanum-1) && datanum!=1 ){
-
-         /* Write ---01001 to I2CMCS */
-         I2CMasterControl(I2C_BASE,I2C_MASTER_CMD_BURST_RECEIVE_CONT);
-         /* wait until no busy & no error */
-         while((HWREG(I2C_BASE + I2C_O_MCS) & I2C_MCS_ACK));
-         while(I2CMasterBusy(I2C_BASE) == true);
-         errstate = I2CMasterErr(I2C_BASE);
-
-         if(errstate == I2C_MASTER_ERR_NONE){
-             /* read one byte from I2CMDR */
-             *(pdata+dataget) = I2CMasterDataGet(I2C_BASE);
-             dataget++;
-         }
-     }
-
-     while((HWREG(I2C_BASE + I2C_O_MCS) & I2C_MCS_ACK));
-     /* Write ---00101 to I2CMCS */
-     I2CMasterControl(I2C_BASE,I2C_MASTER_CMD_BURST_SEND_FINISH);
-
-     /* wait until no busy & no error */
-     while((HWREG(I2C_BASE + I2C_O_MCS) & I2C_MCS_ERROR));
-     while(I2CMasterBusy(I2C_BASE) == true);
-     if(errstate == I2C_MASTER_ERR_NONE){
-         /* read one byte from I2CMDR */
-         *(pdata+dataget) = I2CMasterDataGet(I2C_BASE);
-     }
-
-     HwiP_restore(key);
-
-     return ret;
+    I2C_Transaction i2cTransaction;
+    bool ret;
+
+    i2cTransaction.slaveAddress = CC1310_ADDR;
+    i2cTransaction.writeBuf = NULL;
+    i2cTransaction.writeCount = 0;
+    i2cTransaction.readBuf = pdata;
+    i2cTransaction.readCount = num;
+
+    cc1310_I2CBusy = true;
+    ret = I2C_transfer(i2cHandle, &i2cTransaction);
+    cc1310_I2CBusy = false;
+
+    return ret;
+}
+
+/*!
+    \brief  SyncModelFit
+
+    对窗口内同步点对做最小二乘线性拟合，得到两侧时钟的偏移与斜率（频偏），
+    并更新属性`同步模型`中的残差统计。点对不足2个或拟合斜率异常时采用标称比例。
+
+    \return None
+*/
+static void SyncModelFit(void)
+{
+    const SyncPair_t *pPair;
+    SyncModel_t Model;
+    double x, y, mx = 0, my = 0, sxx = 0, sxy = 0, r, rss = 0, rmax = 0;
+    uint8_t i;
+
+    /* 以最近一个点对为参考点，避免双精度损失 */
+    pPair = &SyncWin[(SyncWinHead + SYNC_WINDOW - 1) % SYNC_WINDOW];
+    SyncSor0 = pPair->Sor;
+    SyncSoc0 = pPair->Soc;
+
+    for(i=0; i<SyncWinNum; i++)
+    {
+        mx += (double)(SyncWin[i].Sor - SyncSor0);
+        my += (double)(int64_t)(SyncWin[i].Soc - SyncSoc0);
+    }
+    mx /= SyncWinNum;
+    my /= SyncWinNum;
+
+    for(i=0; i<SyncWinNum; i++)
+    {
+        x = (double)(SyncWin[i].Sor - SyncSor0) - mx;
+        y = (double)(int64_t)(SyncWin[i].Soc - SyncSoc0) - my;
+        sxx += x * x;
+        sxy += x * y;
+    }
+
+    SyncB = RAT_TO_TICK;
+    if( (SyncWinNum >= 2) && (sxx > 0) )
+    {
+        SyncB = sxy / sxx;
+        if( fabs(SyncB / RAT_TO_TICK - 1.0) > SYNC_SKEW_TOL )
+            SyncB = RAT_TO_TICK; //!< 点对匹配错误或时钟异常，退回标称比例
+    }
+    SyncA = my - SyncB * mx;
+
+    /* 残差 */
+    for(i=0; i<SyncWinNum; i++)
+    {
+        x = (double)(SyncWin[i].Sor - SyncSor0);
+        y = (double)(int64_t)(SyncWin[i].Soc - SyncSoc0);
+        r = fabs(y - (SyncA + SyncB * x));
+        rss += r * r;
+        if( r > rmax )
+            rmax = r;
+    }
+
+    /* 换算为ns，1个计数值为12.5ns */
+    memset(&Model, 0, sizeof(Model));
+    Model.Skew_ppb = (int32_t)((RAT_TO_TICK / SyncB - 1.0) * 1e9);
+    Model.ResidualRms_ns = (uint32_t)(sqrt(rss / SyncWinNum) * 12.5);
+    Model.ResidualMax_ns = (uint32_t)(rmax * 12.5);
+    Model.PairNum = SyncWinNum;
+
+    App_WriteMsgAttr(SYNC_MODEL, &Model);
+    Attr_Notify(SYNC_MODEL);
+}
+
+/*!
+    \brief  SyncModelMap
+
+    按同步模型将RAT时间（已展开回绕）映射为系统时间
+
+    \param  Sor - RAT时间
+
+    \return 系统时间
+*/
+static uint64_t SyncModelMap(int64_t Sor)
+{
+    return SyncSoc0 + (int64_t)llround(SyncA + SyncB * (double)(Sor - SyncSor0));
+}
+
+/*!
+    \brief  SyncModelUpdate
+
+    由事件标签携带的Tsor更新同步模型：展开RAT回绕，在最近若干次同步沿中找到与Tsor对应的Tsoc，
+    作为新的同步点对加入滑动窗口并重新拟合。尚无模型时以当前时间减去事件距同步沿的时间预测Tsoc，
+    有模型时由模型预测。
+
+    \param  Tsor - cc1310最近一次同步时间戳（RAT原始值）
+            t    - 事件接收时间距该同步沿的RAT计数值
+            pSor - 展开回绕后的Tsor（to be returned）
+
+    \return true - 得到有效同步模型
+            false - 无法匹配同步沿（尚未同步）
+*/
+static bool SyncModelUpdate(uint32_t Tsor, int32_t t, int64_t *pSor)
+{
+    uint64_t Now = SampleTimestamp_Get(pSampleTime);
+    uint64_t Soc, Pred, Best = 0, Dist, BestDist = SYNC_MATCH_TOL;
+    uint32_t SyncCnt, Idx, d;
+    int64_t Sor;
+    SyncPair_t *pPair;
+
+    SyncCnt = SampleTimestamp_GetSyncCnt(pSampleTime);
+    if( SyncCnt == 0 )
+        return false;
+
+    /* 重新开始采样后系统时间清零，旧点对作废 */
+    if( SyncWinNum && (Now < SyncSoc0) )
+        SyncWinNum = 0;
+
+    if( SyncWinNum == 0 )
+    {
+        Sor = Tsor;
+        Pred = Now - (int64_t)t * RAT_TO_TICK;
+    }
+    else
+    {
+        /* 以模型预测的RAT增量确定回绕次数 */
+        d = Tsor - SyncLastSorRaw;
+        Sor = SyncSor0 + d;
+        Sor += (int64_t)llround(((double)(int64_t)(Now - SyncSoc0) / SyncB - d) / RAT_WRAP) * (int64_t)RAT_WRAP;
+
+        if( Sor == SyncSor0 )
+        {
+            *pSor = Sor;
+            return true; //!< 同一同步沿，模型不变
+        }
+        Pred = SyncModelMap(Sor);
+    }
+
+    /* 在最近的同步沿中找与预测最接近的一个 */
+    for(Idx=SyncCnt-1; (uint32_t)(SyncCnt - Idx) <= SYNC_HIST_NUM; Idx--)
+    {
+        if( !SampleTimestamp_GetSyncAt(pSampleTime, Idx, &Soc) )
+            break;
+        Dist = (Soc > Pred) ? (Soc - Pred) : (Pred - Soc);
+        if( Dist < BestDist )
+        {
+            BestDist = Dist;
+            Best = Soc;
+        }
+        if( Idx == 0 )
+            break;
+    }
+
+    *pSor = Sor;
+    if( BestDist >= SYNC_MATCH_TOL )
+        return SyncWinNum != 0; //!< 无法匹配，沿用原模型
+
+    pPair = &SyncWin[SyncWinHead];
+    pPair->Sor = *pSor;
+    pPair->Soc = Best;
+    SyncWinHead = (SyncWinHead + 1) % SYNC_WINDOW;
+    if( SyncWinNum < SYNC_WINDOW )
+        SyncWinNum++;
+    SyncLastSorRaw = Tsor;
+
+    SyncModelFit();
+
+    return true;
 }
 
 /*!
     \brief  Eventbacktracking
 
     事件标签的时间回溯 @ref task/README.md
+    由同步模型（偏移+频偏）将事件接收时间Tror映射为系统时间；尚无模型时按标称4MHz回溯至最近一次同步沿。
 
     \param  Tror Tsor Tsoc @ref task/README.md
 
-    \return Troc @ref task/README.md
+    \return Troc（64位系统时间） @ref task/README.md
 
 */
-static uint32_t Eventbacktracking(SampleTime_t* pSampleTime, uint32_t Tror, uint32_t Tsor)
+static uint64_t Eventbacktracking(SampleTime_t* pSampleTime, uint32_t Tror, uint32_t Tsor)
 {
-    uint32_t ret = 0;
-    uint32_t t = 0;
-
-    if(Tror>Tsor || Tror==Tsor){
-        t = (Tror - Tsor);
-    }else
-        t = (Tsor - QUICKANSWER - Tror);
+    int32_t t;
+    int64_t Sor;
 
+    t = (int32_t)(Tror - Tsor); //!< RAT回绕安全：按模2^32求差，事件先于同步沿时为负
 
-    ret = pSampleTime->LastSyncTime_10us + t/40;
+    if( SyncModelUpdate(Tsor, t, &Sor) )
+        return SyncModelMap(Sor + t);
 
-    return ret;
+    return SampleTimestamp_GetSync(pSampleTime) + (int64_t)t * RAT_TO_TICK;
 }
 
 
@@ -246,13 +396,22 @@ void SyncTask(uint32_t arg0, uint32_t arg1)
     GPIO_setCallback(CC1310_WAKEUP, EventRecvHandle);
     GPIO_enableInt(CC1310_WAKEUP);
 
+    Telem_TaskRegister(TELEM_TASK_SYNC);
+
     while(1){
 
         /* 等待信号量 */
+        Telem_TaskIdle(TELEM_TASK_SYNC);
         sem_wait(&EvtDataRecv);
+        Telem_TaskBusy(TELEM_TASK_SYNC);
 
         /* I2C 读取事件标签 */
-        cc1310_EventGet(i2cHandle,I2C_BUFF,10);
+        if(!cc1310_EventGet(i2cHandle,I2C_BUFF,10))
+        {
+            Trace_Put(TRACE_I2C_EVT, 0, 0);
+            continue; //!< 读取失败，无有效事件
+        }
+        Trace_Put(TRACE_I2C_EVT, 1, I2C_BUFF[9]);
 
         memcpy(&Tror, &I2C_BUFF[1],4);
         memcpy(&Tsor, &I2C_BUFF[5],4);
@@ -263,10 +422,12 @@ void SyncTask(uint32_t arg0, uint32_t arg1)
         /* 协议封包 */
         App_GetAttr(TRIGDELAY, &delay);
         //Display_printf(display, 0, 0,"delay: %u",delay);
-        UDP_DataProcess(Troc, delay, type);
-
-        /* 释放信号量，发送事件标签给上位机 */
-        sem_post(&UDPEvtDataReady);
+        /* 启用内嵌事件且正在采样时随脑电数据帧发送，否则经事件标签通道发送 */
+        App_GetAttr(SAMPLING, &sampling);
+        if( (uint8_t)sampling && UDP_EEGEventPut(Troc - (uint64_t)(uint16_t)delay * SAMPLE_TICK_PER_10US, type) )
+            continue;
+        /* 事件标签入队，通知发送线程 */
+        UDP_EvtDataPut(SAMPLE_TICK_TO_10US(Troc), (uint16_t)delay, type);
     }
 
 }
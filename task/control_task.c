@@ -18,11 +18,21 @@
 
 /* POSIX Header files */
 #include <mqueue.h>
+#include <time.h>
 
 #include <service/ads1299.h>
 #include <service/timestamp.h>
+#include <service/impedance.h>
+#include <service/eeg_filter.h>
+#include <service/eeg_bandpower.h>
+#include <service/telemetry.h>
+#include <service/trace.h>
 #include <attr/attrTbl.h>
 #include <task/sample_task.h>
+#include <protocol/udp_subscriber.h>
+#include <protocol/eegdata_protocol.h>
+#include <protocol/eegdata_fec.h>
+#include <protocol/eegdata_feature.h>
 
 /* Driverlib header files */
 #include <ti/devices/cc32xx/inc/hw_types.h>
@@ -67,6 +77,7 @@ static void Attr_ChangeCBs(uint8_t AttrNum)
     int32_t msgqRetVal;
     uint8_t AttrChangeNum = AttrNum;
 
+    Trace_Put(TRACE_ATTR_CHANGE, AttrNum, 0);
     msgqRetVal = mq_send(controlMQueue, (char *)&AttrChangeNum, 1, 0);
 }
 
@@ -76,6 +87,74 @@ static void Attr_ChangeCBs(uint8_t AttrNum)
  * FUNCTIONS
  */
 
+/*!
+    \brief  ChannelConfigApply
+
+    按通道属性配置ADS1299各CHnSET寄存器，并更新数据帧的通道掩码。
+    寄存器写入为广播，通道n、n+8、n+16、n+24共用同一CHnSET（增益、输入选择由属性层保持一致），
+    其中任一通道启用则该寄存器正常工作，全部关闭才断电。
+
+    \return true    配置完成
+            false   寄存器回读不符
+ */
+static bool ChannelConfigApply(void)
+{
+    uint8_t chEnable[CHANNEL_NUM];
+    uint8_t chGain[CHANNEL_NUM];
+    uint8_t chMux[CHANNEL_NUM];
+    uint32_t chMask = 0;
+    bool regEnable;
+    bool ret = true;
+    uint8_t reg, ch;
+
+    App_GetChxAttr(CHX_ENABLE,chEnable);
+    App_GetChxAttr(CHX_GAIN,chGain);
+    App_GetChxAttr(CHX_MUX,chMux);
+
+    for(reg=0; reg<8; reg++)
+    {
+        regEnable = false;
+        for(ch=reg; ch<CHANNEL_NUM; ch+=8)
+        {
+            if( chEnable[ch] )
+            {
+                regEnable = true;
+                chMask |= (uint32_t)1 << ch;
+            }
+        }
+
+        if( !ADS1299_SetChannel(0,reg,regEnable,chGain[reg],chMux[reg]) )
+            ret = false;
+    }
+
+    UDP_EEGChMaskSet(chMask);
+
+    return ret;
+}
+
+/*!
+    \brief  SamplerateApply
+
+    配置ADS1299采样率：脑电采集时为当前全局采样率 x 过采样抽取比，由采样线程抽取到全局采样率；
+    阻抗测量时不抽取，即当前全局采样率。
+
+    \param  Oversample - true 按过采样抽取比配置
+
+    \return true    配置完成
+            false   寄存器回读不符
+ */
+static bool SamplerateApply(bool Oversample)
+{
+    uint32_t samplerate = 0;
+    uint32_t ratio = 1;
+
+    App_GetAttr(CURSAMPLERATE,&samplerate);
+    if( Oversample )
+        App_GetAttr(OVERSAMPLE,&ratio);
+
+    return ADS1299_SetSamplerate(0,(uint16_t)samplerate * (uint8_t)ratio);
+}
+
 /*!
     \brief  AttrChangeProcess
 
@@ -106,6 +185,34 @@ static void AttrChangeProcess (uint8_t AttrChangeNum)
                 Timer_start(pSyncTime); //!< 使能同步时钟
 
                 eegSamplingState |= EEG_DATA_START_EVT; //!< 标识采样状态: 开始采样
+                UDP_SubscriberAge(); //!< 不再向已离开的探测方发送数据
+                {
+                    uint32_t samplerate = 0;
+                    uint32_t ratio = 1;
+                    uint32_t notch = 0, hp = 0, lp = 0;
+                    uint32_t mode = 0, hop = 0;
+                    uint8_t gain[CHANNEL_NUM];
+                    App_GetAttr(CURSAMPLERATE,&samplerate);
+                    App_GetAttr(OVERSAMPLE,&ratio);
+                    App_GetAttr(SAMPLE_NUM,pValue); //!< 锁存每包样本数
+                    SampleAcq_Reset(*(uint8_t*)pValue, (uint16_t)samplerate, (uint8_t)ratio, false); //!< 丢弃上次未填满的采集块
+
+                    /* 设备端滤波：按当前采样率取系数并清零状态，方案与采样率的组合已由属性层校验 */
+                    App_GetAttr(FILTER_NOTCH,&notch);
+                    App_GetAttr(FILTER_HP,&hp);
+                    App_GetAttr(FILTER_LP,&lp);
+                    EEGFilter_Config((uint16_t)samplerate,(uint8_t)notch,(uint8_t)hp,(uint8_t)lp);
+
+                    /* 频带功率特征：按当前采样率与各通道增益配置并清空分析窗 */
+                    App_GetAttr(FEATURE_MODE,&mode);
+                    App_GetAttr(FEATURE_HOP,&hop);
+                    App_GetChxAttr(CHX_GAIN,gain);
+                    UDP_EEGFeatureReset();
+                    EEGBand_Config((uint8_t)mode,(uint16_t)samplerate,(uint16_t)hop,gain); //!< 模式与采样率的组合已由属性层校验
+                    UDP_EEGEventReset(mode != EEG_BAND_MODE_ONLY); //!< 不产生脑电数据帧时事件经事件标签通道发送
+
+                    Telem_LatencyReset(); //!< 时延直方图自开始采样起统计
+                }
 
                 /* ads1299 开始采集 */
                 ADS1299_Sampling_Control(1);
@@ -122,6 +229,7 @@ static void AttrChangeProcess (uint8_t AttrChangeNum)
                 TimerValueSet(SyncTimerBase,TIMER_B,0x00);
 
                 eegSamplingState |= EEG_STOP_EVT; //!< 标识采样状态
+                UDP_EEGEventReset(false); //!< 其后的事件经事件标签通道发送
 
                 /* ads1299 停止采集 */
                 ADS1299_Sampling_Control(0);
@@ -129,21 +237,94 @@ static void AttrChangeProcess (uint8_t AttrChangeNum)
             }
         break;
 
-        case CURSAMPLERATE:
-            App_GetAttr(CURSAMPLERATE,pValue); //获取属性值
+        case IMPMEAS:
+
+            App_GetAttr(IMPMEAS,pValue); //!< 获取属性值
 
-            if(!ADS1299_SetSamplerate(0,*(uint16_t*)pValue)){
-                //TODO led 提示用户在此情况下不要尝试采集脑电信号
+            if(*(uint8_t*)pValue == IMPMES_START )
+            {
+                uint32_t samplerate = 0;
+                uint32_t mode = 0;
+                uint32_t interval = 0;
+
+                App_GetAttr(CURSAMPLERATE,&samplerate);
+                App_GetAttr(IMPMEAS_MODE,&mode);
+                App_GetAttr(IMPMEAS_INTERVAL,&interval);
+
+                /* ads1299 不过采样，增益1（避免激励电压饱和），交流导联脱落激励 */
+                SamplerateApply(false);
+                ADS1299_SetGain(0,1);
+                ADS1299_SetLeadOff(0,(mode == IMP_FREQ_31HZ2) ? ADS1299_LOFF_AC_31HZ2 : ADS1299_LOFF_AC_7HZ8);
+
+                App_GetAttr(SAMPLE_NUM,pValue);
+                SampleAcq_Reset(*(uint8_t*)pValue, (uint16_t)samplerate, 1, true); //!< 丢弃上次未填满的采集块
+
+                if(!Imp_Start((uint16_t)samplerate,(uint8_t)mode,(uint16_t)interval))
+                {
+                    /* 当前采样率不支持，恢复采集配置 */
+                    ADS1299_SetLeadOff(0,ADS1299_LOFF_OFF);
+                    ChannelConfigApply();
+                    SamplerateApply(true);
+                    App_WriteAttr(IMPMEAS,IMPMES_STOP);
+                    break;
+                }
+
+                /* ads1299 开始采集，样本由阻抗测量服务处理 */
+                ADS1299_Sampling_Control(1);
+            }
+            else
+            {
+                /* ads1299 停止采集 */
+                ADS1299_Sampling_Control(0);
+                Imp_Stop();
+
+                /* 恢复导联脱落、通道与过采样配置 */
+                ADS1299_SetLeadOff(0,ADS1299_LOFF_OFF);
+                ChannelConfigApply();
+                SamplerateApply(true);
             }
+        break;
+
+        case CURSAMPLERATE:
+        case OVERSAMPLE:        //!< ADS1299采样率 = 全局采样率 x 过采样抽取比
+            if(!SamplerateApply(true))
+                Display_printf(display, 0, 0,"[Control task] ADS1299 samplerate config failed!\r\n");
 
         break;
 
-        case CURGAIN:
-            App_GetAttr(CURGAIN,pValue); //获取属性值
+        case CURGAIN:           //!< 全局增益已由属性层写入各通道增益
+        case CHXATTR_CHANGE:
+            if(!ChannelConfigApply())
+                Display_printf(display, 0, 0,"[Control task] ADS1299 channel config failed!\r\n");
+        break;
 
-            if(!ADS1299_SetGain(0,*(uint8_t*)pValue)){
-                //TODO led 提示用户在此情况下不要尝试采集脑电信号
-            }
+        case STREAM_MODE:
+        case MCAST_ADDR:
+        {
+            uint32_t mcastaddr;
+            App_GetAttr(STREAM_MODE,pValue); //获取属性值
+            App_GetAttr(MCAST_ADDR,&mcastaddr);
+
+            UDP_SubscriberConfig(*(uint8_t*)pValue, mcastaddr);
+        }
+        break;
+
+        case EEGDATA_FMT:
+            App_GetAttr(EEGDATA_FMT,pValue); //获取属性值
+
+            UDP_EEGDataFmtSet(*(uint8_t*)pValue);
+        break;
+
+        case FEC_K:
+            App_GetAttr(FEC_K,pValue); //获取属性值
+
+            UDP_EEGFecConfig(*(uint8_t*)pValue);
+        break;
+
+        case TRACE_MASK:
+            App_GetAttr(TRACE_MASK,pValue); //获取属性值
+
+            Trace_MaskSet(*pValue);
         break;
     }
 
@@ -151,7 +332,8 @@ static void AttrChangeProcess (uint8_t AttrChangeNum)
 
 /*!
     \brief          Control task
-                    This task handles the Attribute change event
+                    This task handles the Attribute change event,
+                    并每个统计周期刷新运行统计（消息队列等待超时唤醒）
 
     \param          None
 
@@ -163,6 +345,7 @@ void controlTask(uint32_t arg0, uint32_t arg1)
     uint8_t queueMsg;
     int32_t retVal;
     mq_attr attr;
+    struct timespec timeout;
 
     /* Register callback with Attribute Service */
     AttrTbl_RegisterAppCBs(&Attr_ChangeCBs);
@@ -179,12 +362,19 @@ void controlTask(uint32_t arg0, uint32_t arg1)
         Display_printf(display, 0, 0,"Control task ready \r\n");
     }
 
+    Telem_TaskRegister(TELEM_TASK_CONTROL);
+
     while(1)
     {
-        /* wait the message enqueue */
-        retVal = mq_receive(controlMQueue, (char *)&queueMsg,
-                            sizeof(uint8_t),
-                            NULL);
+        /* wait the message enqueue，至多等待一个统计周期 */
+        clock_gettime(CLOCK_REALTIME, &timeout);
+        timeout.tv_sec += TELEM_PERIOD_S;
+
+        Telem_TaskIdle(TELEM_TASK_CONTROL);
+        retVal = mq_timedreceive(controlMQueue, (char *)&queueMsg,
+                                 sizeof(uint8_t),
+                                 NULL, &timeout);
+        Telem_TaskBusy(TELEM_TASK_CONTROL);
         if(retVal>0)
         {
             /* 属性值变化处理 */
@@ -192,5 +382,8 @@ void controlTask(uint32_t arg0, uint32_t arg1)
             Display_printf(display, 0, 0,"[Control task] Attr %2x Value Changed.\r\n",queueMsg);
 
         }
+
+        /* 运行统计刷新，距上次不足一个统计周期时直接返回 */
+        Telem_Update();
     }
 }
@@ -56,6 +56,8 @@
 #include <semaphore.h>
 
 #include <attr/attrTbl.h>
+#include <protocol/udp_subscriber.h>
+#include <service/telemetry.h>
 
 /***********************************************************************
  *  GLOBAL VARIABLES
@@ -106,6 +108,8 @@ void DetectTask(uint32_t arg0, uint32_t arg1)
     clientAddr.sin_port = htons(arg0);
     clientAddr.sin_addr.s_addr = htonl(SL_IPV4_VAL(255,255,255,255));
 
+    Telem_TaskRegister(TELEM_TASK_DETECT);
+
     while(1)
     {
         /*
@@ -117,7 +121,9 @@ void DetectTask(uint32_t arg0, uint32_t arg1)
         addrlen = sizeof(clientAddr);
 
         /* Wait forever for the reply */
+        Telem_TaskIdle(TELEM_TASK_DETECT);
         status = select(server + 1, &readSet, NULL, NULL, NULL);
+        Telem_TaskBusy(TELEM_TASK_DETECT);
         if (status > 0) {
 
             if (FD_ISSET(server, &readSet)) {
@@ -129,6 +135,9 @@ void DetectTask(uint32_t arg0, uint32_t arg1)
                     UDP_DetectedBuff[0] = 0xC2;
                     UDP_DetectedBuff[5] = 0xCC;
                     replycnt ++;
+
+                    /* 探测方加入UDP数据通道订阅者表 */
+                    UDP_SubscriberAdd(ntohl(clientAddr.sin_addr.s_addr), UDP_SUBSCRIBER_DETECT);
                 }
 
                 if (bytesRcvd > 0 ) {
@@ -12,9 +12,22 @@
 /********************************************************************
  * INCLUDES
  */
+#include <string.h>
+#include <stdbool.h>
+
 #include <ti/drivers/GPIO.h>
+#include <ti/drivers/SPI.h>
 #include <service/timestamp.h>
+#include <service/ads1299.h>
+#include <service/impedance.h>
+#include <service/eeg_filter.h>
+#include <service/eeg_decim.h>
+#include <service/eeg_bandpower.h>
+#include <service/telemetry.h>
+#include <service/trace.h>
 #include <protocol/eegdata_protocol.h>
+#include <protocol/eegdata_feature.h>
+#include <attr/attrTbl.h>
 #include <ti/display/Display.h>
 
 /* POSIX Header files */
@@ -28,14 +41,285 @@
  */
 uint8_t eegSamplingState;               //!< AD采样状态标志位
 
+/*********************************************************************
+ *  LOCAL VARIABLES
+ */
+static AcqBlock_t           AcqBlock[ACQ_BLOCKNUM]; //!< 采集块环形缓冲区
+static volatile uint8_t     AcqFillIdx;             //!< 填充中的采集块 - 仅由中断修改
+static volatile uint8_t     AcqProcIdx;             //!< 待封包的采集块 - 仅由采样线程修改
+static volatile uint8_t     AcqSampleIdx;           //!< 填充中的采集块内样本序号
+static uint8_t              AcqSampleNum = UDP_SAMPLENUM_DEFAULT; //!< 每包样本数 - 开始采样时锁存
+static uint8_t              AcqBlockLen = UDP_SAMPLENUM_DEFAULT;  //!< 每采集块ADS1299输出样本数 - 开始采样时确定
+static uint8_t              AcqDecimRatio = 1;      //!< 过采样抽取比 - 开始采样时锁存
+static uint8_t              AcqPacketIdx;           //!< 当前包已写入的样本数
+static uint32_t             AcqDecimDelay;          //!< 抽取群时延（系统定时器计数值），输出样本时间戳前移该时长
+static uint8_t              AcqDecimSkip;           //!< 开始采样后待丢弃的抽取输出样本数（历史尚未填满）
+static bool                 AcqImpMode;             //!< 本次采集为阻抗测量 - 开始采样时锁存
+volatile uint32_t           AcqOverrunCnt;          //!< 采集块溢出计数 - 采样线程跟不上采集时被覆盖的采集块数
+static volatile uint32_t    AcqI2COverlapCnt;       //!< 与事件标签I2C传输重叠的nDRDY次数 - 仅由中断修改
+static volatile uint32_t    AcqDrdyOverrunCnt;      //!< 上一样本尚未读取完毕又来nDRDY的次数
+static volatile uint32_t    AcqSpiErrorCnt;         //!< 读取量化值的SPI传输失败次数
+static uint32_t             AcqTxOverrunBase;       //!< 开始采样时的发送丢帧计数
+static uint32_t             AcqLossNotifySum;       //!< 上次推送时样本丢失统计之和
+static bool                 AcqLossPending;         //!< 当前包覆盖的时段检测到样本丢失
+
+static uint32_t             JitterPeriod;           //!< 标称采样周期（系统定时器计数值）- 开始采样时确定
+static uint64_t             JitterLastTime;         //!< 上一样本nDRDY时刻
+static bool                 JitterLastValid;        //!< JitterLastTime有效
+static uint32_t             JitterMax;              //!< 最大抖动（定时器计数值）
+static uint64_t             JitterSum;              //!< 抖动累加（定时器计数值）
+
+static SampleJitter_t       AcqJitter;              //!< 采样时刻抖动统计 - 统计完成后整体写入属性
+static SampleLoss_t         AcqLoss;                //!< 样本丢失统计 - 统计完成后整体写入属性
+
 /*********************************************************************
  *  EXTERNAL VARIABLES
  */
 extern SampleTime_t *pSampleTime;
+extern UDPDtRing_t UDP_DTX_Ring;
+extern volatile bool cc1310_I2CBusy;
 extern Display_Handle display;
 extern sem_t UDPEEGDataReady;
 extern sem_t SampleReady;
 
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*!
+    \brief  SampleJitterUpdate
+
+    统计一个采集块的采样时刻抖动：相邻两次nDRDY中断时刻的间隔与标称采样周期之差。
+    间隔偏离标称周期半个周期以上视为丢失样本（采集块溢出或SPI仍在传输），不计入统计；
+    间隔超过1.5个周期时按间隔推算丢失样本数，计入样本丢失统计并标记当前包。
+
+    \param  pBlock - 采集块
+
+    \return void
+*/
+static void SampleJitterUpdate(const AcqBlock_t *pBlock)
+{
+    uint64_t Interval;
+    uint32_t Jitter;
+    uint8_t SampleIndex;
+
+    for(SampleIndex=0; SampleIndex<AcqBlockLen; SampleIndex++)
+    {
+        if( JitterLastValid )
+        {
+            Interval = pBlock->Timestamp[SampleIndex] - JitterLastTime;
+            if( Interval > JitterPeriod + (JitterPeriod >> 1) )
+            {
+                AcqLoss.TimeGapCnt++;
+                AcqLoss.LostSampleNum += (uint32_t)((Interval + (JitterPeriod >> 1)) / JitterPeriod) - 1;
+                AcqLossPending = true;
+            }
+            if( Interval >= 2 * JitterPeriod )
+                Interval = 2 * JitterPeriod; //!< 丢失样本，以下不计入
+            Jitter = (Interval > JitterPeriod) ? (uint32_t)(Interval - JitterPeriod) : \
+                                                 (uint32_t)(JitterPeriod - Interval);
+
+            if( Jitter < (JitterPeriod >> 1) )
+            {
+                JitterSum += Jitter;
+                AcqJitter.IntervalCnt++;
+                if( Jitter > JitterMax )
+                    JitterMax = Jitter;
+            }
+        }
+
+        JitterLastTime = pBlock->Timestamp[SampleIndex];
+        JitterLastValid = true;
+    }
+
+    AcqJitter.I2COverlapCnt = AcqI2COverlapCnt;
+
+    /* 换算为ns，1个计数值为12.5ns */
+    AcqJitter.MaxJitter_ns = JitterMax * 25 / 2;
+    if( AcqJitter.IntervalCnt )
+        AcqJitter.MeanJitter_ns = (uint32_t)(JitterSum * 25 / 2 / AcqJitter.IntervalCnt);
+
+    App_WriteMsgAttr(SAMPLE_JITTER, &AcqJitter);
+    Attr_Notify(SAMPLE_JITTER);
+}
+
+/*!
+    \brief  SampleLossUpdate
+
+    汇总中断中累计的nDRDY溢出、采集块溢出、SPI传输失败计数及发送丢帧数，
+    采集侧任一计数较上次统计增加时标记当前包，任一计数变化时推送属性样本丢失统计。
+    nDRDY溢出丢失的样本不留时间戳，按计数增量标记，不依赖抖动统计对时间戳间隔的判断。
+
+    \return void
+*/
+static void SampleLossUpdate(void)
+{
+    uint32_t Drdy = AcqDrdyOverrunCnt;
+    uint32_t Block = AcqOverrunCnt;
+    uint32_t Spi = AcqSpiErrorCnt;
+    uint32_t Sum;
+
+    if( (Drdy != AcqLoss.DrdyOverrunCnt) || (Block != AcqLoss.BlockOverrunCnt) || (Spi != AcqLoss.SpiErrorCnt) )
+        AcqLossPending = true; //!< 本次统计期间采集侧丢失样本
+
+    AcqLoss.DrdyOverrunCnt = Drdy;
+    AcqLoss.BlockOverrunCnt = Block;
+    AcqLoss.SpiErrorCnt = Spi;
+    AcqLoss.TxOverrunCnt = UDP_DTX_Ring.OverrunCnt - AcqTxOverrunBase;
+
+    Sum = Drdy + Block + Spi + AcqLoss.LostSampleNum + AcqLoss.TimeGapCnt + AcqLoss.TxOverrunCnt;
+    if( Sum != AcqLossNotifySum )
+    {
+        AcqLossNotifySum = Sum;
+        App_WriteMsgAttr(SAMPLE_LOSS, &AcqLoss);
+        Attr_Notify(SAMPLE_LOSS);
+    }
+}
+
+/*!
+    \brief  SamplePacketPublish
+
+    一包样本写入完毕，完成封包并通知UDP线程发送，记录nDRDY至封包完毕的时延
+
+    \param  DrdyTime - 本包最后一个样本（过采样时为其最后一个输入样本）的nDRDY时刻
+
+    \return void
+*/
+static void SamplePacketPublish(uint64_t DrdyTime)
+{
+    eegSamplingState |= EEG_DATA_CPL_EVT; //!< 更新事件：一包ad数据采集完成
+    eegSamplingState &= ~EEG_DATA_ACQ_EVT; //!< 清除前序事件 - 一包AD数据采集中
+
+    bool published = UDP_EEGDataProcess( AcqSampleNum, eegSamplingState & EEG_STOP_EVT, AcqLossPending ); //!< 完成最后的封包工作
+    eegSamplingState &= ~EEG_STOP_EVT; //!< 清除前序事件 - AD数据暂停采集
+    AcqLossPending = false;
+
+    if(published)
+    {
+        Telem_LatencyPut(TELEM_LAT_ACQ, DrdyTime);
+        sem_post(&UDPEEGDataReady); //!< 释放信号量给UDP线程 将一包数据发送
+    }
+}
+
+/*!
+    \brief  SampleBlockProcess
+
+    将一个填满的采集块（过采样时先抽取）经设备端滤波后写入UDP发送环形缓冲区，凑满一包即封包，
+    启用频带功率特征时同时送入频带功率服务；阻抗测量期间送入阻抗测量服务
+
+    \param  pBlock - 采集块
+
+    \return void
+*/
+static void SampleBlockProcess(AcqBlock_t *pBlock)
+{
+    uint8_t SampleIndex;
+    uint8_t OutNum = AcqBlockLen / AcqDecimRatio; //!< 本块输出样本数
+
+    if( AcqImpMode )
+    {
+        if( Imp_IsRunning() ) //!< 停止阻抗测量后剩余的采集块丢弃
+        {
+            for(SampleIndex=0; SampleIndex<AcqBlockLen; SampleIndex++)
+            {
+                Imp_SamplePut(pBlock->ChannelVal[SampleIndex]);
+            }
+        }
+        return; //!< 阻抗测量期间不发送脑电数据
+    }
+
+    eegSamplingState |= EEG_DATA_ACQ_EVT; //!< 更新事件：一包AD数据采集中
+    eegSamplingState &= ~EEG_DATA_START_EVT; //!< 清除前序事件 - 一包ad数据开始采集
+
+    SampleJitterUpdate(pBlock);
+    SampleLossUpdate();
+
+    /* 过采样抽取：原位抽取为OutNum个输出样本，时间戳取对应的最后一个输入样本并扣除群时延 */
+    if( AcqDecimRatio > 1 )
+    {
+        uint64_t Raw;
+
+        EEGDecim_BlockProcess(pBlock->ChannelVal, AcqBlockLen);
+        for(SampleIndex=0; SampleIndex<OutNum; SampleIndex++)
+        {
+            Raw = pBlock->Timestamp[(SampleIndex + 1) * AcqDecimRatio - 1];
+            pBlock->Timestamp[SampleIndex] = (Raw > AcqDecimDelay) ? (Raw - AcqDecimDelay) : 0;
+        }
+    }
+
+    for(SampleIndex=0; SampleIndex<OutNum; SampleIndex++)
+    {
+        if( AcqDecimSkip )
+        {
+            AcqDecimSkip--; //!< 抽取滤波器历史尚未填满，丢弃
+            continue;
+        }
+
+        EEGFilter_SamplePut(pBlock->ChannelVal[SampleIndex]); //!< 设备端滤波（未启用时直接返回）
+
+        /* 频带功率特征：每个更新间隔封装一个特征帧并通知UDP线程发送 */
+        if( EEGBand_SamplePut(pBlock->ChannelVal[SampleIndex]) &&
+            UDP_EEGFeaturePut(pBlock->Timestamp[SampleIndex], EEGBand_Result()) )
+        {
+            sem_post(&UDPEEGDataReady);
+        }
+        if( EEGBand_Mode() == EEG_BAND_MODE_ONLY )
+            continue; //!< 仅发送频带功率，不发送脑电数据
+
+        UDP_EEGDataPut(AcqPacketIdx, pBlock->Timestamp[SampleIndex], pBlock->ChannelVal[SampleIndex]);
+
+        if( ++AcqPacketIdx == AcqSampleNum )
+        {
+            AcqPacketIdx = 0;
+            SamplePacketPublish(pBlock->Timestamp[SampleIndex] + AcqDecimDelay); //!< 还原抽取前的nDRDY时刻
+        }
+    }
+}
+
+
+#ifdef SAMPLE_ACQ_ISR
+/*!
+    \brief  ADS1299ReadCplHandle
+
+    Callback from SPI DMA ISR, 一个样本读取完毕
+
+    \param  handle      - SPI句柄
+            transaction - 完成的传输
+
+    \return void
+
+*/
+static void ADS1299ReadCplHandle(SPI_Handle handle, SPI_Transaction *transaction)
+{
+    uint8_t NextIdx;
+
+    Trace_Put(TRACE_SPI_CPL, transaction->status == SPI_TRANSFER_COMPLETED, AcqSampleIdx);
+
+    if(transaction->status != SPI_TRANSFER_COMPLETED)
+    {
+        if(transaction->status != SPI_TRANSFER_CANCELED)
+            AcqSpiErrorCnt++; //!< 传输失败，样本作废，下一nDRDY重用本位置
+        return; //!< 停止采样时取消的传输，样本作废
+    }
+
+    if(++AcqSampleIdx < AcqBlockLen)
+        return;
+
+    /* 采集块填满 */
+    AcqSampleIdx = 0;
+    NextIdx = (AcqFillIdx + 1) & (ACQ_BLOCKNUM - 1);
+    if( NextIdx == AcqProcIdx )
+    {
+        AcqOverrunCnt++; //!< 采样线程尚未处理下一采集块，覆盖本块
+        return;
+    }
+    AcqFillIdx = NextIdx;
+
+    /* 释放信号量 通知采样线程封包 */
+    sem_post(&SampleReady);
+}
+#endif
+
 /*********************************************************************
  * FUNCTIONS
  */
@@ -45,6 +329,10 @@ extern sem_t SampleReady;
 
     Callback from GPIO ISR
 
+    中断采集方式下，在中断中记录本样本时间戳并启动SPI DMA读取，
+    读取完成后由ADS1299ReadCplHandle处理；
+    否则释放信号量由采样线程读取。
+
     \param  None
 
     \return void
@@ -52,11 +340,89 @@ extern sem_t SampleReady;
 */
 void ADS1299nDRDYHandle(uint_least8_t index)
 {
+#ifdef SAMPLE_ACQ_ISR
+    uint64_t Now = SampleTimestamp_Get(pSampleTime); //!< 中断入口即锁存nDRDY时刻
+    AcqBlock_t *pBlock = &AcqBlock[AcqFillIdx];
+    uint8_t SampleIdx = AcqSampleIdx;
+
+    Trace_Put(TRACE_DRDY, 0, SampleIdx);
+    if(cc1310_I2CBusy)
+        AcqI2COverlapCnt++;
+
+    /* 传输启动后才写入时间戳：上一样本仍在传输时本位置属于该样本，保留其时间戳 */
+    if(!ADS1299_ReadResultAsync(pBlock->ChannelVal[SampleIdx]))
+    {
+        AcqDrdyOverrunCnt++; //!< 上一样本仍在传输，本样本丢失
+        return;
+    }
+    pBlock->Timestamp[SampleIdx] = Now;
+#else
+    Trace_Put(TRACE_DRDY, 0, AcqSampleIdx);
+    if(cc1310_I2CBusy)
+        AcqI2COverlapCnt++;
+
     /* 释放信号量 */
     sem_post(&SampleReady);
-
+#endif
 }
 
+/*!
+    \brief  SampleAcq_Reset
+
+    复位采集块填充位置，丢弃上次停止采样时未填满的采集块，锁存本次采样的每包样本数与抽取比，
+    并清零采样时刻抖动统计与样本丢失统计。须在ADS1299开始采样（nDRDY中断使能）之前调用。
+
+    过采样抽取时每采集块的输出样本数取每包样本数不超过ACQ_RAWSAMPLE_MAX / 抽取比的最大因数，
+    一包由整数个采集块组成；不抽取时一个采集块即一包。
+
+    \param  SampleNum  - 每包样本数（属性SAMPLE_NUM，已由属性层校验）
+            SampleRate - 输出采样率（属性CURSAMPLERATE），ADS1299以其抽取比倍采集
+            DecimRatio - 过采样抽取比（属性OVERSAMPLE），1为不抽取
+            ImpMode    - true 阻抗测量（不抽取），样本送入阻抗测量服务；false 脑电采集
+
+    \return void
+*/
+void SampleAcq_Reset(uint8_t SampleNum, uint16_t SampleRate, uint8_t DecimRatio, bool ImpMode)
+{
+    uint8_t OutNum;
+
+    if( ImpMode )
+        DecimRatio = 1;
+    if( !EEGDecim_Config(DecimRatio) )
+        DecimRatio = 1; //!< 抽取比不支持，不抽取
+
+    OutNum = ACQ_RAWSAMPLE_MAX / DecimRatio;
+    if( OutNum > SampleNum )
+        OutNum = SampleNum;
+    while( SampleNum % OutNum )
+        OutNum--;
+
+    AcqSampleNum = SampleNum;
+    AcqDecimRatio = DecimRatio;
+    AcqBlockLen = OutNum * DecimRatio;
+    AcqImpMode = ImpMode;
+    AcqSampleIdx = 0;
+    AcqPacketIdx = 0;
+
+    JitterPeriod = SAMPLE_TIMER_FREQ / ((uint32_t)SampleRate * DecimRatio);
+    AcqDecimDelay = EEGDecim_GroupDelay() * JitterPeriod;
+    AcqDecimSkip = (uint8_t)((EEGDecim_GroupDelay() + DecimRatio - 1) / DecimRatio);
+    JitterLastValid = false;
+    JitterMax = 0;
+    JitterSum = 0;
+    AcqI2COverlapCnt = 0;
+    memset(&AcqJitter, 0, sizeof(AcqJitter));
+    App_WriteMsgAttr(SAMPLE_JITTER, &AcqJitter);
+
+    AcqOverrunCnt = 0;
+    AcqDrdyOverrunCnt = 0;
+    AcqSpiErrorCnt = 0;
+    AcqTxOverrunBase = UDP_DTX_Ring.OverrunCnt;
+    AcqLossNotifySum = 0;
+    AcqLossPending = false;
+    memset(&AcqLoss, 0, sizeof(AcqLoss));
+    App_WriteMsgAttr(SAMPLE_LOSS, &AcqLoss);
+}
 
 /*!
     \brief  Sample task
@@ -70,52 +436,58 @@ void ADS1299nDRDYHandle(uint_least8_t index)
 */
 void SampleTask(uint32_t arg0, uint32_t arg1)
 {
-    static uint8_t SampleIndex = 0; //!< 样本序号
-
     /* Register interrupt for the Mod_nDRDY (EEG trigger) */
     GPIO_setCallback(Mod_nDRDY, ADS1299nDRDYHandle);
 
+#ifdef SAMPLE_ACQ_ISR
+    /* 采样期间SPI工作于回调模式 */
+    ADS1299_RegisterAcqCB(ADS1299ReadCplHandle);
+#endif
+
     Display_printf(display, 0, 0, "Sample task ready\r\n");
 
+    Telem_TaskRegister(TELEM_TASK_SAMPLE);
+
     while(1)
     {
+#ifdef SAMPLE_ACQ_ISR
+        /* 等待信号量,由SPI回调在一个采集块填满后释放，等不到则阻塞 */
+        Telem_TaskIdle(TELEM_TASK_SAMPLE);
+        sem_wait(&SampleReady);
+        Telem_TaskBusy(TELEM_TASK_SAMPLE);
+
+        SampleBlockProcess(&AcqBlock[AcqProcIdx]);
+        AcqProcIdx = (AcqProcIdx + 1) & (ACQ_BLOCKNUM - 1); //!< 释放采集块
+#else
         /* 等待信号量,由Mod_nDRDY中断的回调函数释放，等不到则阻塞 */
+        Telem_TaskIdle(TELEM_TASK_SAMPLE);
         sem_wait(&SampleReady);
+        Telem_TaskBusy(TELEM_TASK_SAMPLE);
 
         /* 信号量一旦释放，则开始运行下面的代码 */
 
-        /* 每次开始采样时对样本序号清零 */
-        if( eegSamplingState & EEG_DATA_START_EVT )
-        {
-            SampleIndex=0;
-        }
+        /* 信号量积压：线程未及时读取，期间的样本已被ADS1299覆盖，丢弃积压只读最新样本 */
+        while(sem_trywait(&SampleReady) == 0)
+            AcqDrdyOverrunCnt++;
 
         /* 一包数据 采样中 */
-        pSampleTime->CurTimeStamp[SampleIndex] = pSampleTime->BaseTime_10us + \
-                Timer_getCount(pSampleTime->SampleTimer)/800; //!< 获取当前时间
-
-        eegSamplingState |= EEG_DATA_ACQ_EVT; //!< 更新事件：一包AD数据采集中
-        eegSamplingState &= ~EEG_DATA_START_EVT; //!< 清除前序事件 - 一包ad数据开始采集
+        AcqBlock[0].Timestamp[AcqSampleIdx] = SampleTimestamp_Get(pSampleTime); //!< 获取当前时间
 
-        if(UDP_EEGDataGet(SampleIndex)) //!< 获取AD数据
+        if(!ADS1299_ReadResult(AcqBlock[0].ChannelVal[AcqSampleIdx])) //!< 获取AD数据
         {
-            SampleIndex++; //!< 样本序号+1
+            Trace_Put(TRACE_SPI_CPL, 0, AcqSampleIdx);
+            AcqSpiErrorCnt++; //!< 传输失败，样本作废
+            continue;
         }
+        Trace_Put(TRACE_SPI_CPL, 1, AcqSampleIdx);
 
         /* 一包数据最后一个样本采样完毕 */
-        if(SampleIndex == UDP_SAMPLENUM )
+        if(++AcqSampleIdx == AcqBlockLen )
         {
-            SampleIndex=0; //!< 样本序号归零
-
-            eegSamplingState |= EEG_DATA_CPL_EVT; //!< 更新事件：一包ad数据采集完成
-            eegSamplingState &= ~EEG_DATA_ACQ_EVT; //!< 清除前序事件 - 一包AD数据采集中
-
-            if(UDP_EEGDataProcess(pSampleTime, eegSamplingState & EEG_STOP_EVT )) //!< 完成最后的封包工作
-                eegSamplingState &= ~EEG_STOP_EVT; //!< 清除前序事件 - AD数据暂停采集
-                sem_post(&UDPEEGDataReady); //!< 释放信号量给UDP线程 将一包数据发送
+            AcqSampleIdx=0; //!< 样本序号归零
+            SampleBlockProcess(&AcqBlock[0]);
         }
-
+#endif
     }
 
 }
-
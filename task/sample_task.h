@@ -12,16 +12,49 @@
 #ifndef TASK_SAMPLE_TASK_H_
 #define TASK_SAMPLE_TASK_H_
 
+/*******************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <protocol/eegdata_protocol.h>
+#include <service/eeg_decim.h>
+
 /*******************************************************************
  * CONSTANTS
  */
 
+/* 采集方式 */
+#define SAMPLE_ACQ_ISR                          //!< 定义则由nDRDY中断启动SPI DMA回调读取AD数据，
+                                                //!< 注释掉则退回由采样线程逐样本阻塞读取
+#define ACQ_BLOCKNUM                    4       //!< 采集块数量（须为2的幂）
+#define ACQ_RAWSAMPLE_MAX               EEG_DECIM_RATIO_MAX //!< 每采集块最多ADS1299输出样本数（不小于UDP_SAMPLENUM_MAX）
+
 /* 采集状态指示 */
 #define EEG_DATA_START_EVT              ( 1 << 0 )  //!< 一包AD数据开始采集
 #define EEG_DATA_ACQ_EVT                ( 1 << 1 )  //!< 一包AD数据采集中
 #define EEG_DATA_CPL_EVT                ( 1 << 2 )  //!< 一包AD数据采集完成
 #define EEG_STOP_EVT                    ( 1 << 3 )  //!< AD数据暂停采集
 
+/*******************************************************************
+ * TYPEDEFS
+ */
+
+/*!
+    \brief  采集块
+            一个采集块包含一包UDP数据的样本（样本数开始采样时确定），由nDRDY中断及SPI回调填充，
+            填满后交由采样线程封包。过采样抽取时一个采集块为若干个输出样本对应的ADS1299输出样本，
+            由采样线程原位抽取后封包，一包由整数个采集块组成。
+ */
+typedef struct
+{
+    uint64_t    Timestamp[ACQ_RAWSAMPLE_MAX];                       //!< 每样本时间戳（nDRDY中断时刻，64位系统时间）
+    uint8_t     ChannelVal[ACQ_RAWSAMPLE_MAX][UDP_SampleValSize];   //!< 每样本通道状态+量化值
+} AcqBlock_t;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+void SampleAcq_Reset(uint8_t SampleNum, uint16_t SampleRate, uint8_t DecimRatio, bool ImpMode);
 
 
 #endif /* TASK_SAMPLE_TASK_H_ */
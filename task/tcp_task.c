@@ -42,6 +42,7 @@
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <errno.h>
 
 #include <pthread.h>
 /* BSD support */
@@ -54,15 +55,15 @@
 #include <ti/display/Display.h>
 
 #include <protocol/attr_protocol.h>
+#include <protocol/udp_subscriber.h>
+#include <service/telemetry.h>
 
-#define NUMTCPWORKERS 3
+#define NUMTCPWORKERS TCP_CTX_NUM
 
 /*******************************************************************************
  *  EXTERNAL VARIABLES
  */
 extern Display_Handle display;
-extern uint8_t *pTCP_Tx_Buff;
-extern uint8_t *pTCP_Rx_Buff;
 
 /*******************************************************************************
  *  EXTERNAL FUNCITONS
@@ -77,29 +78,62 @@ extern void *TaskCreate(void (*pFun)(), char *Name, uint32_t StackSize,
 /*
  *  ======== tcpWorker ========
  *  Task to handle TCP connection. Can be multiple Tasks running
- *  this function.
+ *  this function, each with its own connection context (arg0).
  */
 void tcpWorker(uint32_t arg0, uint32_t arg1)
 {
-    int  clientfd = (int)arg0;
+    TCPCtx_t *pCtx = (TCPCtx_t *)arg0;
+    int  clientfd = pCtx->ClientFd;
     int  bytesRcvd;
+    uint8_t  *pRecv;
+    uint16_t RecvSize;
+    uint16_t TxLen;
+    bool     More;
+    struct timeval tv;
 
 
     Display_printf(display, 0, 0, "tcpWorker: start clientfd = 0x%x\n",
             clientfd);
 
-    while ((bytesRcvd = recv(clientfd, pTCP_Rx_Buff, TCP_Rx_Buff_Size, 0)) > 0)
+    /* 接收超时唤醒以检查订阅推送 */
+    tv.tv_sec = 0;
+    tv.tv_usec = TCP_NOTIFY_TICK_MS * 1000;
+    setsockopt(clientfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    pRecv = TCP_StreamRecvBuff(pCtx, &RecvSize);
+    while (1)
     {
-        if( TCP_ProcessFSM(pTCP_Rx_Buff) == true ) // 控制通道帧协议处理完毕
+        bytesRcvd = recv(clientfd, pRecv, RecvSize, 0);
+        if (bytesRcvd < 0 && errno == EAGAIN)
+            bytesRcvd = 0;      //!< 接收超时
+        else if (bytesRcvd <= 0)
+            break;              //!< 连接断开
+
+        /* 处理本次接收后所有完整帧，回复合并为一次发送 */
+        do
         {
-            send(clientfd, pTCP_Tx_Buff, (*(pTCP_Tx_Buff+1)+3), 0);
-            memset(pTCP_Rx_Buff,0x00,TCP_Rx_Buff_Size);  //!< 清空接收缓冲区
-        }
+            More = TCP_StreamProcess(pCtx, (uint16_t)bytesRcvd, &TxLen);
+            bytesRcvd = 0;
+
+            if( TxLen )
+                send(clientfd, pCtx->Tx_Buff, TxLen, 0);
+        } while( More );
+
+        /* 订阅推送 */
+        TxLen = TCP_NotifyProcess(pCtx);
+        if( TxLen )
+            send(clientfd, pCtx->Tx_Buff, TxLen, 0);
+
+        pRecv = TCP_StreamRecvBuff(pCtx, &RecvSize);
     }
 
     Display_printf(display, 0, 0, "tcpWorker stop clientfd = 0x%x\n", clientfd);
 
+    UDP_SubscriberRemove(clientfd); //!< 上位机断开，停止向其发送数据
+
     close(clientfd);
+
+    TCP_CtxFree(pCtx);
 }
 
 /*
@@ -109,6 +143,7 @@ void tcpWorker(uint32_t arg0, uint32_t arg1)
 void tcpHandler(uint32_t arg0, uint32_t arg1)
 {
     void *thread = NULL;
+    TCPCtx_t           *pCtx;
     int                status;
     int                clientfd;
     int                server;
@@ -118,8 +153,6 @@ void tcpHandler(uint32_t arg0, uint32_t arg1)
     int                optlen = sizeof(optval);
     socklen_t          addrlen = sizeof(clientAddr);
 
-    TCP_ProcessFSMInit(); //初始化控制通道协议处理状态机
-
     Display_printf(display, 0, 0, "TCP control channel start\n");
 
     server = socket(AF_INET, SOCK_STREAM, 0);
@@ -153,19 +186,41 @@ void tcpHandler(uint32_t arg0, uint32_t arg1)
         goto shutdown;
     }
 
-    while ((clientfd =
-            accept(server, (struct sockaddr *)&clientAddr, &addrlen)) != -1) {
+    Telem_TaskRegister(TELEM_TASK_TCP);
+
+    while (1) {
+
+        Telem_TaskIdle(TELEM_TASK_TCP);
+        clientfd = accept(server, (struct sockaddr *)&clientAddr, &addrlen);
+        Telem_TaskBusy(TELEM_TASK_TCP);
+        if (clientfd == -1)
+            break;
 
         Display_printf(display, 0, 0,
                 "tcpHandler: Creating thread clientfd = %x\n", clientfd);
 
-        // 上位机(plumberhub)TCP连接建立，创建tcpWorker线程处理数据收发事务
-        thread = TaskCreate(tcpWorker, NULL, 2048, (uintptr_t)clientfd, 0, 0);
+        // 分配连接上下文，连接数已满则拒绝
+        pCtx = TCP_CtxAlloc(clientfd);
+        if (!pCtx) {
+            Display_printf(display, 0, 0,
+                    "tcpHandler: Error - Too many connections.\n");
+            close(clientfd);
+            addrlen = sizeof(clientAddr);
+            continue;
+        }
+
+        // 上位机(plumberhub)TCP连接建立，加入UDP数据通道订阅者表
+        UDP_SubscriberAdd(ntohl(clientAddr.sin_addr.s_addr), clientfd);
+
+        // 创建tcpWorker线程处理数据收发事务
+        thread = TaskCreate(tcpWorker, NULL, 2048, (uintptr_t)pCtx, 0, 0);
 
         if (!thread) {
             Display_printf(display, 0, 0,
                     "tcpHandler: Error - Failed to create new thread.\n");
+            UDP_SubscriberRemove(clientfd);
             close(clientfd);
+            TCP_CtxFree(pCtx);
         }
 
         /* addrlen is a value-result param, must reset for next accept call */
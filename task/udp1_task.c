@@ -56,11 +56,16 @@
 #include <semaphore.h>
 
 #include <protocol/eegdata_protocol.h>
+#include <protocol/udp_subscriber.h>
+#include <protocol/eegdata_cache.h>
+#include <protocol/eegdata_fec.h>
+#include <protocol/eegdata_feature.h>
+#include <service/telemetry.h>
+#include <service/trace.h>
 
 /***********************************************************************
  *  EXTERNAL VARIABLES
  */
-extern UDPDtFrame_t UDP_DTX_Buff;     //!< UDP发送缓冲区
 extern sem_t UDPEEGDataReady;       //!< UDP脑电数据包完毕信号量
 
 extern Display_Handle display;
@@ -69,6 +74,32 @@ extern Display_Handle display;
  * FUNCTIONS
  */
 
+/*!
+    \brief  UDP1Sendto
+
+    经UDP_SubscriberSendto()发送一帧，前后写入跟踪记录
+
+    \param  server - 套接字
+            pTx    - 帧（以UDPHeader_t开头）
+            Len    - 帧字节数
+            Port   - 目的端口
+            Ch     - 跟踪记录通道 @ref TRACE_CH_EEG ...
+
+    \return UDP_SubscriberSendto()返回值
+ */
+static int UDP1Sendto(int server, const uint8_t *pTx, uint16_t Len, uint16_t Port, uint8_t Ch)
+{
+    uint16_t Num;
+    int Ret;
+
+    memcpy(&Num, ((const UDPHeader_t *)pTx)->UDPNum, 2); //!< 帧头滚动码低16位
+    Trace_Put(TRACE_SENDTO_START, Ch, Num);
+    Ret = UDP_SubscriberSendto(server, pTx, Len, Port);
+    Trace_Put(TRACE_SENDTO_END, Ch, (Ret < 0) ? 0xFFFF : (uint16_t)Ret);
+
+    return Ret;
+}
+
 /*
  *  ======== udp1Handler ========
  *  Transmit EEG data via UDP1 channel
@@ -79,10 +110,16 @@ void udp1Worker(uint32_t arg0, uint32_t arg1)
     int                status;
     int                server;
     struct sockaddr_in localAddr;
-    struct sockaddr_in clientAddr;
+    UDPDtFrame_t       *pFrame;         //!< 待发送帧槽
+    const uint8_t      *pTx;            //!< 待发送字节流
+    UDPResendReq_t     ResendReq;       //!< 上位机重传请求
+    uint16_t           i;
+    uint16_t           FrameLen;        //!< 待发送帧长度
 
     Display_printf(display, 0, 0, "UDP1 data channel start\n");
 
+    Telem_TaskRegister(TELEM_TASK_UDP1);
+
     server = socket(AF_INET, SOCK_DGRAM, 0);
     if (server == -1) {
         Display_printf(display, 0, 0, "Error: socket not created.\n");
@@ -100,17 +137,50 @@ void udp1Worker(uint32_t arg0, uint32_t arg1)
         goto shutdown;
     }
 
-    clientAddr.sin_family = AF_INET;
-    clientAddr.sin_port = htons(arg0); //脑电数据通道端口
-    clientAddr.sin_addr.s_addr = htonl(SL_IPV4_VAL(255,255,255,255)); //局域网广播
-
     while(1)
     {
-        /* 等待信号量 */
+        /* 等待信号量，每释放一次表示环形缓冲区中有一帧待发送、有一个特征帧待发送或有一个重传请求 */
+        Telem_TaskIdle(TELEM_TASK_UDP1);
         sem_wait(&UDPEEGDataReady);
-
-        status = sendto(server, (uint8_t*)(&UDP_DTX_Buff),UDP_DTx_Buff_Size,0,
-                       (struct sockaddr*)&clientAddr,sizeof(SlSockAddr_t));
+        Telem_TaskBusy(TELEM_TASK_UDP1);
+
+        /* 重发上位机请求的缓存帧 */
+        while(UDP_EEGResendPending(&ResendReq))
+        {
+            for(i=0; i<ResendReq.Count; i++)
+            {
+                pTx = UDP_EEGCacheGet(ResendReq.StartNum + i, &FrameLen);
+                if(pTx)
+                    UDP1Sendto(server, pTx, FrameLen, arg0, TRACE_CH_RESEND);
+            }
+        }
+
+        /* 频带功率特征帧，不进入重传缓存及前向纠错 */
+        pTx = UDP_EEGFeatureRead(&FrameLen);
+        if(pTx)
+        {
+            UDP1Sendto(server, pTx, FrameLen, arg0, TRACE_CH_FEATURE);
+            UDP_EEGFeatureRelease();
+        }
+
+        pFrame = UDP_EEGRingRead(&FrameLen);
+        if(pFrame == NULL)
+            continue;
+
+        pTx = UDP_EEGDataSerialize(pFrame, &FrameLen); //!< 按数据通道格式编码
+        status = UDP1Sendto(server, pTx, FrameLen, arg0, TRACE_CH_EEG); //!< 脑电数据通道端口
+        Telem_LatencyPut(TELEM_LAT_TX, UDP_EEGRingReadyTime()); //!< 封包完毕至发送完毕时延
+
+        /* 存入重传缓存 */
+        UDP_EEGCachePut(pTx, FrameLen);
+
+        /* 累计前向纠错校验，每组满K帧发送一个校验帧 */
+        pTx = UDP_EEGFecPut(pTx, FrameLen, &FrameLen);
+        if(pTx)
+            UDP1Sendto(server, pTx, FrameLen, arg0, TRACE_CH_FEC);
+
+        /* 发送完毕，释放帧槽 */
+        UDP_EEGRingRelease();
     }
 
 shutdown:
@@ -56,7 +56,10 @@
 #include <semaphore.h>
 
 #include <protocol/evtdata_protocol.h>
+#include <protocol/udp_subscriber.h>
 #include <attr/attrTbl.h>
+#include <service/telemetry.h>
+#include <service/trace.h>
 
 /***********************************************************************
  *  GLOBAL VARIABLES
@@ -65,7 +68,6 @@
 /***********************************************************************
  *  EXTERNAL VARIABLES
  */
-extern UDPEvtFrame_t UDP_EvtTX_Buff;    //!< UDP发送缓冲区
 extern sem_t UDPEvtDataReady;           //!< UDP脑电数据包完毕信号量
 extern Display_Handle display;
 
@@ -83,7 +85,8 @@ void udp2Worker(uint32_t arg0, uint32_t arg1)
     int                status;
     int                server;
     struct sockaddr_in localAddr;
-    struct sockaddr_in clientAddr;
+    const uint8_t      *pTx;            //!< 待发送帧
+    uint16_t           FrameLen;        //!< 待发送帧长度
 
     Display_printf(display, 0, 0, "UDP1 data channel start\n");
 
@@ -104,18 +107,25 @@ void udp2Worker(uint32_t arg0, uint32_t arg1)
         goto shutdown;
     }
 
-    clientAddr.sin_family = AF_INET;
-    clientAddr.sin_port = htons(arg0); //!< 事件标签数据通道端口
-    clientAddr.sin_addr.s_addr = htonl(SL_IPV4_VAL(255,255,255,255)); //!< 局域网广播
+    Telem_TaskRegister(TELEM_TASK_UDP2);
 
     while(1)
     {
 
-        /* 等待信号量 */
+        /* 等待信号量，每释放一次表示事件队列中新增一个事件 */
+        Telem_TaskIdle(TELEM_TASK_UDP2);
         sem_wait(&UDPEvtDataReady);
+        Telem_TaskBusy(TELEM_TASK_UDP2);
 
-        bytesSent = sendto(server, (uint8_t*)(&UDP_EvtTX_Buff),UDP_EvtTx_Buff_Size,0,
-                       (struct sockaddr*)&clientAddr,sizeof(SlSockAddr_t));
+        /* 取出队列中全部事件封为一帧，连发的事件已由前一帧带走时队列为空 */
+        pTx = UDP_EvtFrameGet(&FrameLen);
+        if(pTx == NULL)
+            continue;
+
+        Trace_Put(TRACE_SENDTO_START, TRACE_CH_EVT, FrameLen);
+        bytesSent = UDP_SubscriberSendto(server, pTx, FrameLen,
+                                         arg0); //!< 事件标签数据通道端口
+        Trace_Put(TRACE_SENDTO_END, TRACE_CH_EVT, (bytesSent < 0) ? 0xFFFF : (uint16_t)bytesSent);
 
     }
 